@@ -128,6 +128,47 @@ CASADI_EXPORT int casadi_c_work_id(int id, casadi_int *sz_arg, casadi_int* sz_re
 CASADI_EXPORT int casadi_c_eval_id(int id, const double** arg, double** res,
   casadi_int* iw, double* w, int mem);
 
+/* ===================================================
+*   Asynchronous evaluation
+*  =================================================== */
+
+/** \brief Queue an evaluation on the CasADi thread pool
+ *
+ * Reads the inputs from arg and writes the outputs to res, which must remain
+ * valid until the evaluation has completed. Work vectors and a memory object
+ * are obtained internally. The evaluation starts once the n_after evaluations
+ * with handles in after have completed, and fails if any of them failed.
+ *
+ * Thread-safe, as long as no Functions are loaded or unloaded concurrently
+ * Return a handle >=0 when successful
+ */
+CASADI_EXPORT int casadi_c_eval_async(const double** arg, double** res,
+  int n_after, const int* after);
+CASADI_EXPORT int casadi_c_eval_async_id(int id, const double** arg, double** res,
+  int n_after, const int* after);
+
+/** \brief Check if an asynchronous evaluation has completed
+ *
+ * Return 1 if completed, 0 if not, negative if the handle is invalid
+ */
+CASADI_EXPORT int casadi_c_async_ready(int handle);
+
+/** \brief Wait for an asynchronous evaluation to complete
+ *
+ * Invalidates the handle
+ * Return 0 when successful
+ */
+CASADI_EXPORT int casadi_c_async_wait(int handle);
+
+/** \brief Discard the handle of an asynchronous evaluation without waiting
+ *
+ * The evaluation still completes, and so do evaluations queued after it,
+ * so its buffers must remain valid. Every handle is kept until it is passed
+ * to either casadi_c_async_wait or casadi_c_async_release.
+ * Return 0 when successful
+ */
+CASADI_EXPORT int casadi_c_async_release(int handle);
+
 CASADI_EXPORT void casadi_c_logger_write(const char* msg, int num);
 CASADI_EXPORT void casadi_c_logger_flush(void);
 
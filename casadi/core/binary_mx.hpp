@@ -92,6 +92,14 @@ namespace casadi {
         \identifier{1fx} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
     /// Evaluate the function (template)
     template<typename T>
     int eval_gen(const T* const* arg, T* const* res, casadi_int* iw, T* w) const;
@@ -260,6 +260,42 @@ namespace casadi {
     return 0;
   }
 
+  template<bool ScX, bool ScY>
+  int BinaryMX<ScX, ScY>::
+  sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    const bvec_t *a0=arg[0], *a1=arg[1];
+    bvec_t *r=res[0];
+    casadi_int n=nnz();
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int j=0; j<nw; ++j) r[j] = a0[j] | a1[j];
+      r += nw;
+      if (!ScX) a0 += nw;
+      if (!ScY) a1 += nw;
+    }
+    return 0;
+  }
+
+  template<bool ScX, bool ScY>
+  int BinaryMX<ScX, ScY>::
+  sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *a0=arg[0], *a1=arg[1], *r = res[0];
+    casadi_int n=nnz();
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int j=0; j<nw; ++j) {
+        bvec_t s = r[j];
+        r[j] = 0;
+        a0[j] |= s;
+        a1[j] |= s;
+      }
+      r += nw;
+      if (!ScX) a0 += nw;
+      if (!ScY) a1 += nw;
+    }
+    return 0;
+  }
+
   template<bool ScX, bool ScY>
   MX BinaryMX<ScX, ScY>::get_unary(casadi_int op) const {
     //switch (op_) {
@@ -28,12 +28,27 @@
 #include "serializer.hpp"
 #include <deque>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif //CASADI_WITH_THREAD
+
 using namespace casadi;
 
 static std::vector<Function> casadi_c_loaded_functions;
 static std::deque<int> casadi_c_load_stack;
 static int casadi_c_active = -1;
 
+// Asynchronous evaluations, until waited for or released
+static std::map<int, FunctionFuture> casadi_c_futures;
+static int casadi_c_next_future = 0;
+#ifdef CASADI_WITH_THREAD
+static std::mutex casadi_c_futures_mtx;
+#endif //CASADI_WITH_THREAD
+
 int casadi_c_int_width() {
   return sizeof(casadi_int);
 }
@@ -329,6 +344,78 @@ int casadi_c_eval_id(int id, const double** arg, double** res, casadi_int* iw, d
   return 0;
 }
 
+int casadi_c_eval_async(const double** arg, double** res, int n_after, const int* after) {
+  return casadi_c_eval_async_id(casadi_c_active, arg, res, n_after, after);
+}
+
+int casadi_c_eval_async_id(int id, const double** arg, double** res,
+    int n_after, const int* after) {
+  if (sanitize_id(id)) return -1;
+  try {
+    const Function& f = casadi_c_loaded_functions.at(id);
+    std::vector<const double*> argv(arg, arg+f.n_in());
+    std::vector<double*> resv(res, res+f.n_out());
+    std::vector<FunctionFuture> afterv;
+    {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(casadi_c_futures_mtx);
+#endif //CASADI_WITH_THREAD
+      for (int i=0; i<n_after; ++i) {
+        auto it = casadi_c_futures.find(after[i]);
+        casadi_assert(it!=casadi_c_futures.end(), "Invalid handle " + str(after[i]));
+        afterv.push_back(it->second);
+      }
+    }
+    FunctionFuture fut = f.eval_async(argv, resv, afterv);
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(casadi_c_futures_mtx);
+#endif //CASADI_WITH_THREAD
+    int handle = casadi_c_next_future++;
+    casadi_c_futures[handle] = fut;
+    return handle;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -2;
+  } catch (...) {
+    std::cerr << "Uncaught exception" << std::endl;
+    return -3;
+  }
+}
+
+// Look up a pending asynchronous evaluation, optionally forgetting it
+static FunctionFuture casadi_c_future(int handle, bool erase) {
+#ifdef CASADI_WITH_THREAD
+  std::lock_guard<std::mutex> lock(casadi_c_futures_mtx);
+#endif //CASADI_WITH_THREAD
+  auto it = casadi_c_futures.find(handle);
+  if (it==casadi_c_futures.end()) {
+    std::cerr << "Invalid handle " << handle << std::endl;
+    return FunctionFuture();
+  }
+  FunctionFuture ret = it->second;
+  if (erase) casadi_c_futures.erase(it);
+  return ret;
+}
+
+int casadi_c_async_ready(int handle) {
+  FunctionFuture fut = casadi_c_future(handle, false);
+  if (fut.is_null()) return -1;
+  return fut.ready();
+}
+
+int casadi_c_async_wait(int handle) {
+  FunctionFuture fut = casadi_c_future(handle, true);
+  if (fut.is_null()) return -1;
+  int ret = fut.wait();
+  if (ret) std::cerr << fut.error() << std::endl;
+  return ret;
+}
+
+int casadi_c_async_release(int handle) {
+  FunctionFuture fut = casadi_c_future(handle, true);
+  if (fut.is_null()) return -1;
+  return 0;
+}
 
 void casadi_c_logger_write(const char* msg, int num) {
   casadi::uout().write(msg, num);
@@ -158,6 +158,16 @@ namespace casadi {
     return fcn_.rev(arg, res, iw, w);
   }
 
+  int Call::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    return fcn_->sp_forward_wide(arg, res, iw, w, fcn_.memory(0), nw);
+  }
+
+  int Call::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    return fcn_->sp_reverse_wide(arg, res, iw, w, fcn_.memory(0), nw);
+  }
+
   void Call::add_dependency(CodeGenerator& g) const {
     g.add_dependency(fcn_);
   }
@@ -55,6 +55,8 @@ namespace casadi {
     bool prefix_set = false;
     this->prefix = "";
     avoid_stack_ = false;
+    this->thread_safe = false;
+    this->thread_local_mem = false;
     indent_ = 2;
 
     // Read options
@@ -100,6 +102,10 @@ namespace casadi {
         casadi_assert_dev(indent_>=0);
       } else if (e.first=="avoid_stack") {
         avoid_stack_ = e.second;
+      } else if (e.first=="thread_safe") {
+        this->thread_safe = e.second;
+      } else if (e.first=="thread_local_mem") {
+        this->thread_local_mem = e.second;
       } else if (e.first=="prefix") {
         this->prefix = e.second.to_string();
         prefix_set = true;
@@ -108,6 +114,9 @@ namespace casadi {
       }
     }
 
+    casadi_assert(this->thread_safe || !this->thread_local_mem,
+      "Option 'thread_local_mem' requires 'thread_safe'");
+
     // If real_min is not specified, make an educated guess
     if (this->real_min.empty()) {
       std::stringstream ss;
@@ -1583,6 +1592,30 @@ namespace casadi {
                         << "(casadi_real c, casadi_real x, casadi_real y) "
                         << "{ return c!=0 ? x : y;}\n\n";
       break;
+    case AUX_ATOMIC:
+      // C11 atomics, or C++11 when generating C++
+      this->auxiliaries << "#ifndef CASADI_ATOMIC_INT\n";
+      if (this->cpp) {
+        add_include("atomic");
+        this->auxiliaries
+          << "#define CASADI_ATOMIC_INT std::atomic<int>\n"
+          << "#define CASADI_THREAD_LOCAL thread_local\n"
+          << "#define CASADI_ATOMIC_LOAD(p) (p)->load()\n"
+          << "#define CASADI_ATOMIC_STORE(p, v) (p)->store(v)\n"
+          << "#define CASADI_ATOMIC_FETCH_ADD(p, v) (p)->fetch_add(v)\n"
+          << "#define CASADI_ATOMIC_CAS(p, e, d) (p)->compare_exchange_strong(*(e), d)\n";
+      } else {
+        add_include("stdatomic.h");
+        this->auxiliaries
+          << "#define CASADI_ATOMIC_INT atomic_int\n"
+          << "#define CASADI_THREAD_LOCAL _Thread_local\n"
+          << "#define CASADI_ATOMIC_LOAD(p) atomic_load(p)\n"
+          << "#define CASADI_ATOMIC_STORE(p, v) atomic_store(p, v)\n"
+          << "#define CASADI_ATOMIC_FETCH_ADD(p, v) atomic_fetch_add(p, v)\n"
+          << "#define CASADI_ATOMIC_CAS(p, e, d) atomic_compare_exchange_strong(p, e, d)\n";
+      }
+      this->auxiliaries << "#endif\n\n";
+      break;
     case AUX_PRINTF:
       this->auxiliaries << "#ifndef CASADI_PRINTF\n";
       if (this->mex) {
@@ -2381,6 +2414,16 @@ namespace casadi {
            + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_super(const std::string& sp_a, const std::string& a,
+            const std::string& sp_lt, const std::string& lt, const std::string& d,
+            const std::string& p, const std::string& sn, const std::string& w,
+            const std::string& iw) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_super(" + sp_a + ", " + a + ", " + sp_lt + ", " + lt + ", "
+           + d + ", " + p + ", " + sn + ", " + w + ", " + iw + ");";
+  }
+
   std::string CodeGenerator::
   ldl_solve(const std::string& x, casadi_int nrhs,
     const std::string& sp_lt, const std::string& lt, const std::string& d,
@@ -424,6 +424,14 @@ namespace casadi {
                    const std::string& d, const std::string& p,
                    const std::string& w);
 
+    /** \brief Supernodal LDL factorization
+    */
+    std::string ldl_super(const std::string& sp_a, const std::string& a,
+                          const std::string& sp_lt, const std::string& lt,
+                          const std::string& d, const std::string& p,
+                          const std::string& sn, const std::string& w,
+                          const std::string& iw);
+
     /** \brief LDL solve
 
         \identifier{t3} */
@@ -634,7 +642,8 @@ namespace casadi {
       AUX_ORACLE_CALLBACK,
       AUX_OCP_BLOCK,
       AUX_ORACLE,
-      AUX_SCALED_COPY
+      AUX_SCALED_COPY,
+      AUX_ATOMIC
     };
 
     /** \brief Add a built-in auxiliary function
@@ -874,6 +883,12 @@ namespace casadi {
     // Do we want to be lean on stack usage?
     bool avoid_stack_;
 
+    // Generate checkout/release routines that can be called from several threads?
+    bool thread_safe;
+
+    // Let each thread first try the memory object it released last?
+    bool thread_local_mem;
+
     std::string infinity, nan, real_min;
 
     /** \brief Codegen scalar
@@ -48,7 +48,8 @@ namespace casadi {
     T* r = res[0];
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n = dep(i).nnz();
-      std::copy(arg[i], arg[i]+n, r);
+      // Arguments may have been placed in the result
+      if (arg[i]!=r) std::copy(arg[i], arg[i]+n, r);
       r += n;
     }
     return 0;
@@ -59,7 +60,7 @@ namespace casadi {
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n_i = dep(i).nnz();
       const bvec_t *arg_i_ptr = arg[i];
-      std::copy(arg_i_ptr, arg_i_ptr+n_i, res_ptr);
+      if (arg_i_ptr!=res_ptr) std::copy(arg_i_ptr, arg_i_ptr+n_i, res_ptr);
       res_ptr += n_i;
     }
     return 0;
@@ -70,6 +71,40 @@ namespace casadi {
     for (casadi_int i=0; i<n_dep(); ++i) {
       casadi_int n_i = dep(i).nnz();
       bvec_t *arg_i_ptr = arg[i];
+      if (arg_i_ptr==res_ptr) {
+        res_ptr += n_i;
+        continue;
+      }
+      for (casadi_int k=0; k<n_i; ++k) {
+        *arg_i_ptr++ |= *res_ptr;
+        *res_ptr++ = 0;
+      }
+    }
+    return 0;
+  }
+
+  int Concat::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *res_ptr = res[0];
+    for (casadi_int i=0; i<n_dep(); ++i) {
+      casadi_int n_i = dep(i).nnz()*nw;
+      const bvec_t *arg_i_ptr = arg[i];
+      if (arg_i_ptr!=res_ptr) std::copy(arg_i_ptr, arg_i_ptr+n_i, res_ptr);
+      res_ptr += n_i;
+    }
+    return 0;
+  }
+
+  int Concat::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *res_ptr = res[0];
+    for (casadi_int i=0; i<n_dep(); ++i) {
+      casadi_int n_i = dep(i).nnz()*nw;
+      bvec_t *arg_i_ptr = arg[i];
+      if (arg_i_ptr==res_ptr) {
+        res_ptr += n_i;
+        continue;
+      }
       for (casadi_int k=0; k<n_i; ++k) {
         *arg_i_ptr++ |= *res_ptr;
         *res_ptr++ = 0;
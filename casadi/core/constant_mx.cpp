@@ -126,6 +126,18 @@ namespace casadi {
     return 0;
   }
 
+  int ConstantMX::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    std::fill_n(res[0], nnz()*nw, 0);
+    return 0;
+  }
+
+  int ConstantMX::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    std::fill_n(res[0], nnz()*nw, 0);
+    return 0;
+  }
+
   void ConstantDM::generate(CodeGenerator& g,
                             const std::vector<casadi_int>& arg,
                             const std::vector<casadi_int>& res) const {
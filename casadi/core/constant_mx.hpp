@@ -102,6 +102,14 @@ namespace casadi {
         \identifier{yz} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
     /** \brief Get the operation
 
         \identifier{z0} */
@@ -355,21 +363,32 @@ namespace casadi {
 
         \identifier{zx} */
     explicit ZeroByZero() : ConstantMX(Sparsity(0, 0)) {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
       initSingleton();
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
   public:
     /** \brief Get a pointer to the singleton
 
+        With CASADI_WITH_THREADSAFE_SYMBOLICS, there is one instance per thread
+
         \identifier{zy} */
     static ZeroByZero* getInstance() {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      static thread_local MX instance = MX::create(new ZeroByZero());
+      return static_cast<ZeroByZero*>(instance.get());
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
       static ZeroByZero instance;
       return &instance;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     /// Destructor
     ~ZeroByZero() override {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
       destroySingleton();
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     /** \brief  Print expression
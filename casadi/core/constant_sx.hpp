@@ -36,6 +36,14 @@
 #include <unordered_map>
 #define CACHING_MAP std::unordered_map
 
+/* Instance of a singleton constant. With CASADI_WITH_THREADSAFE_SYMBOLICS, every
+   thread creates its own, owned by casadi_limits<SXElem> and the expressions using it */
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#define CASADI_SX_SINGLETON(T) return new T()
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+#define CASADI_SX_SINGLETON(T) static T instance; return &instance
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
 namespace casadi {
 
 /** \brief Represents a constant SX
@@ -78,6 +86,18 @@ bool is_equal(const SXNode* node, casadi_int depth) const override {
 
 protected:
 
+/// Keep a singleton alive until static destruction, unless instantiated per thread
+void pin_singleton() {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
+  count++;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+}
+void unpin_singleton() {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
+  count--;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+}
+
 /** \brief  Print expression
 
     \identifier{1jo} */
@@ -93,6 +113,59 @@ std::string print(const std::string& arg1, const std::string& arg2) const overri
 
     \identifier{1jp} */
 
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+/** \brief Constants created by the current thread
+
+    The cache holds a reference to each of its constants, so that no other thread
+    can release a constant while a lookup may return it. Constants referenced by
+    the cache only are released when the cache has doubled in size and when the
+    thread exits.
+*/
+template<typename Value, typename Node>
+class ThreadConstantCache {
+public:
+  ThreadConstantCache() : next_sweep_(min_sweep) {}
+
+  ~ThreadConstantCache() {
+    for (auto&& e : cache_) release(e.second);
+  }
+
+  /// Get the constant, creating it if needed
+  Node* get(Value value) {
+    auto it = cache_.find(value);
+    if (it!=cache_.end()) return it->second;
+    if (cache_.size()>=next_sweep_) sweep();
+    Node* n = new Node(value);
+    n->count++;
+    cache_.insert(std::make_pair(value, n));
+    return n;
+  }
+
+private:
+  static const size_t min_sweep = 1024;
+
+  // Release the constants that are referenced by the cache only
+  void sweep() {
+    for (auto it=cache_.begin(); it!=cache_.end(); ) {
+      if (it->second->count==1) {
+        release(it->second);
+        it = cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    next_sweep_ = std::max(min_sweep, 2*cache_.size());
+  }
+
+  static void release(Node* n) {
+    if (--n->count==0) delete n;
+  }
+
+  CACHING_MAP<Value, Node*> cache_;
+  size_t next_sweep_;
+};
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
 /** \brief  Represents a constant real SX
 
   \author Joel Andersson
@@ -108,13 +181,18 @@ class RealtypeSX : public ConstantSX {
 
     /// Destructor
     ~RealtypeSX() override {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
       size_t num_erased = cached_constants_.erase(value);
       assert(num_erased==1);
       (void)num_erased;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     /// Static creator function (use instead of constructor)
     inline static RealtypeSX* create(double value) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      return thread_cache().get(value);
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
       // Try to find the constant
       CACHING_MAP<double, RealtypeSX*>::iterator it = cached_constants_.find(value);
 
@@ -131,6 +209,7 @@ class RealtypeSX : public ConstantSX {
       } else { // Else, returned the object
         return it->second;
       }
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     ///@{
@@ -154,7 +233,12 @@ class RealtypeSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp)
 
         \identifier{1js} */
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    static ThreadConstantCache<double, RealtypeSX>& thread_cache();
+    friend class ThreadConstantCache<double, RealtypeSX>;
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
     static CACHING_MAP<double, RealtypeSX*> cached_constants_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
     /** \brief  Data members
 
@@ -181,13 +265,18 @@ class IntegerSX : public ConstantSX {
 
     /// Destructor
     ~IntegerSX() override {
+#ifndef CASADI_WITH_THREADSAFE_SYMBOLICS
       size_t num_erased = cached_constants_.erase(value);
       assert(num_erased==1);
       (void)num_erased;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     /// Static creator function (use instead of constructor)
     inline static IntegerSX* create(casadi_int value) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      return thread_cache().get(value);
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
       // Try to find the constant
       CACHING_MAP<casadi_int, IntegerSX*>::iterator it = cached_constants_.find(value);
 
@@ -204,6 +293,7 @@ class IntegerSX : public ConstantSX {
       } else { // Else, returned the object
         return it->second;
       }
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
     }
 
     ///@{
@@ -231,7 +321,12 @@ class IntegerSX : public ConstantSX {
      * (storage is allocated for it in sx_element.cpp)
 
         \identifier{1jx} */
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    static ThreadConstantCache<casadi_int, IntegerSX>& thread_cache();
+    friend class ThreadConstantCache<casadi_int, IntegerSX>;
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
     static CACHING_MAP<casadi_int, IntegerSX*> cached_constants_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
     /** \brief  Data members
 
@@ -248,15 +343,14 @@ class IntegerSX : public ConstantSX {
 class ZeroSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit ZeroSX() {this->count++;}
+  explicit ZeroSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static ZeroSX* singleton() {
-    static ZeroSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(ZeroSX);
   }
   /* Destructor */
-  ~ZeroSX() override {this->count--;}
+  ~ZeroSX() override {unpin_singleton();}
   ///@{
   /** \brief  Get the value
 
@@ -289,15 +383,14 @@ public:
 class OneSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit OneSX() {this->count++;}
+  explicit OneSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static OneSX* singleton() {
-    static OneSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(OneSX);
   }
   /* Destructor */
-  ~OneSX() override {this->count--;}
+  ~OneSX() override {unpin_singleton();}
   /** \brief  Get the value
 
       \identifier{1k3} */
@@ -326,15 +419,14 @@ public:
 class MinusOneSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit MinusOneSX() {this->count++;}
+  explicit MinusOneSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static MinusOneSX* singleton() {
-    static MinusOneSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(MinusOneSX);
   }
   /* Destructor */
-  ~MinusOneSX() override {this->count--;}
+  ~MinusOneSX() override {unpin_singleton();}
 
   ///@{
   /** \brief  Get the value
@@ -368,15 +460,14 @@ public:
 class InfSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit InfSX() {this->count++;}
+  explicit InfSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static InfSX* singleton() {
-    static InfSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(InfSX);
   }
   /* Destructor */
-  ~InfSX() override {this->count--;}
+  ~InfSX() override {unpin_singleton();}
   /** \brief  Get the value
 
       \identifier{1k9} */
@@ -403,15 +494,14 @@ public:
 class MinusInfSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit MinusInfSX() {this->count++;}
+  explicit MinusInfSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static MinusInfSX* singleton() {
-    static MinusInfSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(MinusInfSX);
   }
   /* Destructor */
-  ~MinusInfSX() override {this->count--;}
+  ~MinusInfSX() override {unpin_singleton();}
 
   /** \brief  Get the value
 
@@ -437,15 +527,14 @@ public:
 class NanSX : public ConstantSX {
 private:
   /* Private constructor (singleton class) */
-  explicit NanSX() {this->count++;}
+  explicit NanSX() {pin_singleton();}
 public:
   /* Get singleton instance */
   static NanSX* singleton() {
-    static NanSX instance;
-    return &instance;
+    CASADI_SX_SINGLETON(NanSX);
   }
   /* Destructor */
-  ~NanSX() override {this->count--;}
+  ~NanSX() override {unpin_singleton();}
   /** \brief  Get the value
 
       \identifier{1kf} */
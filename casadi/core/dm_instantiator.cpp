@@ -379,6 +379,15 @@ namespace casadi {
 
   // Instantiate templates
   template class CASADI_EXPORT casadi_limits<double>;
+  // The member specializations above instantiate the class implicitly, so GCC ignores
+  // the export attribute here, other compilers (dllexport) still need it
+#if __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#endif
   template class CASADI_EXPORT Matrix<double>;
+#if __GNUC__
+#pragma GCC diagnostic pop
+#endif
 
 } // namespace casadi
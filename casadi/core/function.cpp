@@ -36,6 +36,7 @@
 #include "serializing_stream.hpp"
 #include "serializer.hpp"
 #include "tools.hpp"
+#include "thread_pool.hpp"
 
 #include <cctype>
 #include <fstream>
@@ -1967,4 +1968,333 @@ namespace casadi {
     static_cast<FunctionBuffer*>(raw)->_eval();
   }
 
+  Evaluator::Evaluator() : f_node_(nullptr), mem_(-1), mem_internal_(nullptr), direct_(false) {
+  }
+
+  Evaluator::Evaluator(const Function& f) {
+    init(f);
+  }
+
+  Evaluator::~Evaluator() {
+    clear();
+  }
+
+  Evaluator::Evaluator(const Evaluator& e) {
+    init(e.f_);
+    operator=(e);
+  }
+
+  Evaluator& Evaluator::operator=(const Evaluator& e) {
+    if (this==&e) return *this;
+    if (f_.get()!=e.f_.get()) {
+      clear();
+      init(e.f_);
+    }
+    if (f_.is_null()) return *this;
+    // Copy input values, redirected inputs and outputs point to the same buffers
+    std::copy(e.w_.begin(), e.w_.begin() + (e.out_.back() - e.w_.data()), w_.begin());
+    for (casadi_int i=0; i+1<in_.size(); ++i) {
+      arg_[i] = e.arg_[i]==e.in_[i] ? in_[i] : e.arg_[i];
+    }
+    for (casadi_int i=0; i+1<out_.size(); ++i) {
+      res_[i] = e.res_[i]==e.out_[i] ? out_[i] : e.res_[i];
+    }
+    return *this;
+  }
+
+  Evaluator::Evaluator(Evaluator&& e) : f_node_(nullptr), mem_(-1), mem_internal_(nullptr),
+      direct_(false) {
+    operator=(std::move(e));
+  }
+
+  Evaluator& Evaluator::operator=(Evaluator&& e) {
+    if (this==&e) return *this;
+    clear();
+    // The buffers do not move, the pinned memory object is taken over
+    f_ = e.f_;
+    f_node_ = e.f_node_;
+    mem_ = e.mem_;
+    mem_internal_ = e.mem_internal_;
+    direct_ = e.direct_;
+    w_.swap(e.w_);
+    iw_.swap(e.iw_);
+    arg_.swap(e.arg_);
+    res_.swap(e.res_);
+    in_.swap(e.in_);
+    out_.swap(e.out_);
+    e.f_ = Function();
+    e.f_node_ = nullptr;
+    e.mem_ = -1;
+    return *this;
+  }
+
+  void Evaluator::init(const Function& f) {
+    f_ = f;
+    f_node_ = f.is_null() ? nullptr : f.get();
+    mem_ = -1;
+    mem_internal_ = nullptr;
+    direct_ = false;
+    if (f.is_null()) return;
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+    casadi_int nnz_io = f.nnz_in() + f.nnz_out();
+    w_.resize(nnz_io + f.sz_w());
+    iw_.resize(f.sz_iw());
+    arg_.resize(f.sz_arg());
+    res_.resize(f.sz_res());
+    in_.resize(n_in + 1);
+    out_.resize(n_out + 1);
+    in_[0] = get_ptr(w_);
+    for (casadi_int i=0; i<n_in; ++i) {
+      arg_[i] = in_[i];
+      in_[i+1] = in_[i] + f.nnz_in(i);
+      // Inputs not set evaluate as if omitted from a call
+      std::fill(in_[i], in_[i+1], f.default_in(i));
+    }
+    out_[0] = in_[n_in];
+    for (casadi_int i=0; i<n_out; ++i) {
+      res_[i] = out_[i];
+      out_[i+1] = out_[i] + f.nnz_out(i);
+    }
+    // Anything acting around a call needs the generic path
+    direct_ = !f_node_->eval_ && !f_node_->print_in_ && !f_node_->print_out_
+      && !f_node_->dump_in_ && !f_node_->dump_out_ && !f_node_->dump_
+      && !f_node_->print_time_ && !f_node_->record_time_ && !f_node_->regularity_check_;
+    mem_ = f.checkout();
+    mem_internal_ = f.memory(mem_);
+  }
+
+  void Evaluator::clear() {
+    if (mem_>=0) f_.release(mem_);
+    mem_ = -1;
+  }
+
+  int Evaluator::operator()() {
+    casadi_assert(f_node_!=nullptr, "Cannot evaluate a null Evaluator");
+    double* w = out_.back();
+    try {
+      if (direct_) {
+        // Statistics of this call only, cf. FunctionInternal::eval_gen
+        auto m = static_cast<ProtoFunctionMemory*>(mem_internal_);
+        for (auto&& s : m->fstats) s.second.reset();
+        if (m->t_total) m->t_total->tic();
+        int ret = f_node_->eval(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), w, mem_internal_);
+        if (m->t_total) m->t_total->toc();
+        return ret;
+      } else {
+        return f_node_->eval_gen(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), w, mem_internal_);
+      }
+    } catch(std::exception& e) {
+      casadi_error("Error in Evaluator for '" + f_.name() + "':\n" + std::string(e.what()));
+    }
+  }
+
+  struct FunctionFuture::State {
+    // Function to be evaluated
+    Function f;
+    // Inputs, unless read from buffers or from the outputs of source
+    std::vector<DM> arg_dm;
+    // Future providing the inputs, if any
+    std::shared_ptr<State> source;
+    // Buffers of the caller, if any
+    bool buffers;
+    std::vector<const double*> arg;
+    std::vector<double*> res;
+    // Futures that must complete first
+    std::vector<std::shared_ptr<State> > after;
+    // Number of dependencies not yet completed, plus one until queued
+    std::atomic<casadi_int> n_pending;
+    // Outputs
+    std::vector<DM> out;
+    // Result
+    bool done;
+    int ret;
+    std::string err;
+    // Callbacks upon completion
+    std::vector<std::function<void()> > on_done;
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+    std::condition_variable cv;
+#endif // CASADI_WITH_THREAD
+
+    State(const Function& f) : f(f), buffers(false), n_pending(1), done(false), ret(0) {}
+
+    // Evaluate cb once completed, immediately if already completed
+    void when_done(const std::function<void()>& cb) {
+      {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREAD
+        if (!done) {
+          on_done.push_back(cb);
+          return;
+        }
+      }
+      cb();
+    }
+
+    // A dependency completed, queue the evaluation after the last one
+    static void dependency_done(const std::shared_ptr<State>& s) {
+      if (--s->n_pending==0) ThreadPool::instance()->submit([s]() { s->run();});
+    }
+
+    // Queue the evaluation once all dependencies have completed
+    static void launch(const std::shared_ptr<State>& s) {
+      std::vector<std::shared_ptr<State> > dep = s->after;
+      if (s->source) dep.push_back(s->source);
+      s->n_pending += dep.size();
+      for (auto&& d : dep) d->when_done([s]() { dependency_done(s);});
+      dependency_done(s);
+    }
+
+    // Evaluate and signal completion
+    void run() {
+      int flag = 0;
+      std::string msg;
+      try {
+        // Dependencies must have succeeded
+        for (auto&& d : after) {
+          casadi_assert(d->ret==0, "Dependency failed: " + d->err);
+        }
+        if (source) {
+          casadi_assert(source->ret==0, "Dependency failed: " + source->err);
+          arg_dm = f->project_arg(f->replace_arg(source->out, -1), 1);
+        }
+        // Buffers
+        std::vector<const double*> argp(f.sz_arg(), nullptr);
+        std::vector<double*> resp(f.sz_res(), nullptr);
+        if (buffers) {
+          std::copy(arg.begin(), arg.end(), argp.begin());
+          std::copy(res.begin(), res.end(), resp.begin());
+        } else {
+          out.resize(f.n_out());
+          for (casadi_int i=0; i<f.n_in(); ++i) argp[i] = get_ptr(arg_dm[i].nonzeros());
+          for (casadi_int i=0; i<f.n_out(); ++i) {
+            out[i] = DM::zeros(f.sparsity_out(i));
+            resp[i] = get_ptr(out[i].nonzeros());
+          }
+        }
+        std::vector<casadi_int> iw(f.sz_iw());
+        std::vector<double> w(f.sz_w());
+        // Evaluate with a memory object of our own
+        scoped_checkout<Function> mem(f);
+        flag = f(get_ptr(argp), get_ptr(resp), get_ptr(iw), get_ptr(w), mem);
+        if (flag) msg = "Evaluation failed";
+      } catch (std::exception& e) {
+        flag = 1;
+        msg = e.what();
+      }
+      // Signal completion, dropping references to other evaluations
+      std::vector<std::function<void()> > cb;
+      {
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREAD
+        ret = flag;
+        err = msg;
+        done = true;
+        cb.swap(on_done);
+        after.clear();
+        source.reset();
+        arg_dm.clear();
+      }
+#ifdef CASADI_WITH_THREAD
+      cv.notify_all();
+#endif // CASADI_WITH_THREAD
+      for (auto&& c : cb) c();
+    }
+  };
+
+  FunctionFuture::FunctionFuture() {
+  }
+
+  bool FunctionFuture::ready() const {
+    casadi_assert(!is_null(), "Null future");
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(state_->mtx);
+#endif // CASADI_WITH_THREAD
+    return state_->done;
+  }
+
+  int FunctionFuture::wait() const {
+    casadi_assert(!is_null(), "Null future");
+    State& s = *state_;
+#ifdef CASADI_WITH_THREAD
+    ThreadPool::instance()->wait([&s]() { return s.done;}, s.mtx, s.cv);
+#endif // CASADI_WITH_THREAD
+    return s.ret;
+  }
+
+  const std::vector<DM>& FunctionFuture::get() const {
+    if (wait()) {
+      casadi_error("Asynchronous evaluation of '" + state_->f.name() + "' failed:\n"
+        + state_->err);
+    }
+    return state_->out;
+  }
+
+  std::string FunctionFuture::error() const {
+    wait();
+    return state_->err;
+  }
+
+  FunctionFuture FunctionFuture::then(const Function& g) const {
+    return g.eval_async(*this);
+  }
+
+  FunctionFuture Function::eval_async(const std::vector<DM>& arg,
+      const std::vector<FunctionFuture>& after) const {
+    try {
+      casadi_int npar = -1;
+      (*this)->check_arg(arg, npar);
+      auto s = std::make_shared<FunctionFuture::State>(*this);
+      s->arg_dm = (*this)->project_arg((*this)->replace_arg(arg, npar), 1);
+      for (auto&& a : after) {
+        casadi_assert(!a.is_null(), "Null future");
+        s->after.push_back(a.state_);
+      }
+      FunctionFuture::State::launch(s);
+      return FunctionFuture(s);
+    } catch(std::exception& e) {
+      THROW_ERROR("eval_async", e.what());
+    }
+  }
+
+  FunctionFuture Function::eval_async(const std::vector<const double*>& arg,
+      const std::vector<double*>& res, const std::vector<FunctionFuture>& after) const {
+    try {
+      casadi_assert(arg.size()==n_in(), "Incorrect number of inputs: Expected "
+        + str(n_in()) + ", got " + str(arg.size()));
+      casadi_assert(res.size()==n_out(), "Incorrect number of outputs: Expected "
+        + str(n_out()) + ", got " + str(res.size()));
+      auto s = std::make_shared<FunctionFuture::State>(*this);
+      s->buffers = true;
+      s->arg = arg;
+      s->res = res;
+      for (auto&& a : after) {
+        casadi_assert(!a.is_null(), "Null future");
+        s->after.push_back(a.state_);
+      }
+      FunctionFuture::State::launch(s);
+      return FunctionFuture(s);
+    } catch(std::exception& e) {
+      THROW_ERROR("eval_async", e.what());
+    }
+  }
+
+  FunctionFuture Function::eval_async(const FunctionFuture& arg) const {
+    try {
+      casadi_assert(!arg.is_null(), "Null future");
+      casadi_assert(!arg.state_->buffers,
+        "Outputs of an evaluation with caller buffers are not available");
+      casadi_assert(arg.state_->f.n_out()==n_in(), "Incorrect number of inputs: Expected "
+        + str(n_in()) + ", got " + str(arg.state_->f.n_out()));
+      auto s = std::make_shared<FunctionFuture::State>(*this);
+      s->source = arg.state_;
+      FunctionFuture::State::launch(s);
+      return FunctionFuture(s);
+    } catch(std::exception& e) {
+      THROW_ERROR("eval_async", e.what());
+    }
+  }
+
 } // namespace casadi
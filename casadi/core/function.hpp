@@ -29,6 +29,7 @@
 #include "mx.hpp"
 #include "printable.hpp"
 #include <exception>
+#include <memory>
 #include <stack>
 
 namespace casadi {
@@ -38,6 +39,49 @@ namespace casadi {
   class FunctionInternal;
   class SerializingStream;
   class DeserializingStream;
+  class Function;
+
+  /** \brief Result of an asynchronous evaluation, see Function::eval_async
+
+      Copies refer to the same evaluation. A future can be passed as a dependency to
+      later asynchronous evaluations, which are then queued on the thread pool as soon
+      as it completes, without blocking the caller. This allows e.g. an integrator
+      call for the next horizon to overlap with a QP solve for the current one.
+  */
+  class CASADI_EXPORT FunctionFuture {
+  public:
+    /// Null future
+    FunctionFuture();
+
+    /// Is the future null?
+    bool is_null() const { return state_==nullptr;}
+
+    /// Has the evaluation completed, successfully or not?
+    bool ready() const;
+
+    /// Wait for completion, returns the return code of the function (0 on success)
+    int wait() const;
+
+    /** \brief Wait for completion and get the outputs
+
+        Raises an error if the evaluation failed. Empty when the outputs were
+        written to buffers of the caller. */
+    const std::vector<DM>& get() const;
+
+    /// Wait for completion and get the error message, empty if successful
+    std::string error() const;
+
+    /// Evaluate g on the outputs once this evaluation has completed
+    FunctionFuture then(const Function& g) const;
+
+    /// Shared state, internal
+    struct State;
+
+  private:
+    explicit FunctionFuture(const std::shared_ptr<State>& state) : state_(state) {}
+    std::shared_ptr<State> state_;
+    friend class Function;
+  };
 #endif // SWIG
 
   /** \brief Function object
@@ -632,6 +676,26 @@ namespace casadi {
         \identifier{1wg} */
     int rev(std::vector<bvec_t*> arg, std::vector<bvec_t*> res) const;
 
+    ///@{
+    /** \brief Evaluate numerically on the thread pool, returning immediately
+
+        The evaluation is queued once all futures in \p after have completed and
+        runs with a memory object checked out for its duration. If any of them
+        failed, the evaluation is skipped and reported as failed.
+
+        The buffer version reads from and writes to the caller's buffers, which
+        must remain valid until the returned future is ready. The version taking a
+        future evaluates the function on the outputs of that future.
+
+        \sa FunctionFuture */
+    FunctionFuture eval_async(const std::vector<DM>& arg,
+      const std::vector<FunctionFuture>& after=std::vector<FunctionFuture>()) const;
+    FunctionFuture eval_async(const std::vector<const double*>& arg,
+      const std::vector<double*>& res,
+      const std::vector<FunctionFuture>& after=std::vector<FunctionFuture>()) const;
+    FunctionFuture eval_async(const FunctionFuture& arg) const;
+    ///@}
+
 #endif // SWIG
 
     /** \brief  Evaluate symbolically in parallel and sum (matrix graph)
@@ -1338,6 +1402,89 @@ public:
 
 void CASADI_EXPORT _function_buffer_eval(void* raw);
 
+#ifndef SWIG
+/** \brief Evaluator with pinned memory for repeated numerical calls from C++
+
+    Checks out a memory object of the function on construction and keeps it until
+    destruction. The evaluator owns buffers for the nonzeros of all inputs and outputs
+    as well as the work vectors, so that a call involves no heap allocation, no memory
+    checkout and no dimension checks. Inputs and outputs can be redirected to
+    external buffers of sufficient length.
+
+    An evaluator must not be called from several threads at the same time, use one
+    evaluator per thread instead. Functions with options that act around each call
+    (e.g. print_in, dump_in, print_time, regularity_check) and compiled functions are
+    evaluated through the generic path.
+*/
+class CASADI_EXPORT Evaluator {
+public:
+  /// Null evaluator
+  Evaluator();
+
+  /// Check out a memory object of f and allocate the buffers
+  explicit Evaluator(const Function& f);
+
+  /// Releases the memory object
+  ~Evaluator();
+
+  ///@{
+  /// Copies check out a memory object of their own
+  Evaluator(const Evaluator& e);
+  Evaluator& operator=(const Evaluator& e);
+  Evaluator(Evaluator&& e);
+  Evaluator& operator=(Evaluator&& e);
+  ///@}
+
+  /// Function that is evaluated
+  const Function& function() const { return f_;}
+
+  /// Index of the pinned memory object
+  int mem() const { return mem_;}
+
+  /// Buffer holding the nonzeros of input i, column-major, nnz_in(i) long, initially default_in(i)
+  double* input(casadi_int i) { return in_[i];}
+
+  /// Buffer holding the nonzeros of output i, column-major, nnz_out(i) long
+  double* output(casadi_int i) { return out_[i];}
+
+  /// Number of nonzeros of input i
+  casadi_int nnz_in(casadi_int i) const { return in_[i+1] - in_[i];}
+
+  /// Number of nonzeros of output i
+  casadi_int nnz_out(casadi_int i) const { return out_[i+1] - out_[i];}
+
+  /// Read input i from a, nullptr for all zeros, input(i) for the owned buffer
+  void set_input(casadi_int i, const double* a) { arg_[i] = a;}
+
+  /// Write output i to r, nullptr if not needed, output(i) for the owned buffer
+  void set_output(casadi_int i, double* r) { res_[i] = r;}
+
+  /// Evaluate, returns the return code of the function (0 on success)
+  int operator()();
+
+private:
+  /// Allocate the buffers and check out a memory object
+  void init(const Function& f);
+
+  /// Release the memory object
+  void clear();
+
+  Function f_;
+  FunctionInternal* f_node_;
+  int mem_;
+  void* mem_internal_;
+  // Evaluate without the generic path
+  bool direct_;
+  // Input and output nonzeros, followed by the work vector
+  std::vector<double> w_;
+  std::vector<casadi_int> iw_;
+  std::vector<const double*> arg_;
+  std::vector<double*> res_;
+  // Start of each input and output in w_, n_in+1 and n_out+1 long
+  std::vector<double*> in_, out_;
+};
+#endif // SWIG
+
 
 } // namespace casadi
 
@@ -54,6 +54,9 @@
 namespace casadi {
 
   ProtoFunction::ProtoFunction(const std::string& name) : name_(name) {
+    for (auto&& b : mem_block_) b = nullptr;
+    n_mem_ = 0;
+    reset_mem();
     // Default options (can be overridden in derived classes)
     verbose_ = false;
     print_time_ = false;
@@ -115,10 +118,10 @@ namespace casadi {
   }
 
   ProtoFunction::~ProtoFunction() {
-    for (void* m : mem_) {
-      if (m!=nullptr) casadi_warning("Memory object has not been properly freed");
+    for (int i=0; i<n_mem_; ++i) {
+      if (mem_slot(i).mem!=nullptr) casadi_warning("Memory object has not been properly freed");
     }
-    mem_.clear();
+    reset_mem();
   }
 
   FunctionInternal::~FunctionInternal() {
@@ -317,7 +320,11 @@ namespace casadi {
         "Options to be passed to a reverse mode constructor"}},
       {"jacobian_options",
        {OT_DICT,
-        "Options to be passed to a Jacobian constructor"}},
+        "Options to be passed to a Jacobian constructor. With \"parallelization\": "
+        "\"thread\", the color groups are evaluated concurrently, each with its own memory. "
+        "\"coloring_ordering\" (natural|largest_first|smallest_last|incidence_degree) and "
+        "\"coloring_threads\" control the graph coloring. \"coloring_threads\" is ignored "
+        "for symmetric patterns, which are colored sequentially (star and acyclic coloring)"}},
       {"der_options",
        {OT_DICT,
         "Default options to be used to populate forward_options, reverse_options, and "
@@ -1054,6 +1061,15 @@ namespace casadi {
       opts["max_num_dir"] = max_num_dir_;
       opts["is_diff_in"] = is_diff_in_;
       opts["is_diff_out"] = is_diff_out_;
+      // The Jacobian is calculated from the wrapper, e.g. with "parallelization",
+      // options meant for a Jacobian of this class are not understood by it
+      if (!has_jacobian()) {
+        Dict jac_opts;
+        for (auto&& op : jacobian_options_) {
+          if (MXFunction::options_.find(op.first)) jac_opts[op.first] = op.second;
+        }
+        opts["jacobian_options"] = jac_opts;
+      }
       // Wrap the function
       std::vector<MX> arg = mx_in();
       std::vector<MX> res = self()(arg);
@@ -1087,6 +1103,20 @@ namespace casadi {
     r = 0;
     for (casadi_int i=begin; i<end; ++i) r |= s[i];
   }
+
+  void bvec_toggle(bvec_t* s, casadi_int begin, casadi_int end, casadi_int j, casadi_int nw) {
+    bvec_t* sj = s + j/bvec_size;
+    bvec_t b = bvec_t(1) << (j%bvec_size);
+    for (casadi_int i=begin; i<end; ++i) {
+      sj[i*nw] ^= b;
+    }
+  }
+
+  void bvec_or(const bvec_t* s, bvec_t & r, casadi_int begin, casadi_int end,
+      casadi_int nw, casadi_int j) {
+    r = 0;
+    for (casadi_int i=begin; i<end; ++i) r |= s[i*nw+j];
+  }
   /// \endcond
 
   // Traits
@@ -1095,9 +1125,9 @@ namespace casadi {
     typedef const bvec_t* arg_t;
     static inline void sp(const FunctionInternal *f,
                           const bvec_t** arg, bvec_t** res,
-                          casadi_int* iw, bvec_t* w, void* mem) {
+                          casadi_int* iw, bvec_t* w, void* mem, casadi_int nw=1) {
       std::vector<const bvec_t*> argm(f->sz_arg(), nullptr);
-      std::vector<bvec_t> wm(f->nnz_in(), bvec_t(0));
+      std::vector<bvec_t> wm(f->nnz_in()*nw, bvec_t(0));
       bvec_t* wp = get_ptr(wm);
 
       for (casadi_int i=0;i<f->n_in_;++i) {
@@ -1105,12 +1135,16 @@ namespace casadi {
           argm[i] = arg[i];
         } else  {
           argm[i] = arg[i] ? wp : nullptr;
-          wp += f->nnz_in(i);
+          wp += f->nnz_in(i)*nw;
         }
       }
-      f->sp_forward(get_ptr(argm), res, iw, w, mem);
+      if (nw==1) {
+        f->sp_forward(get_ptr(argm), res, iw, w, mem);
+      } else {
+        f->sp_forward_wide(get_ptr(argm), res, iw, w, mem, nw);
+      }
       for (casadi_int i=0;i<f->n_out_;++i) {
-        if (!f->is_diff_out_[i] && res[i]) casadi_clear(res[i], f->nnz_out(i));
+        if (!f->is_diff_out_[i] && res[i]) casadi_clear(res[i], f->nnz_out(i)*nw);
       }
     }
   };
@@ -1118,13 +1152,17 @@ namespace casadi {
     typedef bvec_t* arg_t;
     static inline void sp(const FunctionInternal *f,
                           bvec_t** arg, bvec_t** res,
-                          casadi_int* iw, bvec_t* w, void* mem) {
+                          casadi_int* iw, bvec_t* w, void* mem, casadi_int nw=1) {
       for (casadi_int i=0;i<f->n_out_;++i) {
-        if (!f->is_diff_out_[i] && res[i]) casadi_clear(res[i], f->nnz_out(i));
+        if (!f->is_diff_out_[i] && res[i]) casadi_clear(res[i], f->nnz_out(i)*nw);
+      }
+      if (nw==1) {
+        f->sp_reverse(arg, res, iw, w, mem);
+      } else {
+        f->sp_reverse_wide(arg, res, iw, w, mem, nw);
       }
-      f->sp_reverse(arg, res, iw, w, mem);
       for (casadi_int i=0;i<f->n_in_;++i) {
-        if (!f->is_diff_in_[i] && arg[i]) casadi_clear(arg[i], f->nnz_in(i));
+        if (!f->is_diff_in_[i] && arg[i]) casadi_clear(arg[i], f->nnz_in(i)*nw);
       }
     }
   };
@@ -1135,27 +1173,34 @@ namespace casadi {
     casadi_int nz_in = nnz_in(iind);
     casadi_int nz_out = nnz_out(oind);
 
+    // Number of bvec_t per nonzero
+    casadi_int nw = sp_width(fwd ? nz_in : nz_out);
+
+    // Number of seed directions per sweep
+    casadi_int nbits = nw*bvec_size;
+
     // Evaluation buffers
     std::vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), nullptr);
     std::vector<bvec_t*> res(sz_res(), nullptr);
     std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w(), 0);
+    std::vector<bvec_t> w(sz_w()*nw, 0);
 
     // Seeds and sensitivities
-    std::vector<bvec_t> seed(nz_in, 0);
+    std::vector<bvec_t> seed(nz_in*nw, 0);
     arg[iind] = get_ptr(seed);
-    std::vector<bvec_t> sens(nz_out, 0);
+    std::vector<bvec_t> sens(nz_out*nw, 0);
     res[oind] = get_ptr(sens);
     if (!fwd) std::swap(seed, sens);
+    casadi_int nz_seed = seed.size()/nw, nz_sens = sens.size()/nw;
 
     // Number of forward sweeps we must make
-    casadi_int nsweep = seed.size() / bvec_size;
-    if (seed.size() % bvec_size) nsweep++;
+    casadi_int nsweep = nz_seed / nbits;
+    if (nz_seed % nbits) nsweep++;
 
     // Print
     if (verbose_) {
       casadi_message(str(nsweep) + std::string(fwd ? " forward" : " reverse") + " sweeps "
-                     "needed for " + str(seed.size()) + " directions");
+                     "needed for " + str(nz_seed) + " directions");
     }
 
     // Progress
@@ -1164,7 +1209,7 @@ namespace casadi {
     // Temporary vectors
     std::vector<casadi_int> jcol, jrow;
 
-    // Loop over the variables, bvec_size variables at a time
+    // Loop over the variables, nbits variables at a time
     for (casadi_int s=0; s<nsweep; ++s) {
 
       // Print progress
@@ -1178,42 +1223,45 @@ namespace casadi {
       }
 
       // Nonzero offset
-      casadi_int offset = s*bvec_size;
+      casadi_int offset = s*nbits;
 
       // Number of local seed directions
-      casadi_int ndir_local = seed.size()-offset;
-      ndir_local = std::min(static_cast<casadi_int>(bvec_size), ndir_local);
+      casadi_int ndir_local = nz_seed-offset;
+      ndir_local = std::min(nbits, ndir_local);
 
       for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] |= bvec_t(1)<<i;
+        seed[(offset+i)*nw + i/bvec_size] |= bvec_t(1)<<(i%bvec_size);
       }
 
       // Propagate the dependencies
       JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
-                                  get_ptr(iw), get_ptr(w), memory(0));
+                                  get_ptr(iw), get_ptr(w), memory(0), nw);
 
       // Loop over the nonzeros of the output
-      for (casadi_int el=0; el<sens.size(); ++el) {
-
-        // Get the sparsity sensitivity
-        bvec_t spsens = sens[el];
-
-        if (!fwd) {
-          // Clear the sensitivities for the next sweep
-          sens[el] = 0;
-        }
+      for (casadi_int el=0; el<nz_sens; ++el) {
+        // Loop over the words of the nonzero
+        for (casadi_int j=0; j<nw; ++j) {
+          // Get the sparsity sensitivity
+          bvec_t spsens = sens[el*nw+j];
+
+          if (!fwd) {
+            // Clear the sensitivities for the next sweep
+            sens[el*nw+j] = 0;
+          }
 
-        // If there is a dependency in any of the directions
-        if (spsens!=0) {
+          // If there is a dependency in any of the directions
+          if (spsens!=0) {
 
-          // Loop over seed directions
-          for (casadi_int i=0; i<ndir_local; ++i) {
+            // Loop over seed directions
+            casadi_int i_end = std::min(ndir_local-j*bvec_size, static_cast<casadi_int>(bvec_size));
+            for (casadi_int i=0; i<i_end; ++i) {
 
-            // If dependents on the variable
-            if ((bvec_t(1) << i) & spsens) {
-              // Add to pattern
-              jcol.push_back(el);
-              jrow.push_back(i+offset);
+              // If dependents on the variable
+              if ((bvec_t(1) << i) & spsens) {
+                // Add to pattern
+                jcol.push_back(el);
+                jrow.push_back(j*bvec_size+i+offset);
+              }
             }
           }
         }
@@ -1221,7 +1269,7 @@ namespace casadi {
 
       // Remove the seeds
       for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] = 0;
+        seed[(offset+i)*nw + i/bvec_size] = 0;
       }
     }
 
@@ -1243,18 +1291,22 @@ namespace casadi {
     casadi_int nz = nnz_in(iind);
     casadi_assert_dev(nz==nnz_out(oind));
 
+    // Number of bvec_t per nonzero and number of directions per sweep
+    casadi_int nw = sp_width(nz);
+    casadi_int nbits = nw*bvec_size;
+
     // Evaluation buffers
     std::vector<const bvec_t*> arg(sz_arg(), nullptr);
     std::vector<bvec_t*> res(sz_res(), nullptr);
     std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w());
+    std::vector<bvec_t> w(sz_w()*nw);
 
     // Seeds
-    std::vector<bvec_t> seed(nz, 0);
+    std::vector<bvec_t> seed(nz*nw, 0);
     arg[iind] = get_ptr(seed);
 
     // Sensitivities
-    std::vector<bvec_t> sens(nz, 0);
+    std::vector<bvec_t> sens(nz*nw, 0);
     res[oind] = get_ptr(sens);
 
     // Sparsity triplet accumulator
@@ -1267,7 +1319,7 @@ namespace casadi {
     std::vector<casadi_int> fine;
 
     // In each iteration, subdivide each coarse block in this many fine blocks
-    casadi_int subdivision = bvec_size;
+    casadi_int subdivision = nbits;
 
     Sparsity r = Sparsity::dense(1, 1);
 
@@ -1333,7 +1385,7 @@ namespace casadi {
 
 
         casadi_int fci_offset = 0;
-        casadi_int fci_cap = bvec_size-bvec_i;
+        casadi_int fci_cap = nbits-bvec_i;
 
         // Flag to indicate if all fine blocks have been handled
         bool f_finished = false;
@@ -1369,7 +1421,7 @@ namespace casadi {
 
               // Toggle on seeds
               bvec_toggle(get_ptr(seed), fine[fci+fci_start], fine[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+                          bvec_i+bvec_i_mod, nw);
               bvec_i_mod++;
             }
           }
@@ -1378,28 +1430,28 @@ namespace casadi {
           bvec_i += std::min(n_fine_blocks_max, fci_cap);
 
           // Check if bvec buffer is full
-          if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+          if (bvec_i==nbits || csd==D.size2()-1) {
+            // Calculate sparsity for nbits directions at once
 
             // Statistics
             nsweeps+=1;
 
             // Construct lookup table
             IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value,
-                                    bvec_size, coarse.size());
+                                    nbits, coarse.size());
 
             std::reverse(lookup_col.begin(), lookup_col.end());
             std::reverse(lookup_row.begin(), lookup_row.end());
             std::reverse(lookup_value.begin(), lookup_value.end());
             IM duplicates =
-              IM::triplet(lookup_row, lookup_col, lookup_value, bvec_size, coarse.size())
+              IM::triplet(lookup_row, lookup_col, lookup_value, nbits, coarse.size())
               - lookup;
             duplicates = sparsify(duplicates);
-            lookup(duplicates.sparsity()) = -bvec_size;
+            lookup(duplicates.sparsity()) = -nbits;
 
             // Propagate the dependencies
             JacSparsityTraits<true>::sp(this, get_ptr(arg), get_ptr(res),
-              get_ptr(iw), get_ptr(w), nullptr);
+              get_ptr(iw), get_ptr(w), nullptr, nw);
 
             // Temporary bit work vector
             bvec_t spsens;
@@ -1409,21 +1461,28 @@ namespace casadi {
 
               // Loop over the cols of fine blocks within the current coarse block
               for (casadi_int fri=fine_lookup[coarse[cri]];fri<fine_lookup[coarse[cri+1]];++fri) {
-                // Lump individual sensitivities together into fine block
-                bvec_or(get_ptr(sens), spsens, fine[fri], fine[fri+1]);
-
-                // Loop over all bvec_bits
-                for (casadi_int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & (bvec_t(1) << bvec_i)) {
-                    // if dependency is found, add it to the new sparsity pattern
-                    casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
-                    if (ind==-1) continue;
-                    casadi_int lk = lookup->at(ind);
-                    if (lk>-bvec_size) {
-                      jrow.push_back(bvec_i+lk);
-                      jcol.push_back(fri);
-                      jrow.push_back(fri);
-                      jcol.push_back(bvec_i+lk);
+                // Loop over the words of the bit vectors
+                for (casadi_int j=0; j<nw; ++j) {
+                  // Lump individual sensitivities together into fine block
+                  bvec_or(get_ptr(sens), spsens, fine[fri], fine[fri+1], nw, j);
+
+                  // Next iteration if no sparsity
+                  if (!spsens) continue;
+
+                  // Loop over all bvec_bits
+                  for (casadi_int b=0; b<bvec_size; ++b) {
+                    if (spsens & (bvec_t(1) << b)) {
+                      casadi_int bvec_i = j*bvec_size + b;
+                      // if dependency is found, add it to the new sparsity pattern
+                      casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
+                      if (ind==-1) continue;
+                      casadi_int lk = lookup->at(ind);
+                      if (lk>-nbits) {
+                        jrow.push_back(bvec_i+lk);
+                        jcol.push_back(fri);
+                        jrow.push_back(fri);
+                        jcol.push_back(bvec_i+lk);
+                      }
                     }
                   }
                 }
@@ -1442,7 +1501,7 @@ namespace casadi {
           if (n_fine_blocks_max>fci_cap) {
             fci_offset += std::min(n_fine_blocks_max, fci_cap);
             bvec_i = 0;
-            fci_cap = bvec_size;
+            fci_cap = nbits;
           } else {
             f_finished = true;
           }
@@ -1477,9 +1536,13 @@ namespace casadi {
     // Number of nonzero outputs
     casadi_int nz_out = nnz_out(oind);
 
+    // Number of bvec_t per nonzero and number of directions per sweep
+    casadi_int nw = sp_width(std::max(nz_in, nz_out));
+    casadi_int nbits = nw*bvec_size;
+
     // Seeds and sensitivities
-    std::vector<bvec_t> s_in(nz_in, 0);
-    std::vector<bvec_t> s_out(nz_out, 0);
+    std::vector<bvec_t> s_in(nz_in*nw, 0);
+    std::vector<bvec_t> s_out(nz_out*nw, 0);
 
     // Evaluation buffers
     std::vector<const bvec_t*> arg_fwd(sz_arg(), nullptr);
@@ -1488,7 +1551,7 @@ namespace casadi {
     std::vector<bvec_t*> res(sz_res(), nullptr);
     res[oind] = get_ptr(s_out);
     std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w());
+    std::vector<bvec_t> w(sz_w()*nw);
 
     // Sparsity triplet accumulator
     std::vector<casadi_int> jcol, jrow;
@@ -1505,7 +1568,7 @@ namespace casadi {
     std::vector<casadi_int> fine_row;
 
     // In each iteration, subdivide each coarse block in this many fine blocks
-    casadi_int subdivision = bvec_size;
+    casadi_int subdivision = nbits;
 
     Sparsity r = Sparsity::dense(1, 1);
 
@@ -1522,13 +1585,6 @@ namespace casadi {
     // Get weighting factor
     double sp_w = sp_weight();
 
-    // Lookup table for bvec_t
-    std::vector<bvec_t> bvec_lookup;
-    bvec_lookup.reserve(bvec_size);
-    for (casadi_int i=0;i<bvec_size;++i) {
-      bvec_lookup.push_back(bvec_t(1) << i);
-    }
-
     while (!hasrun || coarse_col.size()!=nz_out+1 || coarse_row.size()!=nz_in+1) {
       if (verbose_) {
         casadi_message("Block size: " + str(granularity_col) + " x " + str(granularity_row));
@@ -1576,7 +1632,7 @@ namespace casadi {
       casadi_int nz_sens = use_fwd ? nz_out : nz_in;
 
       // Clear the seeds
-      for (casadi_int i=0; i<nz_seed; ++i) seed_v[i]=0;
+      for (casadi_int i=0; i<nz_seed*nw; ++i) seed_v[i]=0;
 
       // Choose the active jacobian coloring scheme
       Sparsity D = use_fwd ? D1 : D2;
@@ -1634,7 +1690,7 @@ namespace casadi {
       for (casadi_int csd=0; csd<D.size2(); ++csd) {
 
         casadi_int fci_offset = 0;
-        casadi_int fci_cap = bvec_size-bvec_i;
+        casadi_int fci_cap = nbits-bvec_i;
 
         // Flag to indicate if all fine blocks have been handled
         bool f_finished = false;
@@ -1668,7 +1724,7 @@ namespace casadi {
 
               // Toggle on seeds
               bvec_toggle(seed_v, fine_row[fci+fci_start], fine_row[fci+fci_start+1],
-                          bvec_i+bvec_i_mod);
+                          bvec_i+bvec_i_mod, nw);
               bvec_i_mod++;
             }
           }
@@ -1677,24 +1733,24 @@ namespace casadi {
           bvec_i+= std::min(n_fine_blocks_max, fci_cap);
 
           // Check if bvec buffer is full
-          if (bvec_i==bvec_size || csd==D.size2()-1) {
-            // Calculate sparsity for bvec_size directions at once
+          if (bvec_i==nbits || csd==D.size2()-1) {
+            // Calculate sparsity for nbits directions at once
 
             // Statistics
             nsweeps+=1;
 
             // Construct lookup table
-            IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value, bvec_size,
+            IM lookup = IM::triplet(lookup_row, lookup_col, lookup_value, nbits,
                                     coarse_col.size());
 
             // Propagate the dependencies
             if (use_fwd) {
               JacSparsityTraits<true>::sp(this, get_ptr(arg_fwd), get_ptr(res),
-                get_ptr(iw), get_ptr(w), memory(0));
+                get_ptr(iw), get_ptr(w), memory(0), nw);
             } else {
               std::fill(w.begin(), w.end(), 0);
               JacSparsityTraits<false>::sp(this, get_ptr(arg_adj), get_ptr(res),
-                get_ptr(iw), get_ptr(w), memory(0));
+                get_ptr(iw), get_ptr(w), memory(0), nw);
             }
 
             // Temporary bit work vector
@@ -1706,20 +1762,24 @@ namespace casadi {
               // Loop over the cols of fine blocks within the current coarse block
               for (casadi_int fri=fine_col_lookup[coarse_col[cri]];
                    fri<fine_col_lookup[coarse_col[cri+1]];++fri) {
-                // Lump individual sensitivities together into fine block
-                bvec_or(sens_v, spsens, fine_col[fri], fine_col[fri+1]);
-
-                // Next iteration if no sparsity
-                if (!spsens) continue;
-
-                // Loop over all bvec_bits
-                for (casadi_int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
-                  if (spsens & bvec_lookup[bvec_i]) {
-                    // if dependency is found, add it to the new sparsity pattern
-                    casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
-                    if (ind==-1) continue;
-                    jrow.push_back(bvec_i+lookup->at(ind));
-                    jcol.push_back(fri);
+                // Loop over the words of the bit vectors
+                for (casadi_int j=0; j<nw; ++j) {
+                  // Lump individual sensitivities together into fine block
+                  bvec_or(sens_v, spsens, fine_col[fri], fine_col[fri+1], nw, j);
+
+                  // Next iteration if no sparsity
+                  if (!spsens) continue;
+
+                  // Loop over all bvec_bits
+                  for (casadi_int b=0; b<bvec_size; ++b) {
+                    if (spsens & (bvec_t(1) << b)) {
+                      casadi_int bvec_i = j*bvec_size + b;
+                      // if dependency is found, add it to the new sparsity pattern
+                      casadi_int ind = lookup.sparsity().get_nz(bvec_i, cri);
+                      if (ind==-1) continue;
+                      jrow.push_back(bvec_i+lookup->at(ind));
+                      jcol.push_back(fri);
+                    }
                   }
                 }
               }
@@ -1740,7 +1800,7 @@ namespace casadi {
           if (n_fine_blocks_max>fci_cap) {
             fci_offset += std::min(n_fine_blocks_max, fci_cap);
             bvec_i = 0;
-            fci_cap = bvec_size;
+            fci_cap = nbits;
           } else {
             f_finished = true;
           }
@@ -1918,9 +1978,28 @@ namespace casadi {
 
   void FunctionInternal::get_partition(casadi_int iind, casadi_int oind, Sparsity& D1, Sparsity& D2,
                                        bool compact, bool symmetric,
-                                       bool allow_forward, bool allow_reverse) const {
+                                       bool allow_forward, bool allow_reverse,
+                                       const std::string& ordering, casadi_int n_thread) const {
     if (verbose_) casadi_message(name_ + "::get_partition");
     casadi_assert(allow_forward || allow_reverse, "Inconsistent options");
+    casadi_assert(n_thread>=1, "Number of coloring threads must be positive");
+
+    // Vertex ordering for the graph coloring
+    casadi_int ord;
+    if (ordering.empty()) {
+      ord = symmetric ? 1 : 0;
+    } else if (ordering=="natural") {
+      ord = 0;
+    } else if (ordering=="largest_first") {
+      ord = 1;
+    } else if (ordering=="smallest_last") {
+      ord = 2;
+    } else if (ordering=="incidence_degree") {
+      ord = 3;
+    } else {
+      casadi_error("Unknown coloring ordering '" + ordering + "', expected 'natural', "
+        "'largest_first', 'smallest_last' or 'incidence_degree'");
+    }
 
     // Sparsity pattern with transpose
     Sparsity &AT = jac_sparsity(oind, iind, compact, symmetric);
@@ -1931,15 +2010,27 @@ namespace casadi {
       casadi_assert_dev(enable_forward_ || enable_fd_);
       casadi_assert_dev(allow_forward);
 
-      // Star coloring if symmetric
+      // Star coloring if symmetric. A distance-2 coloring, which is also a star
+      // coloring, could be computed in parallel but needs considerably more colors,
+      // so coloring_threads is ignored here.
       if (verbose_) casadi_message("FunctionInternal::getPartition star_coloring");
-      D1 = A.star_coloring();
+      D1 = A.star_coloring(ord);
       if (verbose_) {
         casadi_message("Star coloring completed: " + str(D1.size2())
           + " directional derivatives needed ("
                  + str(A.size1()) + " without coloring).");
       }
 
+      // An acyclic coloring may need fewer directions, entries are then recovered by substitution
+      Sparsity D_acyclic = A.acyclic_coloring(ord, D1.size2()-1);
+      if (!D_acyclic.is_null()) {
+        D1 = D_acyclic;
+        if (verbose_) {
+          casadi_message("Acyclic coloring completed: " + str(D1.size2())
+            + " directional derivatives needed.");
+        }
+      }
+
     } else {
       casadi_assert_dev(enable_forward_ || enable_fd_ || enable_reverse_);
       // Get weighting factor
@@ -1973,7 +2064,7 @@ namespace casadi {
           bool d = best_coloring>=w*static_cast<double>(A.size1());
           casadi_int max_colorings_to_test =
             d ? A.size1() : static_cast<casadi_int>(floor(best_coloring/w));
-          D1 = AT.uni_coloring(A, max_colorings_to_test);
+          D1 = AT.uni_coloring(A, max_colorings_to_test, ord, n_thread);
           if (D1.is_null()) {
             if (verbose_) {
               casadi_message("Forward mode coloring interrupted (more than "
@@ -1994,7 +2085,7 @@ namespace casadi {
           casadi_int max_colorings_to_test =
             d ? A.size2() : static_cast<casadi_int>(floor(best_coloring/(1-w)));
 
-          D2 = A.uni_coloring(AT, max_colorings_to_test);
+          D2 = A.uni_coloring(AT, max_colorings_to_test, ord, n_thread);
           if (D2.is_null()) {
             if (verbose_) {
               casadi_message("Adjoint mode coloring interrupted (more than "
@@ -2340,19 +2431,57 @@ namespace casadi {
     if (needs_mem) {
     std::string name = codegen_name(g, false);
     std::string mem_counter = g.shorthand(name + "_mem_counter");
-    g << "return " + mem_counter + "++;\n";
+    if (g.thread_safe) {
+      g << "return CASADI_ATOMIC_FETCH_ADD(&" + mem_counter + ", 1);\n";
+    } else {
+      g << "return " + mem_counter + "++;\n";
+    }
     }
   }
 
   void FunctionInternal::codegen_checkout(CodeGenerator& g) const {
     std::string name = codegen_name(g, false);
-    std::string stack_counter = g.shorthand(name + "_unused_stack_counter");
-    std::string stack = g.shorthand(name + "_unused_stack");
     std::string mem_counter = g.shorthand(name + "_mem_counter");
     std::string mem_array = g.shorthand(name + "_mem");
     std::string alloc_mem = g.shorthand(name + "_alloc_mem");
     std::string init_mem = g.shorthand(name + "_init_mem");
 
+    if (g.thread_safe) {
+      // Lock-free: the state of each memory object is claimed with compare-and-swap
+      std::string mem_state = g.shorthand(name + "_mem_state");
+      std::string last_mem = g.thread_local_mem ? g.shorthand(name + "_last_mem") : "";
+      g.add_auxiliary(CodeGenerator::AUX_ATOMIC);
+      g.auxiliaries << "static CASADI_ATOMIC_INT " << mem_counter  << ";\n";
+      g.auxiliaries << "/* 0: not allocated, 1: checked out, 2: unused */\n";
+      g.auxiliaries << "static CASADI_ATOMIC_INT " << mem_state << "[CASADI_MAX_NUM_THREADS];\n";
+      if (g.thread_local_mem) {
+        g.auxiliaries << "static CASADI_THREAD_LOCAL int " << last_mem << " = -1;\n";
+      }
+      g.auxiliaries << "static " << codegen_mem_type() <<
+                 " " << mem_array << "[CASADI_MAX_NUM_THREADS];\n\n";
+      g << "int mid, n, unused;\n";
+      if (g.thread_local_mem) {
+        g << "/* Memory object released last by this thread */\n";
+        g << "unused = 2;\n";
+        g << "if (" << last_mem << ">=0 && CASADI_ATOMIC_CAS(&" << mem_state << "["
+          << last_mem << "], &unused, 1)) return " << last_mem << ";\n";
+      }
+      g << "n = CASADI_ATOMIC_LOAD(&" << mem_counter << ");\n";
+      g << "if (n>CASADI_MAX_NUM_THREADS) n = CASADI_MAX_NUM_THREADS;\n";
+      g << "for (mid=0; mid<n; ++mid) {\n";
+      g << "unused = 2;\n";
+      g << "if (CASADI_ATOMIC_CAS(&" << mem_state << "[mid], &unused, 1)) return mid;\n";
+      g << "}\n";
+      g << "mid = " << alloc_mem << "();\n";
+      g << "if (mid<0 || mid>=CASADI_MAX_NUM_THREADS) return -1;\n";
+      g << "if (" << init_mem << "(mid)) return -1;\n";
+      g << "CASADI_ATOMIC_STORE(&" << mem_state << "[mid], 1);\n";
+      g << "return mid;\n";
+      return;
+    }
+
+    std::string stack_counter = g.shorthand(name + "_unused_stack_counter");
+    std::string stack = g.shorthand(name + "_unused_stack");
     g.auxiliaries << "static int " << mem_counter  << " = 0;\n";
     g.auxiliaries << "static int " << stack_counter  << " = -1;\n";
     g.auxiliaries << "static int " << stack << "[CASADI_MAX_NUM_THREADS];\n";
@@ -2372,6 +2501,11 @@ namespace casadi {
 
   void FunctionInternal::codegen_release(CodeGenerator& g) const {
     std::string name = codegen_name(g, false);
+    if (g.thread_safe) {
+      g << "CASADI_ATOMIC_STORE(&" << g.shorthand(name + "_mem_state") << "[mem], 2);\n";
+      if (g.thread_local_mem) g << g.shorthand(name + "_last_mem") << " = mem;\n";
+      return;
+    }
     std::string stack_counter = g.shorthand(name + "_unused_stack_counter");
     std::string stack = g.shorthand(name + "_unused_stack");
     g << stack << "[++" << stack_counter << "] = mem;\n";
@@ -2806,6 +2940,89 @@ namespace casadi {
     return 0;
   }
 
+  int FunctionInternal::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Narrow copies of the inputs and outputs
+    std::vector<bvec_t> buf(nnz_in() + nnz_out());
+    std::vector<const bvec_t*> arg1(sz_arg(), nullptr);
+    std::vector<bvec_t*> res1(sz_res(), nullptr);
+    // Propagate one word at a time
+    for (casadi_int j=0; j<nw; ++j) {
+      bvec_t* b = get_ptr(buf);
+      for (casadi_int i=0; i<n_in_; ++i) {
+        casadi_int n = nnz_in(i);
+        if (arg[i]) {
+          for (casadi_int k=0; k<n; ++k) b[k] = arg[i][k*nw+j];
+          arg1[i] = b;
+        }
+        b += n;
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (res[i]) res1[i] = b;
+        b += nnz_out(i);
+      }
+      if (sp_forward(get_ptr(arg1), get_ptr(res1), iw, w, mem)) return 1;
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (res[i]) {
+          casadi_int n = nnz_out(i);
+          for (casadi_int k=0; k<n; ++k) res[i][k*nw+j] = res1[i][k];
+        }
+      }
+    }
+    return 0;
+  }
+
+  int FunctionInternal::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Narrow copies of the inputs and outputs
+    std::vector<bvec_t> buf(nnz_in() + nnz_out());
+    std::vector<bvec_t*> arg1(sz_arg(), nullptr);
+    std::vector<bvec_t*> res1(sz_res(), nullptr);
+    // Propagate one word at a time
+    for (casadi_int j=0; j<nw; ++j) {
+      bvec_t* b = get_ptr(buf);
+      for (casadi_int i=0; i<n_in_; ++i) {
+        casadi_int n = nnz_in(i);
+        if (arg[i]) {
+          for (casadi_int k=0; k<n; ++k) b[k] = arg[i][k*nw+j];
+          arg1[i] = b;
+        }
+        b += n;
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        casadi_int n = nnz_out(i);
+        if (res[i]) {
+          for (casadi_int k=0; k<n; ++k) b[k] = res[i][k*nw+j];
+          res1[i] = b;
+        }
+        b += n;
+      }
+      if (sp_reverse(get_ptr(arg1), get_ptr(res1), iw, w, mem)) return 1;
+      for (casadi_int i=0; i<n_in_; ++i) {
+        if (arg[i]) {
+          casadi_int n = nnz_in(i);
+          for (casadi_int k=0; k<n; ++k) arg[i][k*nw+j] = arg1[i][k];
+        }
+      }
+      for (casadi_int i=0; i<n_out_; ++i) {
+        if (res[i]) {
+          casadi_int n = nnz_out(i);
+          for (casadi_int k=0; k<n; ++k) res[i][k*nw+j] = res1[i][k];
+        }
+      }
+    }
+    return 0;
+  }
+
+  casadi_int FunctionInternal::sp_width(casadi_int ndir) const {
+    if (!has_sp_wide()) return 1;
+    // Smallest power of two that covers all directions, within the global limit
+    casadi_int nw_max = GlobalOptions::sparsity_block_width/bvec_size;
+    casadi_int nw = 1;
+    while (nw<nw_max && nw*bvec_size<ndir) nw *= 2;
+    return nw;
+  }
+
   void FunctionInternal::sz_work(size_t& sz_arg, size_t& sz_res,
                                  size_t& sz_iw, size_t& sz_w) const {
     sz_arg = this->sz_arg();
@@ -3430,10 +3647,11 @@ namespace casadi {
   }
 
   void ProtoFunction::clear_mem() {
-    for (auto&& i : mem_) {
-      if (i!=nullptr) free_mem(i);
+    for (int i=0; i<n_mem_; ++i) {
+      void* m = mem_slot(i).mem.exchange(nullptr);
+      if (m!=nullptr) free_mem(m);
     }
-    mem_.clear();
+    reset_mem();
   }
 
   size_t FunctionInternal::get_n_in() {
@@ -3530,38 +3748,154 @@ namespace casadi {
     return Sparsity::scalar();
   }
 
-  void* ProtoFunction::memory(int ind) const {
 #ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    return mem_.at(ind);
+  /** \brief Memory objects most recently released by the current thread
+
+      A thread that calls the same function repeatedly takes its memory object from
+      here without touching the shared free list. Entries are direct mapped by the
+      identifier of the function. When the thread exits, the entries are returned to
+      the free lists of the functions that still exist.
+  */
+  struct ThreadMemoryCache {
+    struct Entry {
+      uint64_t id;
+      int mem;
+      const ProtoFunction* f;
+    };
+    static const int size = 16;
+    Entry entry[size];
+
+    ThreadMemoryCache() {
+      for (auto&& e : entry) {
+        e.id = 0;
+        e.mem = -1;
+        e.f = nullptr;
+      }
+    }
+
+    ~ThreadMemoryCache() {
+      std::lock_guard<std::mutex> lock(mtx());
+      for (auto&& e : entry) {
+        if (e.mem>=0 && live().count(e.id)) e.f->push_unused(e.mem);
+      }
+    }
+
+    Entry& get(uint64_t id) { return entry[id % size];}
+
+    // Identifiers of the functions with memory objects, never destroyed
+    static std::mutex& mtx() {
+      static std::mutex* m = new std::mutex();
+      return *m;
+    }
+    static std::set<uint64_t>& live() {
+      static std::set<uint64_t>* l = new std::set<uint64_t>();
+      return *l;
+    }
+  };
+
+  thread_local ThreadMemoryCache thread_memory_cache;
+#endif // CASADI_WITH_THREAD
+
+  ProtoFunction::MemSlot& ProtoFunction::mem_slot(int ind) const {
+    // Block b holds the objects 2^b-1, ..., 2^(b+1)-2
+    casadi_int b = 0;
+    while ((static_cast<casadi_int>(ind) + 1) >> (b + 1)) b++;
+    MemSlot* blk = mem_block_[b].load(std::memory_order_acquire);
+    if (blk==nullptr) {
+      MemSlot* new_blk = new MemSlot[casadi_int(1) << b]();
+      if (mem_block_[b].compare_exchange_strong(blk, new_blk, std::memory_order_acq_rel)) {
+        blk = new_blk;
+      } else {
+        // Allocated by another thread
+        delete[] new_blk;
+      }
+    }
+    return blk[ind + 1 - (casadi_int(1) << b)];
+  }
+
+  void ProtoFunction::reset_mem() {
+#ifdef CASADI_WITH_THREAD
+    if (n_mem_>0) {
+      std::lock_guard<std::mutex> lock(ThreadMemoryCache::mtx());
+      ThreadMemoryCache::live().erase(mem_id_);
+    }
+#endif // CASADI_WITH_THREAD
+    for (auto&& b : mem_block_) delete[] b.exchange(nullptr);
+    n_mem_ = 0;
+    unused_head_ = 0;
+    // Invalidates the entries in the per-thread caches
+    static std::atomic<uint64_t> mem_id_counter(0);
+    mem_id_ = ++mem_id_counter;
+  }
+
+  void ProtoFunction::push_unused(int mem) const {
+    MemSlot& s = mem_slot(mem);
+    uint64_t head = unused_head_.load(std::memory_order_relaxed), new_head;
+    do {
+      s.next.store(static_cast<int>(head & 0xffffffff) - 1, std::memory_order_relaxed);
+      new_head = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(mem + 1);
+    } while (!unused_head_.compare_exchange_weak(head, new_head,
+      std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  void* ProtoFunction::memory(int ind) const {
+    casadi_assert(ind>=0 && ind<n_mem_, "Memory object " + str(ind) + " does not exist");
+    return mem_slot(ind).mem.load(std::memory_order_acquire);
   }
 
   int ProtoFunction::checkout() const {
 #ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    if (unused_.empty()) {
-      // Allocate a new memory object
-      void* m = alloc_mem();
-      mem_.push_back(m);
-      if (init_mem(m)) {
-        casadi_error("Failed to create or initialize memory object");
-      }
-      return static_cast<int>(mem_.size()) - 1;
-    } else {
-      // Use an unused memory object
-      int m = unused_.top();
-      unused_.pop();
+    // Memory object released by this thread
+    ThreadMemoryCache::Entry& e = thread_memory_cache.get(mem_id_);
+    if (e.id==mem_id_ && e.mem>=0) {
+      int m = e.mem;
+      e.mem = -1;
       return m;
     }
+#endif // CASADI_WITH_THREAD
+    // Use an unused memory object
+    uint64_t head = unused_head_.load(std::memory_order_acquire), new_head;
+    while (head & 0xffffffff) {
+      int m = static_cast<int>(head & 0xffffffff) - 1;
+      // A stale link is detected by the update counter
+      int next = mem_slot(m).next.load(std::memory_order_relaxed);
+      new_head = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(next + 1);
+      if (unused_head_.compare_exchange_weak(head, new_head,
+          std::memory_order_acquire, std::memory_order_acquire)) {
+        return m;
+      }
+    }
+    // Allocate a new memory object
+    int m = n_mem_.fetch_add(1);
+    casadi_assert(m<std::numeric_limits<int>::max(), "Too many memory objects");
+#ifdef CASADI_WITH_THREAD
+    if (m==0) {
+      std::lock_guard<std::mutex> lock(ThreadMemoryCache::mtx());
+      ThreadMemoryCache::live().insert(mem_id_);
+    }
+#endif // CASADI_WITH_THREAD
+    void* mem = alloc_mem();
+    mem_slot(m).mem.store(mem, std::memory_order_release);
+    if (init_mem(mem)) {
+      casadi_error("Failed to create or initialize memory object");
+    }
+    return m;
   }
 
   void ProtoFunction::release(int mem) const {
 #ifdef CASADI_WITH_THREAD
-    std::lock_guard<std::mutex> lock(mtx_);
-#endif //CASADI_WITH_THREAD
-    unused_.push(mem);
+    // Keep in the cache of this thread, unless taken by another function
+    ThreadMemoryCache::Entry& e = thread_memory_cache.get(mem_id_);
+    if (e.id==mem_id_ || e.mem<0) {
+      // The most recently released memory object is used first, as before
+      if (e.id==mem_id_ && e.mem>=0) push_unused(e.mem);
+      e.id = mem_id_;
+      e.mem = mem;
+      e.f = this;
+      return;
+    }
+#endif // CASADI_WITH_THREAD
+    push_unused(mem);
   }
 
   Function FunctionInternal::
@@ -3836,6 +4170,9 @@ namespace casadi {
   }
 
   ProtoFunction::ProtoFunction(DeserializingStream& s) {
+    for (auto&& b : mem_block_) b = nullptr;
+    n_mem_ = 0;
+    reset_mem();
     int version = s.version("ProtoFunction", 1, 2);
     s.unpack("ProtoFunction::name", name_);
     s.unpack("ProtoFunction::verbose", verbose_);
@@ -27,6 +27,7 @@
 #define CASADI_FUNCTION_INTERNAL_HPP
 
 #include "function.hpp"
+#include <atomic>
 #include <set>
 #include <stack>
 #include "code_generator.hpp"
@@ -260,11 +261,41 @@ namespace casadi {
 #endif // CASADI_WITH_THREAD
 
   private:
-    /// Memory objects
-    mutable std::vector<void*> mem_;
+    /// Memory object and the next unused memory object in the free list
+    struct MemSlot {
+      std::atomic<void*> mem;
+      std::atomic<int> next;
+    };
+
+    /// Maximum number of blocks of memory objects
+    static const int max_mem_block = 31;
+
+    /// Slot of a memory object, the block holding it is allocated if needed
+    MemSlot& mem_slot(int ind) const;
+
+    /// Remove all memory objects and free the blocks holding them
+    void reset_mem();
+
+    /// Add an unused memory object to the free list
+    void push_unused(int mem) const;
+
+    /// Memory objects, in blocks that never move: block b holds 2^b objects
+    mutable std::atomic<MemSlot*> mem_block_[max_mem_block];
+
+    /// Number of memory objects
+    mutable std::atomic<int> n_mem_;
+
+    /** \brief Head of the free list of unused memory objects
+
+        Index of the first unused memory object plus one (zero if empty) in the lower
+        32 bits, counter of updates in the upper bits to guard against ABA
+    */
+    mutable std::atomic<uint64_t> unused_head_;
+
+    /// Identifies the memory objects of this instance in the per-thread caches
+    uint64_t mem_id_;
 
-    /// Unused memory objects
-    mutable std::stack<int> unused_;
+    friend struct ThreadMemoryCache;
   };
 
   /** \brief Internal class for Function
@@ -925,7 +956,8 @@ namespace casadi {
         \identifier{md} */
     void get_partition(casadi_int iind, casadi_int oind, Sparsity& D1, Sparsity& D2,
                       bool compact, bool symmetric,
-                      bool allow_forward, bool allow_reverse) const;
+                      bool allow_forward, bool allow_reverse,
+                      const std::string& ordering="", casadi_int n_thread=1) const;
 
     ///@{
     /** \brief Number of input/output nonzeros
@@ -1122,6 +1154,27 @@ namespace casadi {
         \identifier{my} */
     virtual int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const;
 
+    /** \brief Is sparsity propagation with several bvec_t per nonzero supported natively?
+
+        If so, sp_forward_wide and sp_reverse_wide process all words in a single sweep.
+        Otherwise they fall back to one call to sp_forward or sp_reverse per word. */
+    virtual bool has_sp_wide() const { return false;}
+
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero
+
+        The work vector must hold nw*sz_w() elements. */
+    virtual int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero
+
+        The work vector must hold nw*sz_w() elements. */
+    virtual int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
+    /** \brief Number of bvec_t per nonzero for propagating ndir seed directions */
+    casadi_int sp_width(casadi_int ndir) const;
+
     /** \brief Get number of temporary variables needed
 
         \identifier{mz} */
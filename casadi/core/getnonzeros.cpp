@@ -201,6 +201,85 @@ namespace casadi {
     return 0;
   }
 
+  int GetNonzerosVector::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    const bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (auto&& k : nz_) {
+      if (k>=0) {
+        std::copy_n(a + k*nw, nw, r);
+      } else {
+        std::fill_n(r, nw, 0);
+      }
+      r += nw;
+    }
+    return 0;
+  }
+
+  int GetNonzerosVector::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (auto&& k : nz_) {
+      if (k>=0) {
+        for (casadi_int j=0; j<nw; ++j) a[k*nw+j] |= r[j];
+      }
+      std::fill_n(r, nw, 0);
+      r += nw;
+    }
+    return 0;
+  }
+
+  int GetNonzerosSlice::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    const bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (casadi_int k=s_.start; k!=s_.stop; k+=s_.step) {
+      std::copy_n(a + k*nw, nw, r);
+      r += nw;
+    }
+    return 0;
+  }
+
+  int GetNonzerosSlice::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (casadi_int k=s_.start; k!=s_.stop; k+=s_.step) {
+      for (casadi_int j=0; j<nw; ++j) a[k*nw+j] |= r[j];
+      std::fill_n(r, nw, 0);
+      r += nw;
+    }
+    return 0;
+  }
+
+  int GetNonzerosSlice2::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    const bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (casadi_int k1=outer_.start; k1!=outer_.stop; k1+=outer_.step) {
+      for (casadi_int k2=k1+inner_.start; k2!=k1+inner_.stop; k2+=inner_.step) {
+        std::copy_n(a + k2*nw, nw, r);
+        r += nw;
+      }
+    }
+    return 0;
+  }
+
+  int GetNonzerosSlice2::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    bvec_t *a = arg[0];
+    bvec_t *r = res[0];
+    for (casadi_int k1=outer_.start; k1!=outer_.stop; k1+=outer_.step) {
+      for (casadi_int k2=k1+inner_.start; k2!=k1+inner_.stop; k2+=inner_.step) {
+        for (casadi_int j=0; j<nw; ++j) a[k2*nw+j] |= r[j];
+        std::fill_n(r, nw, 0);
+        r += nw;
+      }
+    }
+    return 0;
+  }
+
   std::string GetNonzerosVector::disp(const std::vector<std::string>& arg) const {
     std::stringstream ss;
     ss << arg.at(0) << nz_;
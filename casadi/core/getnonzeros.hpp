@@ -120,6 +120,14 @@ namespace casadi {
         \identifier{ib} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
     /** \brief  Evaluate symbolically (MX)
 
         \identifier{ic} */
@@ -196,6 +204,14 @@ namespace casadi {
         \identifier{ik} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
     /// Evaluate the function (template)
     template<typename T>
     int eval_gen(const T* const* arg, T* const* res, casadi_int* iw, T* w) const;
@@ -268,6 +284,14 @@ namespace casadi {
         \identifier{is} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const override;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const override;
+
     /// Evaluate the function (template)
     template<typename T>
     int eval_gen(const T* const* arg, T* const* res, casadi_int* iw, T* w) const;
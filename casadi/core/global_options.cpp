@@ -36,10 +36,23 @@ namespace casadi {
 
   casadi_int GlobalOptions::max_num_dir = 64;
 
+  casadi_int GlobalOptions::thread_pool_size = 0;
+  bool GlobalOptions::thread_pool_pinning = false;
+
+  casadi_int GlobalOptions::sparsity_block_width = 512;
+
+  bool GlobalOptions::sx_node_pool = false;
+
   // By default, use zero-based indexing
   casadi_int GlobalOptions::start_index = 0;
 
 
   bool GlobalOptions::julia_initialized = false;
 
+  void GlobalOptions::setSparsityBlockWidth(casadi_int width) {
+    casadi_assert(width>=bvec_size && (width & (width-1))==0,
+      "Sparsity block width must be a power of two, at least " + str(bvec_size));
+    sparsity_block_width = width;
+  }
+
 } // namespace casadi
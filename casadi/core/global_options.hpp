@@ -72,6 +72,33 @@ namespace casadi {
 
       static bool julia_initialized;
 
+      /** \brief Number of worker threads in the shared thread pool
+
+      * Zero means one worker per hardware thread.
+      * Default: 0
+      */
+      static casadi_int thread_pool_size;
+
+      /** \brief Pin the workers of the shared thread pool to cores
+
+      * Default: false
+      */
+      static bool thread_pool_pinning;
+
+      /** \brief Largest number of seed directions propagated per sparsity sweep
+
+      * Power of two, at least the number of bits in bvec_t. Functions that support
+      * wide sparsity propagation use blocks of up to this many bits per nonzero.
+      * Default: 512
+      */
+      static casadi_int sparsity_block_width;
+
+      /** \brief Allocate SX nodes from a pool of fixed-size blocks
+
+      * Default: false
+      */
+      static bool sx_node_pool;
+
 #endif //SWIG
       // Setter and getter for simplification_on_the_fly
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
@@ -90,6 +117,18 @@ namespace casadi {
       static void setMaxNumDir(casadi_int ndir) { max_num_dir=ndir; }
       static casadi_int getMaxNumDir() { return max_num_dir; }
 
+      static void setThreadPoolSize(casadi_int n) { thread_pool_size=n; }
+      static casadi_int getThreadPoolSize() { return thread_pool_size; }
+
+      static void setThreadPoolPinning(bool flag) { thread_pool_pinning=flag; }
+      static bool getThreadPoolPinning() { return thread_pool_pinning; }
+
+      static void setSparsityBlockWidth(casadi_int width);
+      static casadi_int getSparsityBlockWidth() { return sparsity_block_width; }
+
+      static void setSXNodePool(bool flag) { sx_node_pool=flag; }
+      static bool getSXNodePool() { return sx_node_pool; }
+
   };
 
 } // namespace casadi
@@ -48,7 +48,16 @@ namespace casadi {
 
   // Instantiate templates
   template class casadi_limits<casadi_int>;
+  // The member specializations above instantiate the class implicitly, so GCC ignores
+  // the export attribute here, other compilers (dllexport) still need it
+#if __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#endif
   template class CASADI_EXPORT Matrix<casadi_int>;
+#if __GNUC__
+#pragma GCC diagnostic pop
+#endif
 
 
 } // namespace casadi
@@ -25,14 +25,8 @@
 
 #include "map.hpp"
 #include "serializing_stream.hpp"
-
-#ifdef CASADI_WITH_THREAD
-#ifdef CASADI_WITH_THREAD_MINGW
-#include <mingw.thread.h>
-#else // CASADI_WITH_THREAD_MINGW
-#include <thread>
-#endif // CASADI_WITH_THREAD_MINGW
-#endif // CASADI_WITH_THREAD
+#include "sx_function.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -129,6 +123,16 @@ namespace casadi {
     alloc_res(f_.sz_res());
     alloc_w(f_.sz_w());
     alloc_iw(f_.sz_iw());
+
+    // Allocate memory for batched evaluation of SXFunction
+    if (batch_size()>1) alloc_w(f_.sz_w() * batch_size());
+  }
+
+  const casadi_int Map::batch_width;
+
+  casadi_int Map::batch_size() const {
+    if (parallelization()!="serial" || !f_.is_a("SXFunction")) return 1;
+    return std::min(n_, batch_width);
   }
 
   template<typename T>
@@ -315,6 +319,28 @@ namespace casadi {
   }
 
   int Map::eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    // Evaluate SXFunction several instances at a time, if enough work memory
+    casadi_int nb = batch_size();
+    if (nb>1 && sz_w()>=f_.sz_w()*nb) {
+      const SXFunction* f = f_.get<SXFunction>();
+      if (f->has_eval_batch()) {
+        const double** arg1 = arg+n_in_;
+        std::copy_n(arg, n_in_, arg1);
+        double** res1 = res+n_out_;
+        std::copy_n(res, n_out_, res1);
+        for (casadi_int i=0; i<n_; i+=nb) {
+          casadi_int nb1 = std::min(nb, n_-i);
+          if (f->eval_batch(arg1, res1, iw, w, nb1)) return 1;
+          for (casadi_int j=0; j<n_in_; ++j) {
+            if (arg1[j]) arg1[j] += nb1*f_.nnz_in(j);
+          }
+          for (casadi_int j=0; j<n_out_; ++j) {
+            if (res1[j]) res1[j] += nb1*f_.nnz_out(j);
+          }
+        }
+        return 0;
+      }
+    }
     // This checkout/release dance is an optimization.
     // Could also use the thread-safe variant f_(arg1, res1, iw, w)
     // in Map::eval_gen
@@ -421,7 +447,7 @@ namespace casadi {
     clear_mem();
   }
 
-  void ThreadsWork(const Function& f, casadi_int i,
+  void ThreadsWork(const Function& f, casadi_int i, casadi_int k,
       const double** arg, double** res,
       casadi_int* iw, double* w,
       casadi_int ind, int& ret) {
@@ -435,19 +461,19 @@ namespace casadi {
     f.sz_work(sz_arg, sz_res, sz_iw, sz_w);
 
     // Input buffers
-    const double** arg1 = arg + n_in + i*sz_arg;
+    const double** arg1 = arg + n_in + k*sz_arg;
     for (casadi_int j=0; j<n_in; ++j) {
       arg1[j] = arg[j] ? arg[j] + i*f.nnz_in(j) : nullptr;
     }
 
     // Output buffers
-    double** res1 = res + n_out + i*sz_res;
+    double** res1 = res + n_out + k*sz_res;
     for (casadi_int j=0; j<n_out; ++j) {
       res1[j] = res[j] ? res[j] + i*f.nnz_out(j) : nullptr;
     }
 
     try {
-      ret = f(arg1, res1, iw + i*sz_iw, w + i*sz_w, ind);
+      ret = f(arg1, res1, iw + k*sz_iw, w + k*sz_w, ind);
     } catch (std::exception& e) {
       ret = 1;
       casadi_warning("Exception raised: " + std::string(e.what()));
@@ -463,37 +489,26 @@ namespace casadi {
 #ifndef CASADI_WITH_THREAD
     return Map::eval(arg, res, iw, w, mem);
 #else // CASADI_WITH_THREAD
-    // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    // Checkout memory objects, one per work slice
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_slice_);
+    for (casadi_int k=0; k<n_slice_; ++k) ind.emplace_back(f_);
 
     // Allocate space for return values
     std::vector<int> ret_values(n_);
 
-    // Spawn threads
-    std::vector<std::thread> threads;
-    for (casadi_int i=0; i<n_; ++i) {
-      // Why the lambda function?
-      // Because it was the first iteration to pass tests on MingGW
-      // using mingw-std-threads.
-      threads.emplace_back(
-        [i](const Function& f, const double** arg, double** res,
-            casadi_int* iw, double* w, casadi_int ind, int& ret) {
-              ThreadsWork(f, i, arg, res, iw, w, ind, ret);
-            },
-        std::ref(f_), arg, res, iw, w, casadi_int(ind[i]), std::ref(ret_values[i]));
-    }
-
-    // Join threads
-    for (auto && th : threads) th.join();
-
-    // Anticipate success
-    int ret = 0;
+    // Next evaluation to be picked up by a work slice
+    std::atomic<casadi_int> next(0);
 
-    // Compute aggregate return value
-    for (int e : ret_values) ret = ret || e;
-
-    return ret;
+    // Each work slice keeps evaluating until all n_ evaluations have been claimed
+    return ThreadPool::instance()->run(n_slice_,
+      [&](casadi_int k) {
+        int ret = 0;
+        for (casadi_int i=next++; i<n_; i=next++) {
+          ThreadsWork(f_, i, k, arg, res, iw, w, ind[k], ret_values[i]);
+          ret = ret || ret_values[i];
+        }
+        return ret;
+      });
 #endif // CASADI_WITH_THREAD
   }
 
@@ -509,14 +524,31 @@ namespace casadi {
     // Call the initialization method of the base class
     Map::init(opts);
 
+    // Number of evaluations that can run concurrently
+    n_slice_ = std::min(n_, ThreadPool::default_size());
+
     // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
+    alloc_iw(n_slice_, true);
 
     // Allocate sufficient memory for parallel evaluation
-    alloc_arg(f_.sz_arg() * n_);
-    alloc_res(f_.sz_res() * n_);
-    alloc_w(f_.sz_w() * n_);
-    alloc_iw(f_.sz_iw() * n_);
+    alloc_arg(f_.sz_arg() * n_slice_);
+    alloc_res(f_.sz_res() * n_slice_);
+    alloc_w(f_.sz_w() * n_slice_);
+    alloc_iw(f_.sz_iw() * n_slice_);
+  }
+
+  Dict ThreadMap::info() const {
+    Dict ret = Map::info();
+    ret["n_slice"] = n_slice_;
+    return ret;
+  }
+
+  ThreadMap::ThreadMap(DeserializingStream& s) : Map(s) {
+    // Each work slice has a memory object reference and integer work of its own, see init.
+    // The number of slices needs no field of its own then, and older streams, which
+    // allocated all n evaluations, still load.
+    n_slice_ = sz_iw() / (1 + f_.sz_iw());
+    casadi_assert(n_slice_<=n_, "Corrupt ThreadMap serialization");
   }
 
 } // namespace casadi
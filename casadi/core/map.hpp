@@ -212,6 +212,12 @@ namespace casadi {
 
     // Number of times to evaluate this function
     casadi_int n_;
+
+    // Number of SXFunction evaluations that are batched together
+    casadi_int batch_size() const;
+
+    // Maximum number of SXFunction evaluations batched together
+    static const casadi_int batch_width = 16;
   };
 
   /** A map Evaluate in parallel using OpenMP
@@ -265,9 +271,9 @@ namespace casadi {
     explicit OmpMap(DeserializingStream& s) : Map(s) {}
   };
 
-  /** A map Evaluate in parallel using std::thread
-      Note: Do not use this class with much more than the intended number of
-      threads for the parallel evaluation as it will cause excessive memory use.
+  /** A map Evaluate in parallel using the shared ThreadPool
+      Work memory is allocated for at most as many concurrent evaluations as
+      there are workers in the pool, so n may exceed the number of threads.
 
       \author Joris Gillis
       \date 2018
@@ -276,7 +282,8 @@ namespace casadi {
     friend class Map;
   public:
     // Constructor (protected, use create function in Map)
-    ThreadMap(const std::string& name, const Function& f, casadi_int n) : Map(name, f, n) {}
+    ThreadMap(const std::string& name, const Function& f, casadi_int n)
+      : Map(name, f, n), n_slice_(n) {}
 
     /** \brief  Destructor
 
@@ -309,11 +316,17 @@ namespace casadi {
         \identifier{hy} */
     void codegen_body(CodeGenerator& g) const override;
 
+    /** Obtain information about node */
+    Dict info() const override;
+
   protected:
     /** \brief Deserializing constructor
 
         \identifier{hz} */
-    explicit ThreadMap(DeserializingStream& s) : Map(s) {}
+    explicit ThreadMap(DeserializingStream& s);
+
+    // Number of evaluations that can run concurrently, each with its own work memory
+    casadi_int n_slice_;
   };
 
 } // namespace casadi
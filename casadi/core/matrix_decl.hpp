@@ -467,6 +467,9 @@ namespace casadi {
     static void qr_sparse(const Matrix<Scalar>& A, Matrix<Scalar>& V, Matrix<Scalar>& R,
                           Matrix<Scalar>& beta, std::vector<casadi_int>& prinv,
                           std::vector<casadi_int>& pc, bool amd=true);
+    static void qr_sparse(const Matrix<Scalar>& A, Matrix<Scalar>& V, Matrix<Scalar>& R,
+                          Matrix<Scalar>& beta, std::vector<casadi_int>& prinv,
+                          std::vector<casadi_int>& pc, const std::string& ordering);
     static Matrix<Scalar> qr_solve(const Matrix<Scalar>& b, const Matrix<Scalar>& v,
                                    const Matrix<Scalar>& r, const Matrix<Scalar>& beta,
                                    const std::vector<casadi_int>& prinv,
@@ -474,6 +477,8 @@ namespace casadi {
     static void qr(const Matrix<Scalar>& A, Matrix<Scalar>& Q, Matrix<Scalar>& R);
     static void ldl(const Matrix<Scalar>& A, Matrix<Scalar>& D, Matrix<Scalar>& LT,
                     std::vector<casadi_int>& p, bool amd=true);
+    static void ldl(const Matrix<Scalar>& A, Matrix<Scalar>& D, Matrix<Scalar>& LT,
+                    std::vector<casadi_int>& p, const std::string& ordering);
     static Matrix<Scalar> ldl_solve(const Matrix<Scalar>& b, const Matrix<Scalar>& D,
                                     const Matrix<Scalar>& LT, const std::vector<casadi_int>& p);
     static Matrix<Scalar> all(const Matrix<Scalar>& x);
@@ -542,6 +547,21 @@ namespace casadi {
       return Matrix<Scalar>::qr_sparse(A, V, R, beta, prinv, pc, amd);
     }
 
+    /** \brief Sparse direct QR factorization with a given column preordering
+
+     * Ordering options: "none", "amd" and "nested_dissection", see Sparsity::qr_sparse
+     */
+    friend inline void qr_sparse(const Matrix<Scalar>& A, Matrix<Scalar>& V, Matrix<Scalar>& R,
+                                 Matrix<Scalar>& beta, std::vector<casadi_int>& prinv,
+                                 std::vector<casadi_int>& pc, const std::string& ordering) {
+      return Matrix<Scalar>::qr_sparse(A, V, R, beta, prinv, pc, ordering);
+    }
+    friend inline void qr_sparse(const Matrix<Scalar>& A, Matrix<Scalar>& V, Matrix<Scalar>& R,
+                                 Matrix<Scalar>& beta, std::vector<casadi_int>& prinv,
+                                 std::vector<casadi_int>& pc, const char* ordering) {
+      return Matrix<Scalar>::qr_sparse(A, V, R, beta, prinv, pc, std::string(ordering));
+    }
+
     /** \brief Solve using a sparse QR factorization
 
         \identifier{18u} */
@@ -575,6 +595,19 @@ namespace casadi {
       return Matrix<Scalar>::ldl(A, D, LT, p, amd);
     }
 
+    /** \brief Sparse LDL^T factorization with a given preordering
+
+     * Ordering options: "none", "amd" and "nested_dissection", see Sparsity::ldl
+     */
+    friend inline void ldl(const Matrix<Scalar>& A, Matrix<Scalar>& D, Matrix<Scalar>& LT,
+                           std::vector<casadi_int>& p, const std::string& ordering) {
+      return Matrix<Scalar>::ldl(A, D, LT, p, ordering);
+    }
+    friend inline void ldl(const Matrix<Scalar>& A, Matrix<Scalar>& D, Matrix<Scalar>& LT,
+                           std::vector<casadi_int>& p, const char* ordering) {
+      return Matrix<Scalar>::ldl(A, D, LT, p, std::string(ordering));
+    }
+
     /** \brief Solve using a sparse LDL^T factorization
 
         \identifier{18x} */
@@ -856,6 +889,13 @@ namespace casadi {
         \identifier{19c} */
     static casadi_int get_max_depth();
 
+    /** \brief Get memory usage statistics of the expression graph nodes
+
+        The number and total size of live nodes, and the statistics of the
+        node pool (GlobalOptions::sx_node_pool).
+    */
+    static Dict memory_usage();
+
     /** \brief Get function input
 
         \identifier{19d} */
@@ -1713,6 +1713,11 @@ namespace casadi {
     casadi_error("'get_max_depth' not defined for " + type_name());
   }
 
+  template<typename Scalar>
+  Dict Matrix<Scalar>::memory_usage() {
+    casadi_error("'memory_usage' not defined for " + type_name());
+  }
+
   template<typename Scalar>
   Matrix<Scalar> Matrix<Scalar>::det(const Matrix<Scalar>& x) {
     casadi_int n = x.size2();
@@ -2060,9 +2065,17 @@ namespace casadi {
   qr_sparse(const Matrix<Scalar>& A,
     Matrix<Scalar>& V, Matrix<Scalar> &R, Matrix<Scalar>& beta,
     std::vector<casadi_int>& prinv, std::vector<casadi_int>& pc, bool amd) {
+    qr_sparse(A, V, R, beta, prinv, pc, std::string(amd ? "amd" : "none"));
+  }
+
+  template<typename Scalar>
+  void Matrix<Scalar>::
+  qr_sparse(const Matrix<Scalar>& A,
+    Matrix<Scalar>& V, Matrix<Scalar> &R, Matrix<Scalar>& beta,
+    std::vector<casadi_int>& prinv, std::vector<casadi_int>& pc, const std::string& ordering) {
     // Calculate the pattern
     Sparsity spV, spR;
-    A.sparsity().qr_sparse(spV, spR, prinv, pc, amd);
+    A.sparsity().qr_sparse(spV, spR, prinv, pc, ordering);
     // Calculate the nonzeros
     casadi_int nrow_ext = spV.size1(), ncol = spV.size2();
     V = nan(spV);
@@ -2138,8 +2151,14 @@ namespace casadi {
   template<typename Scalar>
   void Matrix<Scalar>::ldl(const Matrix<Scalar>& A, Matrix<Scalar> &D,
     Matrix<Scalar>& LT, std::vector<casadi_int>& p, bool amd) {
+    ldl(A, D, LT, p, std::string(amd ? "amd" : "none"));
+  }
+
+  template<typename Scalar>
+  void Matrix<Scalar>::ldl(const Matrix<Scalar>& A, Matrix<Scalar> &D,
+    Matrix<Scalar>& LT, std::vector<casadi_int>& p, const std::string& ordering) {
     // Symbolic factorization
-    Sparsity Lt_sp = A.sparsity().ldl(p, amd);
+    Sparsity Lt_sp = A.sparsity().ldl(p, ordering);
 
     // Get dimension
     casadi_int n=A.size1();
@@ -1738,6 +1738,10 @@ namespace casadi {
       Dict h_opts;
       Dict opts_remainder = extract_from_dict(opts, "helper_options", h_opts);
       h_opts["allow_free"] = true;
+      // Evaluate the color groups concurrently when created for a parallelized function
+      if (!opts_remainder.count("parallelization") && h_opts.count("parallelization")) {
+        opts_remainder["parallelization"] = h_opts["parallelization"];
+      }
       Function h("helper_jacobian_MX", {x}, {f}, h_opts);
       return h.get<MXFunction>()->jac(opts_remainder).at(0);
     } catch (std::exception& e) {
@@ -1753,7 +1757,11 @@ namespace casadi {
   MX MX::hessian(const MX& f, const MX& x, MX &g, const Dict& opts) {
     try {
       Dict all_opts = opts;
-      g = gradient(f, x, opts);
+      // Graph coloring options only apply to the Jacobian of the gradient
+      Dict g_opts = opts;
+      g_opts.erase("coloring_ordering");
+      g_opts.erase("coloring_threads");
+      g = gradient(f, x, g_opts);
       if (!opts.count("symmetric")) all_opts["symmetric"] = true;
       return jacobian(g, x, all_opts);
     } catch (std::exception& e) {
@@ -28,7 +28,10 @@
 #include "global_options.hpp"
 #include "casadi_interrupt.hpp"
 #include "io_instruction.hpp"
+#include "split.hpp"
+#include "getnonzeros.hpp"
 #include "serializing_stream.hpp"
+#include "thread_pool.hpp"
 
 #include <stack>
 #include <typeinfo>
@@ -46,6 +49,9 @@ namespace casadi {
                          const std::vector<std::string>& name_in,
                          const std::vector<std::string>& name_out) :
     XFunction<MXFunction, MX, MXNode>(name, inputv, outputv, name_in, name_out) {
+    eval_plan_ = true;
+    parallelization_ = "serial";
+    par_n_region_ = 0;
   }
 
   MXFunction::~MXFunction() {
@@ -63,9 +69,31 @@ namespace casadi {
       {"print_instructions",
        {OT_BOOL,
         "Print each operation during evaluation"}},
+      {"eval_plan",
+       {OT_BOOL,
+        "Evaluate using a flattened plan with resolved work vector offsets "
+        "instead of interpreting the algorithm (Default: true)"}},
+      {"parallelization",
+       {OT_STRING,
+        "serial|thread: evaluate function calls that do not depend on each other "
+        "concurrently on the shared thread pool, each with its own scratch space. "
+        "Live variables are disabled unless set explicitly (Default: serial)"}},
+      {"incremental",
+       {OT_BOOL,
+        "Keep the work vector between calls and only reevaluate the nodes "
+        "that depend on inputs that changed since the previous call. "
+        "Disables live variables unless set explicitly (Default: false)"}},
       {"cse",
        {OT_BOOL,
         "Perform common subexpression elimination (complexity is N*log(N) in graph size)"}},
+      {"graph_passes",
+       {OT_STRINGVECTOR,
+        "Graph optimization passes applied in order before sorting the graph: "
+        "'constant' (evaluate nodes with constant arguments, including function calls), "
+        "'gather' (index directly into the argument of reshapes and concatenations), "
+        "'transpose' (eliminate transposes of transposes and chained reshapes), "
+        "'identity' (x+0, x-0, x*1, x/1 and -(-x)). Nodes no longer needed after a pass "
+        "are dropped. Statistics are reported by info()"}},
       {"allow_free",
        {OT_BOOL,
         "Allow construction with free variables (Default: false)"}},
@@ -80,6 +108,9 @@ namespace casadi {
     //opts["default_in"] = default_in_;
     opts["live_variables"] = live_variables_;
     opts["print_instructions"] = print_instructions_;
+    opts["incremental"] = incremental_;
+    opts["eval_plan"] = eval_plan_;
+    opts["parallelization"] = parallelization_;
     return opts;
   }
 
@@ -117,6 +148,7 @@ namespace casadi {
     print_instructions_ = false;
     bool cse_opt = false;
     bool allow_free = false;
+    std::vector<std::string> graph_passes;
 
     // Read options
     for (auto&& op : opts) {
@@ -126,8 +158,14 @@ namespace casadi {
         live_variables_ = op.second;
       } else if (op.first=="print_instructions") {
         print_instructions_ = op.second;
+      } else if (op.first=="eval_plan") {
+        eval_plan_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
       } else if (op.first=="cse") {
         cse_opt = op.second;
+      } else if (op.first=="graph_passes") {
+        graph_passes = op.second;
       } else if (op.first=="allow_free") {
         allow_free = op.second;
       }
@@ -141,6 +179,18 @@ namespace casadi {
                             "Option 'default_in' has incorrect length");
     }
 
+    casadi_assert(parallelization_=="serial" || parallelization_=="thread",
+      "Unknown parallelization '" + parallelization_ + "', expected 'serial' or 'thread'");
+
+    // Skipped nodes must keep their results, reused work vector locations serialize
+    // otherwise independent calls
+    if ((parallelization_=="thread" || incremental_) && opts.find("live_variables")==opts.end()) {
+      live_variables_ = false;
+    }
+    casadi_assert(!(incremental_ && live_variables_),
+      "Options 'incremental' and 'live_variables' cannot be combined");
+
+    if (!graph_passes.empty()) out_ = optimize_graph(out_, graph_passes, graph_stats_);
     if (cse_opt) out_ = cse(out_);
 
     // Stack used to sort the computational graph
@@ -244,15 +294,105 @@ namespace casadi {
     std::vector<casadi_int>& place = place_in_alg; // Reuse memory as it is no longer needed
     place.resize(nodes.size());
 
-    // Stack with unused elements in the work vector, sorted by sparsity pattern
-    SPARSITY_MAP<casadi_int, std::stack<casadi_int> > unused_all;
+    // Stack with unused elements in the work vector, sorted by number of nonzeros
+    std::map<casadi_int, std::stack<casadi_int> > unused_all;
+
+    // Number of nonzeros that fit in each element of the work vector
+    std::vector<casadi_int> capacity;
+
+    // Node whose reference count keeps the work vector element of a node alive:
+    // the node itself, or the node whose data it aliases
+    std::vector<casadi_int> alias_node = range(nodes.size());
+
+    // Work vector element holding the data of each element, different for aliases,
+    // and the nonzero offset of aliases in that element
+    workalias_.clear();
+    std::vector<casadi_int> alias_offset;
+
+    // Nodes that have been assigned a place before they are evaluated
+    std::vector<bool> placed(nodes.size(), false);
+
+    // Arguments of concatenations are placed back-to-back in the result of the
+    // concatenation if that is their first use as such, making the copy a no-op
+    std::vector<casadi_int> coalesce_into(nodes.size(), -1), coalesce_offset(nodes.size(), 0);
+    for (auto&& e : algorithm_) {
+      if (e.op!=OP_HORZCAT && e.op!=OP_VERTCAT && e.op!=OP_DIAGCAT) continue;
+      casadi_int offset = 0;
+      for (casadi_int a : e.arg) {
+        const MXNode* n = nodes[a];
+        casadi_int nnz = n->sparsity().nnz();
+        // Views already share the data of another node
+        casadi_int op = n->op()<0 ? n->dep(0)->op() : n->op();
+        bool view = op==OP_RESHAPE || op==OP_SPARSITY_CAST
+          || op==OP_HORZSPLIT || op==OP_VERTSPLIT || op==OP_DIAGSPLIT;
+        if (nnz>0 && !view && coalesce_into[a]<0) {
+          coalesce_into[a] = e.res[0];
+          coalesce_offset[a] = offset;
+        }
+        offset += nnz;
+      }
+    }
 
     // Work vector size
     casadi_int worksize = 0;
 
+    // Allocate a new element in the work vector
+    auto new_place = [&](casadi_int nnz) {
+      capacity.push_back(nnz);
+      alias_offset.push_back(0);
+      return worksize++;
+    };
+
+    // Let the result of node r share the data of node a, starting at a nonzero offset
+    auto alias_result = [&](casadi_int r, casadi_int a, casadi_int offset) {
+      casadi_int root = alias_node[a];
+      alias_node[r] = root;
+      refcount[root] += refcount[r];
+      casadi_int p = place[a];
+      place[r] = worksize++;
+      capacity.push_back(0);
+      alias_offset.push_back(alias_offset[p] + offset);
+      workalias_.resize(worksize, -1);
+      workalias_.back() = workalias_[p]>=0 ? workalias_[p] : p;
+      placed[r] = true;
+    };
+
+    // Place a concatenation before any of its arguments are evaluated
+    std::function<void(casadi_int)> place_early = [&](casadi_int c) {
+      if (placed[c]) return;
+      if (coalesce_into[c]>=0) {
+        place_early(coalesce_into[c]);
+        alias_result(c, coalesce_into[c], coalesce_offset[c]);
+      } else {
+        // A new element: a freed one could overlap with the arguments of the node being placed
+        place[c] = new_place(nodes[c]->sparsity().nnz());
+        placed[c] = true;
+      }
+    };
+
     // Find a place in the work vector for the operation
     for (auto&& e : algorithm_) {
 
+      // Reshapes and splits are views: their results get elements of their own for
+      // symbolic evaluation, but share the data of the argument, which stays alive
+      // until the argument and all of its views have been used for the last time
+      bool is_split = e.op==OP_HORZSPLIT || e.op==OP_VERTSPLIT || e.op==OP_DIAGSPLIT;
+      if ((e.op==OP_RESHAPE || e.op==OP_SPARSITY_CAST || is_split) && e.arg[0]>=0) {
+        casadi_int a = e.arg[0];
+        for (casadi_int c=0; c<e.res.size(); ++c) {
+          if (e.res[c]<0) continue;
+          casadi_int offset = is_split ? static_cast<const Split*>(e.data.get())->offset_[c] : 0;
+          alias_result(e.res[c], a, offset);
+          e.res[c] = place[e.res[c]];
+        }
+        casadi_int root = alias_node[a];
+        if (--refcount[root]==0 && live_variables_) {
+          unused_all[capacity[place[root]]].push(place[root]);
+        }
+        e.arg[0] = place[a];
+        continue;
+      }
+
       // There are two tasks, allocate memory of the result and free the
       // memory off the arguments, order depends on whether inplace is possible
       casadi_int first_to_free = 0;
@@ -270,16 +410,13 @@ namespace casadi {
 
             // Decrease reference count and add to the stack of
             // unused variables if the count hits zero
-            casadi_int remaining = --refcount[ch_ind];
+            casadi_int root = alias_node[ch_ind];
+            casadi_int remaining = --refcount[root];
 
             // Free variable for reuse
             if (live_variables_ && remaining==0) {
-
-              // Get a pointer to the sparsity pattern of the argument that can be freed
-              casadi_int nnz = nodes[ch_ind]->sparsity().nnz();
-
-              // Add to the stack of unused work vector elements for the current sparsity
-              unused_all[nnz].push(place[ch_ind]);
+              // Add to the stack of unused work vector elements of the same size
+              unused_all[capacity[place[root]]].push(place[root]);
             }
 
             // Point to the place in the work vector instead of to the place in the list of nodes
@@ -298,6 +435,17 @@ namespace casadi {
         for (casadi_int c=0; c<e.res.size(); ++c) {
           if (e.res[c]>=0) {
 
+            // Concatenations whose arguments have been placed, arguments of concatenations
+            casadi_int r = e.res[c];
+            if (!placed[r] && coalesce_into[r]>=0) {
+              place_early(coalesce_into[r]);
+              alias_result(r, coalesce_into[r], coalesce_offset[r]);
+            }
+            if (placed[r]) {
+              e.res[c] = place[r];
+              continue;
+            }
+
             // Are reuse of variables (live variables) enabled?
             if (live_variables_) {
               // Get a pointer to the sparsity pattern node
@@ -312,15 +460,38 @@ namespace casadi {
                 unused.pop();
                 continue; // Success, no new element needed in the work vector
               }
+
+              // Otherwise, reuse the smallest unused element with at most twice as many
+              // nonzeros. Scalars are not mixed with vectors, these differ in generated code
+              if (nnz>1) {
+                bool found = false;
+                for (auto it=unused_all.upper_bound(nnz);
+                     it!=unused_all.end() && it->first<=2*nnz; ++it) {
+                  if (it->second.empty()) continue;
+                  e.res[c] = place[e.res[c]] = it->second.top();
+                  it->second.pop();
+                  found = true;
+                  break;
+                }
+                if (found) continue;
+              }
             }
 
             // Allocate a new element in the work vector
-            e.res[c] = place[e.res[c]] = worksize++;
+            e.res[c] = place[e.res[c]] = new_place(e.data->sparsity(c).nnz());
           }
         }
       }
     }
 
+    // Elements that are not aliases hold their own data
+    if (!workalias_.empty()) {
+      workalias_.resize(worksize, -1);
+      for (casadi_int i=0; i<worksize; ++i) {
+        if (workalias_[i]<0) workalias_[i] = i;
+      }
+    }
+
     if (verbose_) {
       if (live_variables_) {
         casadi_message("Using live variables: work array is " + str(worksize)
@@ -328,6 +499,9 @@ namespace casadi {
       } else {
         casadi_message("Live variables disabled.");
       }
+      casadi_int n_alias = 0;
+      for (casadi_int i=0; i<workalias_.size(); ++i) if (workalias_[i]!=i) n_alias++;
+      casadi_message(str(n_alias) + " work vector elements share the data of another element");
     }
 
     // Allocate work vectors (numeric)
@@ -342,7 +516,7 @@ namespace casadi {
             alloc_res(e.data->sz_res());
             alloc_iw(e.data->sz_iw());
             sz_w = std::max(sz_w, e.data->sz_w());
-            if (workloc_[e.res[c]] < 0) {
+            if (workloc_[e.res[c]] < 0 && work_alias(e.res[c])==e.res[c]) {
               workloc_[e.res[c]] = wind;
               wind += e.data->sparsity(c).nnz();
             }
@@ -355,6 +529,9 @@ namespace casadi {
       if (workloc_[i]<0) workloc_[i] = i==0 ? 0 : workloc_[i-1];
       workloc_[i] += sz_w;
     }
+    for (casadi_int i=0; i<workalias_.size(); ++i) {
+      if (workalias_[i]!=i) workloc_[i] = workloc_[workalias_[i]] + alias_offset[i];
+    }
     sz_w += wind;
     alloc_w(sz_w);
 
@@ -416,6 +593,482 @@ namespace casadi {
         break;
       }
     }
+
+    // Dependency masks for incremental evaluation
+    init_incremental();
+
+    // Flattened evaluation plan
+    init_plan();
+
+    // Stages of concurrent function calls, each task with its own scratch space
+    init_parallel(ThreadPool::default_size()+1);
+    if (!par_stage_.empty()) {
+      alloc_arg(par_n_region_*par_sz_arg_);
+      alloc_res(par_n_region_*par_sz_res_);
+      alloc_iw(par_n_region_*par_sz_iw_);
+      // The first region shares the node scratch space at the start of the work vector
+      alloc_w(workloc_.back() + (par_n_region_-1)*par_sz_w_);
+    }
+  }
+
+  bool MXFunction::is_view(const AlgEl& e) const {
+    switch (e.op) {
+    case OP_RESHAPE:
+    case OP_SPARSITY_CAST:
+    case OP_HORZSPLIT:
+    case OP_VERTSPLIT:
+    case OP_DIAGSPLIT:
+      for (casadi_int r : e.res) if (r>=0 && work_alias(r)==r) return false;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  void MXFunction::init_parallel(casadi_int max_region) {
+    par_order_.clear();
+    par_stage_.clear();
+    par_call_.clear();
+    par_sz_arg_ = par_sz_res_ = par_sz_iw_ = par_sz_w_ = 0;
+    casadi_int n_region = par_n_region_ = 0;
+    if (parallelization_!="thread" || !free_vars_.empty()) return;
+#ifndef CASADI_WITH_THREAD
+    casadi_warning(name_ + ": parallelization 'thread' requires thread support, "
+      "evaluating serially");
+    return;
+#endif // CASADI_WITH_THREAD
+    if (ThreadPool::default_size()<=1 || max_region<2) return;
+
+    // Assign each node to the first level after the nodes that write its arguments
+    // (read after write). With live variables, also after the previous readers and writers
+    // of the work vector elements it writes (write after read, write after write), without,
+    // every nonzero is written once. Aliases are tracked as the element holding their data
+    bool reuse = live_variables_;
+    casadi_int worksize = workloc_.size()-1;
+    std::vector<casadi_int> level(algorithm_.size());
+    std::vector<casadi_int> last_write(worksize, -1), last_read(worksize, -1);
+    casadi_int n_level = 0;
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      casadi_int lev = 0;
+      // Views do not access the work vector
+      if (is_view(e)) {
+        level[k] = last_write[work_alias(e.arg[0])]+1;
+        n_level = std::max(n_level, level[k]+1);
+        continue;
+      }
+      for (casadi_int a : e.arg) if (a>=0) lev = std::max(lev, last_write[work_alias(a)]+1);
+      if (reuse && e.op!=OP_OUTPUT) {
+        for (casadi_int r : e.res) {
+          if (r<0) continue;
+          r = work_alias(r);
+          lev = std::max(lev, std::max(last_read[r], last_write[r])+1);
+        }
+      }
+      if (reuse) {
+        for (casadi_int a : e.arg) {
+          if (a>=0) last_read[work_alias(a)] = std::max(last_read[work_alias(a)], lev);
+        }
+      }
+      if (e.op!=OP_OUTPUT) {
+        for (casadi_int r : e.res) {
+          if (r<0) continue;
+          r = work_alias(r);
+          last_write[r] = std::max(last_write[r], lev);
+          if (reuse) last_read[r] = -1;
+        }
+      }
+      level[k] = lev;
+      n_level = std::max(n_level, lev+1);
+    }
+
+    // Sort the nodes by level, function calls last within each level
+    std::vector<casadi_int> level_offset(n_level+1, 0), n_call(n_level, 0);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      level_offset[level[k]+1]++;
+      if (algorithm_[k].op==OP_CALL) n_call[level[k]]++;
+    }
+    for (casadi_int lev=0; lev<n_level; ++lev) level_offset[lev+1] += level_offset[lev];
+    std::vector<casadi_int> pos(level_offset.begin(), level_offset.end()-1), pos_call(n_level);
+    for (casadi_int lev=0; lev<n_level; ++lev) pos_call[lev] = level_offset[lev+1]-n_call[lev];
+    par_order_.resize(algorithm_.size());
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      casadi_int lev = level[k];
+      par_order_[algorithm_[k].op==OP_CALL ? pos_call[lev]++ : pos[lev]++] = k;
+    }
+
+    // Levels with several calls become stages of their own, consecutive levels with at
+    // most one call are merged into serial stages
+    par_stage_.push_back(0);
+    for (casadi_int lev=0; lev<n_level; ++lev) {
+      bool parallel = n_call[lev]>=2;
+      if (parallel || par_call_.empty() || par_call_.back()>=0) {
+        if (lev>0) par_stage_.push_back(level_offset[lev]);
+        par_call_.push_back(parallel ? level_offset[lev+1]-n_call[lev] : -1);
+      }
+      if (parallel) n_region = std::max(n_region, n_call[lev]);
+    }
+    par_stage_.push_back(algorithm_.size());
+    for (casadi_int s=0; s<par_call_.size(); ++s) {
+      if (par_call_[s]<0) par_call_[s] = par_stage_[s+1];
+    }
+
+    if (verbose_) {
+      casadi_message(name_ + ": " + str(n_level) + " dependency levels in "
+        + str(par_call_.size()) + " stages");
+    }
+
+    // Nothing to gain
+    if (n_region==0) {
+      par_order_.clear();
+      par_stage_.clear();
+      par_call_.clear();
+      return;
+    }
+
+    // Scratch space of each concurrent task
+    par_n_region_ = std::min(n_region, max_region);
+    for (auto&& e : algorithm_) {
+      if (e.op!=OP_CALL) continue;
+      par_sz_arg_ = std::max(par_sz_arg_, e.data->sz_arg());
+      par_sz_res_ = std::max(par_sz_res_, e.data->sz_res());
+      par_sz_iw_ = std::max(par_sz_iw_, e.data->sz_iw());
+      par_sz_w_ = std::max(par_sz_w_, e.data->sz_w());
+    }
+  }
+
+  int MXFunction::eval_el(const AlgEl& e, const double** arg, double** res,
+      const double** arg1, double** res1, casadi_int* iw, double* w, double* ws) const {
+    if (e.op==OP_INPUT) {
+      double *w1 = w+workloc_[e.res.front()];
+      casadi_int nnz=e.data.nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (arg[i]==nullptr) {
+        std::fill(w1, w1+nnz, 0);
+      } else {
+        std::copy(arg[i]+nz_offset, arg[i]+nz_offset+nnz, w1);
+      }
+    } else if (e.op==OP_OUTPUT) {
+      double *w1 = w+workloc_[e.arg.front()];
+      casadi_int nnz=e.data->dep().nnz();
+      casadi_int i=e.data->ind();
+      casadi_int nz_offset=e.data->offset();
+      if (res[i]) std::copy(w1, w1+nnz, res[i]+nz_offset);
+    } else {
+      for (casadi_int i=0; i<e.arg.size(); ++i)
+        arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]] : nullptr;
+      for (casadi_int i=0; i<e.res.size(); ++i)
+        res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]] : nullptr;
+      return e.data->eval(arg1, res1, iw, ws);
+    }
+    return 0;
+  }
+
+  int MXFunction::eval_parallel(const double** arg, double** res, casadi_int* iw, double* w,
+      bool skip, bvec_t changed) const {
+    std::shared_ptr<ThreadPool> pool = ThreadPool::instance();
+    const double** arg1 = arg+n_in_;
+    double** res1 = res+n_out_;
+    for (casadi_int s=0; s+1<par_stage_.size(); ++s) {
+      // Nodes evaluated by the calling thread
+      for (casadi_int i=par_stage_[s]; i<par_call_[s]; ++i) {
+        casadi_int k = par_order_[i];
+        const AlgEl& e = algorithm_[k];
+        if (skip && e.op!=OP_OUTPUT && !(incr_mask_[k] & changed)) continue;
+        if (eval_el(e, arg, res, arg1, res1, iw, w, w)) return 1;
+      }
+      // Independent calls, task t evaluates every n_task-th call in scratch region t,
+      // the results do not depend on the assignment of tasks to threads
+      casadi_int begin = par_call_[s], end = par_stage_[s+1];
+      if (begin==end) continue;
+      casadi_int n_task = std::min(end-begin, par_n_region_);
+      int flag = pool->run(n_task, [&](casadi_int t) {
+        double* ws = t==0 ? w : w + workloc_.back() + (t-1)*par_sz_w_;
+        for (casadi_int i=begin+t; i<end; i+=n_task) {
+          casadi_int k = par_order_[i];
+          if (skip && !(incr_mask_[k] & changed)) continue;
+          if (eval_el(algorithm_[k], arg, res, arg1+t*par_sz_arg_, res1+t*par_sz_res_,
+                      iw+t*par_sz_iw_, w, ws)) return 1;
+        }
+        return 0;
+      });
+      if (flag) return flag;
+    }
+    return 0;
+  }
+
+  void MXFunction::init_plan() {
+    plan_.clear();
+    plan_arg_loc_.clear();
+    plan_res_loc_.clear();
+    if (!eval_plan_) return;
+    plan_.reserve(algorithm_.size());
+    for (auto&& e : algorithm_) {
+      MXPlanStep s;
+      s.op = e.op;
+      s.node = e.data.get();
+      s.iarg = plan_arg_loc_.size();
+      s.ires = plan_res_loc_.size();
+      s.n_arg = s.n_res = 0;
+      s.scratch = false;
+      s.ind = s.offset = s.nnz = s.loc = 0;
+      if (e.op==OP_INPUT) {
+        s.ind = e.data->ind();
+        s.offset = e.data->offset();
+        s.nnz = e.data.nnz();
+        s.loc = workloc_[e.res.front()];
+      } else if (e.op==OP_OUTPUT) {
+        s.ind = e.data->ind();
+        s.offset = e.data->offset();
+        s.nnz = e.data->dep().nnz();
+        s.loc = workloc_[e.arg.front()];
+      } else {
+        s.n_arg = e.arg.size();
+        s.n_res = e.res.size();
+        for (casadi_int a : e.arg) plan_arg_loc_.push_back(a>=0 ? workloc_[a] : -1);
+        for (casadi_int r : e.res) plan_res_loc_.push_back(r>=0 ? workloc_[r] : -1);
+        // Nodes that use more pointers than their arguments and results, e.g. calls,
+        // get copies of their pointers in the scratch space
+        s.scratch = e.op==OP_CALL || e.data->sz_arg()>s.n_arg || e.data->sz_res()>s.n_res;
+      }
+      plan_.push_back(s);
+    }
+  }
+
+  int MXFunction::init_mem(void* mem) const {
+    if (XFunction<MXFunction, MX, MXNode>::init_mem(mem)) return 1;
+    auto m = static_cast<MXFunctionMemory*>(mem);
+    m->plan_arg.resize(plan_arg_loc_.size());
+    m->plan_res.resize(plan_res_loc_.size());
+    m->plan_w = nullptr;
+    return 0;
+  }
+
+  /// Nonzero offsets of the arguments of a concatenation whose nonzeros are stacked
+  static bool stacked_nonzeros(const MX& x, std::vector<casadi_int>& offset) {
+    if (x.op()==OP_VERTCAT) {
+      // Column vectors only, otherwise the nonzeros of the arguments are interleaved
+      if (x.size2()!=1) return false;
+    } else if (x.op()!=OP_HORZCAT && x.op()!=OP_DIAGCAT) {
+      return false;
+    }
+    offset.resize(1, 0);
+    for (casadi_int i=0; i<x.n_dep(); ++i) offset.push_back(offset.back() + x.dep(i).nnz());
+    return true;
+  }
+
+  /** \brief Apply a graph optimization pass to a node
+
+      arg are the (rewritten) arguments of the node and res its results as recreated
+      by eval_mx. Returns true if res was replaced.
+  */
+  static bool graph_rewrite(const std::string& pass, const MXNode* n,
+      const std::vector<MX>& arg, std::vector<MX>& res) {
+    casadi_int op = n->op();
+    if (pass=="constant") {
+      // Nodes with side effects are kept
+      if (arg.empty() || op==OP_CONST || op==OP_ASSERTION || op==OP_MONITOR) return false;
+      for (auto&& a : arg) if (!a.is_constant()) return false;
+      // Already folded when the node was recreated?
+      bool folded = true;
+      for (auto&& r : res) folded = folded && r.is_constant();
+      if (folded) return false;
+      try {
+        Function c("c", std::vector<MX>{}, res, {{"max_io", 0}});
+        std::vector<DM> v = c(std::vector<DM>{});
+        for (casadi_int i=0; i<res.size(); ++i) res[i] = v[i];
+      } catch (std::exception&) {
+        // Keep the node if it cannot be evaluated numerically
+        return false;
+      }
+      return true;
+    } else if (pass=="gather") {
+      if (op!=OP_GETNONZEROS || res[0].op()!=OP_GETNONZEROS) return false;
+      std::vector<casadi_int> nz = static_cast<const GetNonzeros*>(n)->all();
+      MX x = arg[0];
+      std::vector<casadi_int> offset;
+      bool changed = false;
+      while (true) {
+        if (x.op()==OP_RESHAPE || x.op()==OP_SPARSITY_CAST) {
+          // Same nonzeros in the same order
+          x = x.dep();
+        } else if (stacked_nonzeros(x, offset)) {
+          // All nonzeros taken from a single argument?
+          casadi_int lo = -1, hi = -1;
+          for (casadi_int k : nz) {
+            if (k<0) continue;
+            lo = lo<0 ? k : std::min(lo, k);
+            hi = std::max(hi, k);
+          }
+          if (lo<0) break;
+          casadi_int i = std::upper_bound(offset.begin(), offset.end(), lo) - offset.begin() - 1;
+          if (hi>=offset[i+1]) break;
+          for (casadi_int& k : nz) if (k>=0) k -= offset[i];
+          x = x.dep(i);
+        } else {
+          break;
+        }
+        changed = true;
+      }
+      if (!changed) return false;
+      res[0] = x->get_nzref(n->sparsity(), nz);
+      return true;
+    } else if (pass=="transpose") {
+      const MX& x = arg[0];
+      if (op==OP_TRANSPOSE) {
+        if (res[0].op()!=OP_TRANSPOSE || x.op()!=OP_TRANSPOSE) return false;
+        res[0] = x.dep();
+      } else if (op==OP_RESHAPE || op==OP_SPARSITY_CAST) {
+        if (res[0].op()!=op) return false;
+        if (x.sparsity()==n->sparsity()) {
+          res[0] = x;
+        } else if (x.op()==OP_RESHAPE || x.op()==OP_SPARSITY_CAST) {
+          res[0] = op==OP_RESHAPE && x.op()==OP_RESHAPE ? reshape(x.dep(), n->sparsity())
+                                                        : sparsity_cast(x.dep(), n->sparsity());
+        } else {
+          return false;
+        }
+      } else {
+        return false;
+      }
+      return true;
+    } else if (pass=="identity") {
+      if (res[0].is_constant()) return false;
+      MX r;
+      if (op==OP_NEG) {
+        if (arg[0].op()==OP_NEG) r = arg[0].dep();
+      } else if (op==OP_ADD) {
+        if (arg[0].is_zero()) r = arg[1];
+        if (arg[1].is_zero()) r = arg[0];
+      } else if (op==OP_SUB) {
+        if (arg[1].is_zero()) r = arg[0];
+      } else if (op==OP_MUL) {
+        if (arg[0].is_one()) r = arg[1];
+        if (arg[1].is_one()) r = arg[0];
+      } else if (op==OP_DIV) {
+        if (arg[1].is_one()) r = arg[0];
+      }
+      // Only if no broadcasting or densification is needed
+      if (r.is_null() || r.sparsity()!=n->sparsity() || r.get()==res[0].get()) return false;
+      res[0] = r;
+      return true;
+    } else {
+      // Dead code is dropped when sorting the graph
+      return false;
+    }
+  }
+
+  std::vector<MX> MXFunction::optimize_graph(const std::vector<MX>& ex,
+      const std::vector<std::string>& passes, Dict& stats) {
+    std::vector<MX> ret = ex;
+    std::vector<MX> arg1, res1;
+    // Number of rewrites and nodes removed by each pass
+    std::map<std::string, casadi_int> n_rewrite, n_removed;
+    casadi_int n_nodes = -1;
+    for (casadi_int p=0; p<=passes.size(); ++p) {
+      // Sort the current graph, dropping nodes that are no longer needed
+      Function f("f", std::vector<MX>{}, ret,
+        {{"live_variables", false}, {"max_io", 0}, {"allow_free", true}});
+      const MXFunction* ff = f.get<MXFunction>();
+      if (p==0) {
+        stats["n_nodes_before"] = ff->n_nodes();
+      } else {
+        n_removed[passes[p-1]] += n_nodes - ff->n_nodes();
+      }
+      n_nodes = ff->n_nodes();
+      if (p==passes.size()) break;
+      const std::string& pass = passes[p];
+      casadi_assert(pass=="constant" || pass=="gather" || pass=="transpose"
+        || pass=="identity",
+        "Unknown graph pass '" + pass + "', "
+        "expected 'constant', 'gather', 'transpose' or 'identity'");
+      n_rewrite[pass] += 0;
+
+      // Reevaluate symbolically, rewriting nodes
+      std::vector<MX> swork(ff->workloc_.size()-1);
+      std::vector<std::vector<MX> > res_split(ret.size());
+      for (casadi_int i=0; i<ret.size(); ++i) res_split[i].resize(ret[i].n_primitives());
+      for (auto&& e : ff->algorithm_) {
+        if (e.op==OP_OUTPUT) {
+          res_split.at(e.data->ind()).at(e.data->segment()) = swork[e.arg.front()];
+        } else if (e.op==OP_PARAMETER) {
+          swork[e.res.front()] = e.data;
+        } else if (e.op!=OP_INPUT) {
+          arg1.resize(e.arg.size());
+          for (casadi_int i=0; i<arg1.size(); ++i) {
+            casadi_int el = e.arg[i];
+            arg1[i] = el<0 ? MX(e.data->dep(i).size()) : swork[el];
+          }
+          res1.resize(e.res.size());
+          e.data->eval_mx(arg1, res1);
+          if (graph_rewrite(pass, e.data.get(), arg1, res1)) n_rewrite[pass]++;
+          for (casadi_int i=0; i<res1.size(); ++i) {
+            if (e.res[i]>=0) swork[e.res[i]] = res1[i];
+          }
+        }
+      }
+      for (casadi_int i=0; i<ret.size(); ++i) {
+        ret[i] = ret[i].join_primitives(res_split[i]);
+        casadi_assert_dev(ret[i].sparsity()==ex[i].sparsity());
+      }
+    }
+    stats["n_nodes_after"] = n_nodes;
+    for (auto&& r : n_rewrite) {
+      stats[r.first] = Dict{{"rewrites", r.second}, {"removed", n_removed[r.first]}};
+    }
+    return ret;
+  }
+
+  void MXFunction::init_incremental() {
+    incr_mask_.clear();
+    if (!incremental_) return;
+    // Seed each input nonzero with the bit of its group
+    casadi_int nnz = nnz_in();
+    std::vector<bvec_t> seed(nnz);
+    for (casadi_int j=0; j<nnz; ++j) seed[j] = incremental_bit(j, nnz);
+    // Propagate forward, as in sp_forward, recording the dependencies of each node
+    std::vector<const bvec_t*> arg(sz_arg(), nullptr);
+    std::vector<bvec_t*> res(sz_res(), nullptr);
+    std::vector<casadi_int> iw(sz_iw());
+    std::vector<bvec_t> w(sz_w(), 0);
+    const bvec_t** arg1 = get_ptr(arg) + n_in_;
+    bvec_t** res1 = get_ptr(res) + n_out_;
+    casadi_int offset = 0;
+    for (casadi_int i=0; i<n_in_; ++i) {
+      arg[i] = get_ptr(seed) + offset;
+      offset += nnz_in(i);
+    }
+    incr_mask_.resize(algorithm_.size(), 0);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      bvec_t& mask = incr_mask_[k];
+      if (e.op==OP_INPUT) {
+        casadi_int n = e.data.nnz();
+        const bvec_t* a = arg[e.data->ind()] + e.data->offset();
+        bvec_t* w1 = get_ptr(w) + workloc_[e.res.front()];
+        std::copy(a, a+n, w1);
+        for (casadi_int j=0; j<n; ++j) mask |= a[j];
+      } else if (e.op!=OP_OUTPUT) {
+        for (casadi_int i=0; i<e.arg.size(); ++i)
+          arg1[i] = e.arg[i]>=0 ? get_ptr(w)+workloc_[e.arg[i]] : nullptr;
+        for (casadi_int i=0; i<e.res.size(); ++i)
+          res1[i] = e.res[i]>=0 ? get_ptr(w)+workloc_[e.res[i]] : nullptr;
+        if (e.data->sp_forward(arg1, res1, get_ptr(iw), get_ptr(w))) {
+          // Unknown dependencies
+          mask = ~bvec_t(0);
+          for (casadi_int i=0; i<e.res.size(); ++i) {
+            if (res1[i]) std::fill_n(res1[i], e.data->sparsity(i).nnz(), mask);
+          }
+        } else {
+          for (casadi_int i=0; i<e.res.size(); ++i) {
+            if (!res1[i]) continue;
+            casadi_int n = e.data->sparsity(i).nnz();
+            for (casadi_int j=0; j<n; ++j) mask |= res1[i][j];
+          }
+        }
+      }
+    }
   }
 
   int MXFunction::eval(const double** arg, double** res,
@@ -433,6 +1086,63 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // With incremental evaluation, only nodes that depend on changed inputs are evaluated
+    bool skip = false;
+    bvec_t changed = 0;
+    if (incremental_ && mem) {
+      auto m = static_cast<XFunctionMemory*>(mem);
+      skip = m->valid;
+      changed = incremental_changed(arg, m);
+      w = get_ptr(m->w);
+    }
+
+    // Evaluate independent calls concurrently
+    if (!par_stage_.empty() && !print_instructions_) {
+      return eval_parallel(arg, res, iw, w, skip, changed);
+    }
+
+    // Evaluate the flattened plan
+    if (!plan_.empty() && mem && !print_instructions_) {
+      auto m = static_cast<MXFunctionMemory*>(mem);
+      const double** parg = get_ptr(m->plan_arg);
+      double** pres = get_ptr(m->plan_res);
+      // Resolve the pointer tables, unless done for the same work vector before
+      if (m->plan_w!=w) {
+        for (casadi_int i=0; i<plan_arg_loc_.size(); ++i) {
+          parg[i] = plan_arg_loc_[i]>=0 ? w+plan_arg_loc_[i] : nullptr;
+        }
+        for (casadi_int i=0; i<plan_res_loc_.size(); ++i) {
+          pres[i] = plan_res_loc_[i]>=0 ? w+plan_res_loc_[i] : nullptr;
+        }
+        m->plan_w = w;
+      }
+      for (casadi_int k=0; k<plan_.size(); ++k) {
+        const MXPlanStep& s = plan_[k];
+        if (skip && s.op!=OP_OUTPUT && !(incr_mask_[k] & changed)) continue;
+        switch (s.op) {
+        case OP_INPUT:
+          if (arg[s.ind]==nullptr) {
+            std::fill_n(w+s.loc, s.nnz, 0);
+          } else {
+            std::copy_n(arg[s.ind]+s.offset, s.nnz, w+s.loc);
+          }
+          break;
+        case OP_OUTPUT:
+          if (res[s.ind]) std::copy_n(w+s.loc, s.nnz, res[s.ind]+s.offset);
+          break;
+        default:
+          if (s.scratch) {
+            std::copy_n(parg+s.iarg, s.n_arg, arg1);
+            std::copy_n(pres+s.ires, s.n_res, res1);
+            if (s.node->eval(arg1, res1, iw, w)) return 1;
+          } else {
+            if (s.node->eval(parg+s.iarg, pres+s.ires, iw, w)) return 1;
+          }
+        }
+      }
+      return 0;
+    }
+
     // Operation number (for printing)
     casadi_int k = 0;
 
@@ -440,7 +1150,9 @@ namespace casadi {
     // should only evaluate nodes that have not yet been calculated!
     for (auto&& e : algorithm_) {
       // Perform the operation
-      if (e.op==OP_INPUT) {
+      if (skip && e.op!=OP_OUTPUT && !(incr_mask_[k] & changed)) {
+        // Result unchanged since the previous call
+      } else if (e.op==OP_INPUT) {
         // Pass an input
         double *w1 = w+workloc_[e.res.front()];
         casadi_int nnz=e.data.nnz();
@@ -641,6 +1353,98 @@ namespace casadi {
     return 0;
   }
 
+  int MXFunction::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Fall back when forward mode not allowed
+    if (sp_weight()==1 || sp_weight()==-1)
+      return FunctionInternal::sp_forward_wide(arg, res, iw, w, mem, nw);
+    // Temporaries to hold pointers to operation input and outputs
+    const bvec_t** arg1=arg+n_in_;
+    bvec_t** res1=res+n_out_;
+
+    // Propagate sparsity forward, each nonzero occupies nw elements
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_INPUT) {
+        // Pass input seeds
+        casadi_int nnz=e.data.nnz()*nw;
+        casadi_int i=e.data->ind();
+        casadi_int nz_offset=e.data->offset()*nw;
+        const bvec_t* argi = arg[i];
+        bvec_t* w1 = w + workloc_[e.res.front()]*nw;
+        if (argi!=nullptr) {
+          std::copy(argi+nz_offset, argi+nz_offset+nnz, w1);
+        } else {
+          std::fill_n(w1, nnz, 0);
+        }
+      } else if (e.op==OP_OUTPUT) {
+        // Get the output sensitivities
+        casadi_int nnz=e.data.dep().nnz()*nw;
+        casadi_int i=e.data->ind();
+        casadi_int nz_offset=e.data->offset()*nw;
+        bvec_t* resi = res[i];
+        bvec_t* w1 = w + workloc_[e.arg.front()]*nw;
+        if (resi!=nullptr) std::copy(w1, w1+nnz, resi+nz_offset);
+      } else {
+        // Point pointers to the data corresponding to the element
+        for (casadi_int i=0; i<e.arg.size(); ++i)
+          arg1[i] = e.arg[i]>=0 ? w+workloc_[e.arg[i]]*nw : nullptr;
+        for (casadi_int i=0; i<e.res.size(); ++i)
+          res1[i] = e.res[i]>=0 ? w+workloc_[e.res[i]]*nw : nullptr;
+
+        // Propagate sparsity forwards
+        if (e.data->sp_forward_wide(arg1, res1, iw, w, nw)) return 1;
+      }
+    }
+    return 0;
+  }
+
+  int MXFunction::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Fall back when reverse mode not allowed
+    if (sp_weight()==0 || sp_weight()==-1)
+      return FunctionInternal::sp_reverse_wide(arg, res, iw, w, mem, nw);
+    // Temporaries to hold pointers to operation input and outputs
+    bvec_t** arg1=arg+n_in_;
+    bvec_t** res1=res+n_out_;
+
+    std::fill_n(w, sz_w()*nw, 0);
+
+    // Propagate sparsity backwards, each nonzero occupies nw elements
+    for (auto it=algorithm_.rbegin(); it!=algorithm_.rend(); it++) {
+      if (it->op==OP_INPUT) {
+        // Get the input sensitivities and clear it from the work vector
+        casadi_int nnz=it->data.nnz()*nw;
+        casadi_int i=it->data->ind();
+        casadi_int nz_offset=it->data->offset()*nw;
+        bvec_t* argi = arg[i];
+        bvec_t* w1 = w + workloc_[it->res.front()]*nw;
+        if (argi!=nullptr) for (casadi_int k=0; k<nnz; ++k) argi[nz_offset+k] |= w1[k];
+        std::fill_n(w1, nnz, 0);
+      } else if (it->op==OP_OUTPUT) {
+        // Pass output seeds
+        casadi_int nnz=it->data.dep().nnz()*nw;
+        casadi_int i=it->data->ind();
+        casadi_int nz_offset=it->data->offset()*nw;
+        bvec_t* resi = res[i] ? res[i] + nz_offset : nullptr;
+        bvec_t* w1 = w + workloc_[it->arg.front()]*nw;
+        if (resi!=nullptr) {
+          for (casadi_int k=0; k<nnz; ++k) w1[k] |= resi[k];
+          std::fill_n(resi, nnz, 0);
+        }
+      } else {
+        // Point pointers to the data corresponding to the element
+        for (casadi_int i=0; i<it->arg.size(); ++i)
+          arg1[i] = it->arg[i]>=0 ? w+workloc_[it->arg[i]]*nw : nullptr;
+        for (casadi_int i=0; i<it->res.size(); ++i)
+          res1[i] = it->res[i]>=0 ? w+workloc_[it->res[i]]*nw : nullptr;
+
+        // Propagate sparsity backwards
+        if (it->data->sp_reverse_wide(arg1, res1, iw, w, nw)) return 1;
+      }
+    }
+    return 0;
+  }
+
   std::vector<MX> MXFunction::symbolic_output(const std::vector<MX>& arg) const {
     // Check if input is given
     const casadi_int checking_depth = 2;
@@ -1178,11 +1982,32 @@ namespace casadi {
     g.init_local("arg1", "arg+" + str(n_in_));
     g.init_local("res1", "res+" + str(n_out_));
 
+    // Number of nonzeros of each work vector element
+    std::vector<casadi_int> worknnz(workloc_.size()-1, 0);
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_OUTPUT) continue;
+      for (casadi_int c=0; c<e.res.size(); ++c) {
+        casadi_int j = e.res[c];
+        if (j>=0) worknnz[j] = std::max(worknnz[j], e.data->sparsity(c).nnz());
+      }
+    }
+
+    // Aliases covering all data of an element are generated as that element,
+    // other aliases are pointers into its data, except scalars held in local variables
+    std::vector<casadi_int> name(worknnz.size());
+    for (casadi_int i=0; i<name.size(); ++i) {
+      casadi_int j = work_alias(i);
+      name[i] = workloc_[i]==workloc_[j] && worknnz[i]==worknnz[j] ? j : i;
+    }
+    auto in_w = [&](casadi_int j) {
+      return name[j]!=j || g.codegen_scalars || worknnz[j]!=1;
+    };
+
     // Declare scalar work vector elements as local variables
     bool first = true;
     for (casadi_int i=0; i<workloc_.size()-1; ++i) {
-      casadi_int n=workloc_[i+1]-workloc_[i];
-      if (n==0) continue;
+      casadi_int n=worknnz[i];
+      if (n==0 || name[i]!=i) continue;
       if (first) {
         g << "casadi_real ";
         first = false;
@@ -1217,12 +2042,31 @@ namespace casadi {
         g << "/* #" << k++ << ": " << print(e) << " */\n";
       }
 
+      // Views and concatenations of arguments placed in the result need no code,
+      // unless scalars are involved
+      bool noop = false;
+      if (is_view(e)) {
+        noop = true;
+        for (casadi_int r : e.res) if (r>=0 && !in_w(r)) noop = false;
+      } else if (e.op==OP_HORZCAT || e.op==OP_VERTCAT || e.op==OP_DIAGCAT) {
+        noop = true;
+        casadi_int r = e.res[0], offset = 0;
+        for (casadi_int i=0; i<e.arg.size() && noop; ++i) {
+          casadi_int a = e.arg[i], nnz = e.data->dep(i).nnz();
+          if (nnz>0) {
+            noop = work_alias(a)==work_alias(r) && workloc_[a]==workloc_[r]+offset && in_w(a);
+          }
+          offset += nnz;
+        }
+      }
+      if (noop) continue;
+
       // Get the names of the operation arguments
       arg.resize(e.arg.size());
       for (casadi_int i=0; i<e.arg.size(); ++i) {
         casadi_int j=e.arg.at(i);
-        if (j>=0 && workloc_.at(j)!=workloc_.at(j+1)) {
-          arg.at(i) = j;
+        if (j>=0 && worknnz.at(j)>0) {
+          arg.at(i) = name.at(j);
         } else {
           arg.at(i) = -1;
         }
@@ -1232,8 +2076,8 @@ namespace casadi {
       res.resize(e.res.size());
       for (casadi_int i=0; i<e.res.size(); ++i) {
         casadi_int j=e.res.at(i);
-        if (j>=0 && workloc_.at(j)!=workloc_.at(j+1)) {
-          res.at(i) = j;
+        if (j>=0 && worknnz.at(j)>0) {
+          res.at(i) = name.at(j);
         } else {
           res.at(i) = -1;
         }
@@ -1732,6 +2576,44 @@ namespace casadi {
     }
   }
 
+  Dict MXFunction::info() const {
+    Dict ret = XFunction<MXFunction, MX, MXNode>::info();
+    // Work vector size without reuse, reshapes evaluated without copying,
+    // nodes overwriting one of their arguments
+    casadi_int work_nnz_unshared = 0, n_alias = 0, n_inplace = 0;
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_OUTPUT) continue;
+      for (casadi_int c=0; c<e.res.size(); ++c) {
+        casadi_int j = e.res[c];
+        if (j<0) continue;
+        work_nnz_unshared += e.data->sparsity(c).nnz();
+        if (work_alias(j)!=j) {
+          n_alias++;
+        } else {
+          for (casadi_int a : e.arg) {
+            if (a>=0 && work_alias(a)==j) {
+              n_inplace++;
+              break;
+            }
+          }
+        }
+      }
+    }
+    ret["work_nnz"] = workloc_.back() - workloc_.front();
+    ret["work_nnz_unshared"] = work_nnz_unshared;
+    ret["n_alias"] = n_alias;
+    ret["n_inplace"] = n_inplace;
+    if (!graph_stats_.empty()) ret["graph_passes"] = graph_stats_;
+    if (!par_stage_.empty()) {
+      casadi_int n_parallel = 0;
+      for (casadi_int s=0; s<par_call_.size(); ++s) if (par_call_[s]<par_stage_[s+1]) n_parallel++;
+      ret["parallel_stages"] = static_cast<casadi_int>(par_call_.size());
+      ret["parallel_stages_threaded"] = n_parallel;
+      ret["parallel_regions"] = par_n_region_;
+    }
+    return ret;
+  }
+
   Dict MXFunction::get_stats(void* mem) const {
     Dict stats = XFunction::get_stats(mem);
 
@@ -1752,7 +2634,7 @@ namespace casadi {
   void MXFunction::serialize_body(SerializingStream &s) const {
     XFunction<MXFunction, MX, MXNode>::serialize_body(s);
 
-    s.version("MXFunction", 2);
+    s.version("MXFunction", 6);
     s.pack("MXFunction::n_instr", algorithm_.size());
 
     // Loop over algorithm
@@ -1763,17 +2645,22 @@ namespace casadi {
     }
 
     s.pack("MXFunction::workloc", workloc_);
+    s.pack("MXFunction::workalias", workalias_);
     s.pack("MXFunction::free_vars", free_vars_);
     s.pack("MXFunction::default_in", default_in_);
     s.pack("MXFunction::live_variables", live_variables_);
     s.pack("MXFunction::print_instructions", print_instructions_);
+    s.pack("MXFunction::eval_plan", eval_plan_);
+    s.pack("MXFunction::parallelization", parallelization_);
+    s.pack("MXFunction::par_n_region", par_n_region_);
+    s.pack("MXFunction::graph_stats", graph_stats_);
 
     XFunction<MXFunction, MX, MXNode>::delayed_serialize_members(s);
   }
 
 
   MXFunction::MXFunction(DeserializingStream& s) : XFunction<MXFunction, MX, MXNode>(s) {
-    int version = s.version("MXFunction", 1, 2);
+    int version = s.version("MXFunction", 1, 6);
     size_t n_instructions;
     s.unpack("MXFunction::n_instr", n_instructions);
     algorithm_.resize(n_instructions);
@@ -1786,13 +2673,30 @@ namespace casadi {
     }
 
     s.unpack("MXFunction::workloc", workloc_);
+    if (version >= 5) s.unpack("MXFunction::workalias", workalias_);
     s.unpack("MXFunction::free_vars", free_vars_);
     s.unpack("MXFunction::default_in", default_in_);
     s.unpack("MXFunction::live_variables", live_variables_);
     print_instructions_ = false;
     if (version >= 2) s.unpack("MXFunction::print_instructions", print_instructions_);
 
+    eval_plan_ = true;
+    if (version >= 3) s.unpack("MXFunction::eval_plan", eval_plan_);
+
+    parallelization_ = "serial";
+    casadi_int n_region = 0;
+    if (version >= 4) {
+      s.unpack("MXFunction::parallelization", parallelization_);
+      s.unpack("MXFunction::par_n_region", n_region);
+    }
+    if (version >= 6) s.unpack("MXFunction::graph_stats", graph_stats_);
+
     XFunction<MXFunction, MX, MXNode>::delayed_deserialize_members(s);
+
+    init_incremental();
+    init_plan();
+    // Restricted to the scratch space allocated when the function was created
+    init_parallel(n_region);
   }
 
   ProtoFunction* MXFunction::deserialize(DeserializingStream& s) {
@@ -55,6 +55,42 @@ namespace casadi {
     /// Work vector indices of the results
     std::vector<casadi_int> res;
   };
+
+  /** \brief A step of the flattened evaluation plan of an MXFunction
+
+      The work vector offsets of the arguments and results of a node are stored
+      consecutively in the plan, a negative offset means that there is no argument
+      or result.
+  */
+  struct MXPlanStep {
+    /// Operator index
+    casadi_int op;
+
+    /// Node to be evaluated
+    const MXNode* node;
+
+    /// Position of the first argument and result in the pointer tables, number of each
+    casadi_int iarg, ires, n_arg, n_res;
+
+    /// Does the node use the pointer arrays beyond its arguments and results?
+    bool scratch;
+
+    /// OP_INPUT, OP_OUTPUT: input/output index, nonzero offset, number of nonzeros, location
+    casadi_int ind, offset, nnz, loc;
+  };
+
+  /** \brief Memory for MXFunction
+
+      Holds the pointer tables of the evaluation plan, resolved for the most recently
+      used work vector.
+  */
+  struct CASADI_EXPORT MXFunctionMemory : public XFunctionMemory {
+    // Pointers to the arguments and results of all nodes
+    std::vector<const double*> plan_arg;
+    std::vector<double*> plan_res;
+    // Work vector that the tables refer to
+    double* plan_w;
+  };
 #endif // SWIG
 
   /** \brief  Internal node class for MXFunction
@@ -81,6 +117,13 @@ namespace casadi {
         \identifier{21} */
     std::vector<casadi_int> workloc_;
 
+    /** \brief Element of the work vector that holds the data of each element
+
+        Reshapes and splits share the data of their argument, arguments of
+        concatenations may be placed in the result. Empty if there are no aliases.
+    */
+    std::vector<casadi_int> workalias_;
+
     /// Free variables
     std::vector<MX> free_vars_;
 
@@ -93,6 +136,36 @@ namespace casadi {
     /// Print instructions during evaluation
     bool print_instructions_;
 
+    /// Input nonzero groups that each element of the algorithm depends on (incremental evaluation)
+    std::vector<bvec_t> incr_mask_;
+
+    /// Evaluate using the flattened plan?
+    bool eval_plan_;
+
+    /// Flattened evaluation plan, one step per element of the algorithm
+    std::vector<MXPlanStep> plan_;
+
+    /// Work vector offsets of the arguments and results in the plan
+    std::vector<casadi_int> plan_arg_loc_, plan_res_loc_;
+
+    /// Evaluate independent function calls concurrently: "serial" or "thread"
+    std::string parallelization_;
+
+    /// Algorithm indices sorted by dependency level, if calls are evaluated in parallel
+    std::vector<casadi_int> par_order_;
+
+    /// Offsets of the stages in par_order_ and of the concurrent calls within each stage
+    std::vector<casadi_int> par_stage_, par_call_;
+
+    /// Number of scratch regions for concurrent calls
+    casadi_int par_n_region_;
+
+    /// Size of each scratch region
+    size_t par_sz_arg_, par_sz_res_, par_sz_iw_, par_sz_w_;
+
+    /// Statistics of the graph optimization passes applied before sorting
+    Dict graph_stats_;
+
     /** \brief Constructor
 
         \identifier{22} */
@@ -137,6 +210,13 @@ namespace casadi {
     /// Get all statistics
     Dict get_stats(void* mem) const override;
 
+    /** \brief Obtain information about the function
+
+        Reports the work vector savings from reuse and aliasing, the stages of
+        concurrent function calls and the effect of graph optimization passes, if any
+    */
+    Dict info() const override;
+
     /// Reconstruct options dict
     Dict generate_options(const std::string& target="clone") const override;
 
@@ -145,6 +225,56 @@ namespace casadi {
         \identifier{29} */
     void init(const Dict& opts) override;
 
+    /** \brief Rewrite expressions with a sequence of graph optimization passes
+
+        Each pass reevaluates the graph symbolically, rewriting the nodes it applies to.
+        Nodes that are no longer needed are dropped when the graph is sorted again.
+        The number of rewrites and remaining nodes after each pass are added to stats.
+    */
+    static std::vector<MX> optimize_graph(const std::vector<MX>& ex,
+      const std::vector<std::string>& passes, Dict& stats);
+
+    /** \brief Find the input dependencies of each node for incremental evaluation */
+    void init_incremental();
+
+    /** \brief Flatten the algorithm into an evaluation plan */
+    void init_plan();
+
+    /// Element of the work vector that holds the data of element i
+    casadi_int work_alias(casadi_int i) const { return workalias_.empty() ? i : workalias_[i];}
+
+    /** \brief Does an element of the algorithm only create views of its argument?
+
+        Such elements share the data of their argument and perform no work.
+    */
+    bool is_view(const AlgEl& e) const;
+
+    /** \brief Sort the algorithm into stages of concurrent function calls
+
+        Uses at most max_region scratch regions, i.e. concurrent tasks, per stage.
+    */
+    void init_parallel(casadi_int max_region);
+
+    /** \brief Evaluate the stages of concurrent function calls */
+    int eval_parallel(const double** arg, double** res, casadi_int* iw, double* w,
+      bool skip, bvec_t changed) const;
+
+    /** \brief Evaluate an element of the algorithm with given scratch space
+
+        The work vector locations refer to w, the node itself uses ws.
+    */
+    int eval_el(const AlgEl& e, const double** arg, double** res,
+      const double** arg1, double** res1, casadi_int* iw, double* w, double* ws) const;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new MXFunctionMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<MXFunctionMemory*>(mem);}
+
     /** \brief Generate code for the declarations of the C function
 
         \identifier{2a} */
@@ -223,6 +353,17 @@ namespace casadi {
         \identifier{2m} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+    /** \brief Is sparsity propagation with several bvec_t per nonzero supported natively? */
+    bool has_sp_wide() const override { return true;}
+
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+    int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+    int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
     // print an element of an algorithm
     std::string print(const AlgEl& el) const;
 
@@ -390,6 +390,87 @@ namespace casadi {
     return 0;
   }
 
+  int MXNode::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Narrow copies of the arguments and results
+    casadi_int n_arg = n_dep(), n_res = nout(), nnz_arg = 0, nnz_res = 0;
+    for (casadi_int k=0; k<n_arg; ++k) nnz_arg += dep(k).nnz();
+    for (casadi_int k=0; k<n_res; ++k) nnz_res += sparsity(k).nnz();
+    std::vector<bvec_t> buf(nnz_arg + nnz_res);
+    std::vector<const bvec_t*> arg1(std::max(sz_arg(), static_cast<size_t>(n_arg)), nullptr);
+    std::vector<bvec_t*> res1(std::max(sz_res(), static_cast<size_t>(n_res)), nullptr);
+    // Propagate one word at a time
+    for (casadi_int j=0; j<nw; ++j) {
+      bvec_t* b = get_ptr(buf);
+      for (casadi_int k=0; k<n_arg; ++k) {
+        casadi_int n = dep(k).nnz();
+        if (arg[k]) {
+          for (casadi_int i=0; i<n; ++i) b[i] = arg[k][i*nw+j];
+          arg1[k] = b;
+        }
+        b += n;
+      }
+      for (casadi_int k=0; k<n_res; ++k) {
+        if (res[k]) res1[k] = b;
+        b += sparsity(k).nnz();
+      }
+      if (sp_forward(get_ptr(arg1), get_ptr(res1), iw, w)) return 1;
+      for (casadi_int k=0; k<n_res; ++k) {
+        if (res[k]) {
+          casadi_int n = sparsity(k).nnz();
+          for (casadi_int i=0; i<n; ++i) res[k][i*nw+j] = res1[k][i];
+        }
+      }
+    }
+    return 0;
+  }
+
+  int MXNode::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Narrow copies of the arguments and results
+    casadi_int n_arg = n_dep(), n_res = nout(), nnz_arg = 0, nnz_res = 0;
+    for (casadi_int k=0; k<n_arg; ++k) nnz_arg += dep(k).nnz();
+    for (casadi_int k=0; k<n_res; ++k) nnz_res += sparsity(k).nnz();
+    std::vector<bvec_t> buf(nnz_arg + nnz_res);
+    std::vector<bvec_t*> arg1(std::max(sz_arg(), static_cast<size_t>(n_arg)), nullptr);
+    std::vector<bvec_t*> res1(std::max(sz_res(), static_cast<size_t>(n_res)), nullptr);
+    // Propagate one word at a time
+    for (casadi_int j=0; j<nw; ++j) {
+      bvec_t* b = get_ptr(buf);
+      for (casadi_int k=0; k<n_arg; ++k) {
+        casadi_int n = dep(k).nnz();
+        if (arg[k]) {
+          for (casadi_int i=0; i<n; ++i) b[i] = arg[k][i*nw+j];
+          arg1[k] = b;
+        }
+        b += n;
+      }
+      for (casadi_int k=0; k<n_res; ++k) {
+        casadi_int n = sparsity(k).nnz();
+        if (res[k]) {
+          for (casadi_int i=0; i<n; ++i) b[i] = res[k][i*nw+j];
+          res1[k] = b;
+        }
+        b += n;
+      }
+      if (sp_reverse(get_ptr(arg1), get_ptr(res1), iw, w)) return 1;
+      // Results first, arguments last: in-place operations share the location
+      for (casadi_int k=0; k<n_res; ++k) {
+        if (res[k]) {
+          casadi_int n = sparsity(k).nnz();
+          for (casadi_int i=0; i<n; ++i) res[k][i*nw+j] = res1[k][i];
+        }
+      }
+      for (casadi_int k=0; k<n_arg; ++k) {
+        if (arg[k]) {
+          casadi_int n = dep(k).nnz();
+          for (casadi_int i=0; i<n; ++i) arg[k][i*nw+j] = arg1[k][i];
+        }
+      }
+    }
+    return 0;
+  }
+
   MX MXNode::get_output(casadi_int oind) const {
     casadi_assert(oind==0, "Output index out of bounds");
     return shared_from_this<MX>();
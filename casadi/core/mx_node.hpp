@@ -179,6 +179,20 @@ namespace casadi {
         \identifier{1qz} */
     virtual int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const;
 
+    /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero
+
+        By default, sp_forward is called once per word. The work vector holds nw*sz_w()
+        elements. */
+    virtual int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero
+
+        By default, sp_reverse is called once per word. The work vector holds nw*sz_w()
+        elements. */
+    virtual int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const;
+
     /** \brief  Get the name
 
         \identifier{1r0} */
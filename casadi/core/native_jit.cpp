@@ -0,0 +1,381 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "native_jit.hpp"
+#include "calculus.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define CASADI_WITH_NATIVE_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace casadi {
+
+#ifdef CASADI_WITH_NATIVE_JIT
+  // Signature of an out-of-line elementary operation
+  typedef double (*native_fcn_t)(double x, double y);
+
+  // Out-of-line evaluation of an elementary operation
+  template<casadi_int I>
+  double native_call(double x, double y) {
+    double f;
+    BinaryOperation<I>::fcn(x, y, f);
+    return f;
+  }
+
+  // Used with CASADI_MATH_FUN_BUILTIN_GEN to look up the function pointer
+  template<casadi_int I>
+  struct NativeCall {
+    static void fcn(double x, double y, native_fcn_t& f, casadi_int n) {
+      f = native_call<I>;
+    }
+  };
+
+  // Function pointer for an elementary operation
+  native_fcn_t native_fcn(casadi_int op) {
+    native_fcn_t f = nullptr;
+    double dummy = 0;
+    switch (op) {
+      CASADI_MATH_FUN_BUILTIN_GEN(NativeCall, dummy, dummy, f, 0)
+    }
+    casadi_assert(f!=nullptr, "Unknown operation " + str(op));
+    return f;
+  }
+
+  // x86-64 instruction emitter with a cache of work vector elements in xmm registers
+  class NativeEmitter {
+  public:
+    NativeEmitter(size_t worksize) : slot_reg_(worksize, -1) {
+      std::fill(reg_slot_, reg_slot_+16, -1);
+      std::fill(reg_used_, reg_used_+16, 0);
+      clock_ = 0;
+    }
+
+    // Machine code
+    std::vector<unsigned char> code;
+
+    // Emit bytes
+    void b(unsigned char c) { code.push_back(c);}
+    void d32(casadi_int v) {
+      casadi_assert(v<=std::numeric_limits<int32_t>::max(), "Displacement overflow");
+      int32_t v32 = static_cast<int32_t>(v);
+      unsigned char* c = reinterpret_cast<unsigned char*>(&v32);
+      code.insert(code.end(), c, c+4);
+    }
+    void i64(uint64_t v) {
+      unsigned char* c = reinterpret_cast<unsigned char*>(&v);
+      code.insert(code.end(), c, c+8);
+    }
+
+    // Optional REX prefix for xmm operands
+    void rex(casadi_int reg, casadi_int rm) {
+      if (reg>=8 || rm>=8) b(0x40 | (reg>=8 ? 0x04 : 0) | (rm>=8 ? 0x01 : 0));
+    }
+
+    // SSE instruction with two xmm registers: op xmm_reg, xmm_rm
+    void sse_rr(unsigned char prefix, unsigned char op, casadi_int reg, casadi_int rm) {
+      b(prefix);
+      rex(reg, rm);
+      b(0x0F); b(op); b(0xC0 | (reg&7)<<3 | (rm&7));
+    }
+
+    // SSE instruction with memory operand [base+disp32], base is rax (0) or rbx (3)
+    void sse_rm(unsigned char prefix, unsigned char op, casadi_int reg, casadi_int base,
+        casadi_int disp) {
+      b(prefix);
+      rex(reg, 0);
+      b(0x0F); b(op); b(0x80 | (reg&7)<<3 | base);
+      d32(disp);
+    }
+
+    // Load and store to/from the work vector
+    void load_w(casadi_int reg, casadi_int slot) { sse_rm(0xF2, 0x10, reg, 3, 8*slot);}
+    void store_w(casadi_int reg, casadi_int slot) { sse_rm(0xF2, 0x11, reg, 3, 8*slot);}
+
+    // movapd xmm_dst, xmm_src
+    void mov_rr(casadi_int dst, casadi_int src) {
+      if (dst!=src) sse_rr(0x66, 0x28, dst, src);
+    }
+
+    // Load a 64-bit pattern into an xmm register, via rax
+    void mov_ri(casadi_int reg, uint64_t v) {
+      if (v==0) {
+        sse_rr(0x66, 0x57, reg, reg);  // xorpd
+      } else {
+        b(0x48); b(0xB8); i64(v);  // mov rax, imm64
+        b(0x66); b(0x48 | (reg>=8 ? 0x04 : 0)); b(0x0F); b(0x6E); b(0xC0 | (reg&7)<<3);
+      }
+    }
+    void mov_rd(casadi_int reg, double v) {
+      uint64_t bits;
+      std::memcpy(&bits, &v, sizeof(bits));
+      mov_ri(reg, bits);
+    }
+
+    // mov rax, [r12+disp32] (arg) or [r13+disp32] (res)
+    void load_arg(casadi_int i) { b(0x49); b(0x8B); b(0x84); b(0x24); d32(8*i);}
+    void load_res(casadi_int i) { b(0x49); b(0x8B); b(0x85); d32(8*i);}
+
+    // test rax, rax; jz <patched later>, returns position to patch
+    casadi_int jz_null() {
+      b(0x48); b(0x85); b(0xC0);
+      b(0x74); b(0);
+      return code.size();
+    }
+    void patch(casadi_int pos) {
+      casadi_int rel = code.size() - pos;
+      casadi_assert_dev(rel<128);
+      code[pos-1] = static_cast<unsigned char>(rel);
+    }
+
+    // Call a function pointer
+    void call(native_fcn_t f) {
+      b(0x48); b(0xB8); i64(reinterpret_cast<uint64_t>(f));  // mov rax, imm64
+      b(0xFF); b(0xD0);  // call rax
+      // All xmm registers are caller-saved
+      for (casadi_int r=0; r<16; ++r) unbind(r);
+    }
+
+    // Register holding a work vector element, loading it if needed
+    casadi_int get(casadi_int slot, casadi_int pin=-1) {
+      casadi_int r = slot_reg_[slot];
+      if (r<0) {
+        r = alloc(pin, -1);
+        load_w(r, slot);
+        bind(r, slot);
+      }
+      reg_used_[r] = ++clock_;
+      return r;
+    }
+
+    // Copy a work vector element to a given register
+    void get_to(casadi_int dst, casadi_int slot) {
+      casadi_int r = slot_reg_[slot];
+      if (r<0) {
+        load_w(dst, slot);
+      } else {
+        mov_rr(dst, r);
+      }
+    }
+
+    // Get a free cache register, excluding up to two registers in use
+    casadi_int alloc(casadi_int excl1, casadi_int excl2) {
+      casadi_int best = -1;
+      // xmm0 and xmm1 are scratch registers for calls
+      for (casadi_int r=2; r<16; ++r) {
+        if (r==excl1 || r==excl2) continue;
+        if (best<0 || reg_used_[r]<reg_used_[best]) best = r;
+        if (reg_slot_[r]<0) {
+          best = r;
+          break;
+        }
+      }
+      unbind(best);
+      return best;
+    }
+
+    // Store result held in a register and cache it
+    void set(casadi_int reg, casadi_int slot) {
+      store_w(reg, slot);
+      if (slot_reg_[slot]>=0) unbind(slot_reg_[slot]);
+      if (reg>=2) bind(reg, slot);
+    }
+
+  private:
+    void bind(casadi_int r, casadi_int slot) {
+      reg_slot_[r] = slot;
+      slot_reg_[slot] = r;
+      reg_used_[r] = ++clock_;
+    }
+    void unbind(casadi_int r) {
+      if (reg_slot_[r]>=0) slot_reg_[reg_slot_[r]] = -1;
+      reg_slot_[r] = -1;
+    }
+
+    // Register currently holding a work vector element, -1 if none
+    std::vector<casadi_int> slot_reg_;
+    // Work vector element currently held by a register, -1 if none
+    casadi_int reg_slot_[16];
+    // Time of last use of a register
+    casadi_int reg_used_[16];
+    casadi_int clock_;
+  };
+#endif // CASADI_WITH_NATIVE_JIT
+
+  bool NativeJit::is_supported() {
+#ifdef CASADI_WITH_NATIVE_JIT
+    return true;
+#else // CASADI_WITH_NATIVE_JIT
+    return false;
+#endif // CASADI_WITH_NATIVE_JIT
+  }
+
+  NativeJit::NativeJit(const std::vector<ScalarAtomic>& algorithm, size_t worksize)
+      : mem_(nullptr), mem_size_(0), code_size_(0), fcn_(nullptr) {
+#ifndef CASADI_WITH_NATIVE_JIT
+    casadi_error("Native code generation is only supported on x86-64");
+#else // CASADI_WITH_NATIVE_JIT
+    NativeEmitter g(worksize);
+
+    // Prologue: save callee-saved registers, r12=arg, r13=res, rbx=w
+    g.b(0x53);                              // push rbx
+    g.b(0x41); g.b(0x54);                   // push r12
+    g.b(0x41); g.b(0x55);                   // push r13
+    g.b(0x49); g.b(0x89); g.b(0xFC);        // mov r12, rdi
+    g.b(0x49); g.b(0x89); g.b(0xF5);        // mov r13, rsi
+    g.b(0x48); g.b(0x89); g.b(0xD3);        // mov rbx, rdx
+
+    for (auto&& e : algorithm) {
+      switch (e.op) {
+      case OP_CONST:
+        {
+          casadi_int r = g.alloc(-1, -1);
+          g.mov_rd(r, e.d);
+          g.set(r, e.i0);
+        }
+        break;
+      case OP_INPUT:
+        {
+          casadi_int r = g.alloc(-1, -1);
+          g.load_arg(e.i1);
+          g.sse_rr(0x66, 0x57, r, r);  // xorpd
+          casadi_int pos = g.jz_null();
+          g.sse_rm(0xF2, 0x10, r, 0, 8*e.i2);  // movsd r, [rax+disp32]
+          g.patch(pos);
+          g.set(r, e.i0);
+        }
+        break;
+      case OP_OUTPUT:
+        {
+          casadi_int x = g.get(e.i1);
+          g.load_res(e.i0);
+          casadi_int pos = g.jz_null();
+          g.sse_rm(0xF2, 0x11, x, 0, 8*e.i2);  // movsd [rax+disp32], x
+          g.patch(pos);
+        }
+        break;
+      case OP_ADD:
+      case OP_SUB:
+      case OP_MUL:
+      case OP_DIV:
+        {
+          casadi_int x = g.get(e.i1);
+          casadi_int y = g.get(e.i2, x);
+          casadi_int r = g.alloc(x, y);
+          g.mov_rr(r, x);
+          unsigned char op = e.op==OP_ADD ? 0x58 : e.op==OP_SUB ? 0x5C
+            : e.op==OP_MUL ? 0x59 : 0x5E;
+          g.sse_rr(0xF2, op, r, y);
+          g.set(r, e.i0);
+        }
+        break;
+      case OP_ASSIGN:
+      case OP_SQ:
+      case OP_TWICE:
+      case OP_SQRT:
+        {
+          casadi_int x = g.get(e.i1);
+          casadi_int r = g.alloc(x, -1);
+          if (e.op==OP_SQRT) {
+            g.sse_rr(0xF2, 0x51, r, x);  // sqrtsd
+          } else {
+            g.mov_rr(r, x);
+            if (e.op==OP_SQ) g.sse_rr(0xF2, 0x59, r, r);  // mulsd
+            if (e.op==OP_TWICE) g.sse_rr(0xF2, 0x58, r, r);  // addsd
+          }
+          g.set(r, e.i0);
+        }
+        break;
+      case OP_NEG:
+      case OP_FABS:
+        {
+          casadi_int x = g.get(e.i1);
+          casadi_int r = g.alloc(x, -1);
+          if (e.op==OP_NEG) {
+            g.mov_ri(0, 0x8000000000000000ull);
+            g.mov_rr(r, x);
+            g.sse_rr(0x66, 0x57, r, 0);  // xorpd
+          } else {
+            g.mov_ri(0, 0x7FFFFFFFFFFFFFFFull);
+            g.mov_rr(r, x);
+            g.sse_rr(0x66, 0x54, r, 0);  // andpd
+          }
+          g.set(r, e.i0);
+        }
+        break;
+      case OP_INV:
+        {
+          casadi_int x = g.get(e.i1);
+          casadi_int r = g.alloc(x, -1);
+          g.mov_rd(r, 1.);
+          g.sse_rr(0xF2, 0x5E, r, x);  // divsd
+          g.set(r, e.i0);
+        }
+        break;
+      default:
+        {
+          // Call out-of-line kernel
+          native_fcn_t f = native_fcn(e.op);
+          g.get_to(0, e.i1);
+          g.get_to(1, e.i2);
+          g.call(f);
+          g.set(0, e.i0);
+        }
+      }
+    }
+
+    // Epilogue
+    g.b(0x41); g.b(0x5D);                   // pop r13
+    g.b(0x41); g.b(0x5C);                   // pop r12
+    g.b(0x5B);                              // pop rbx
+    g.b(0xC3);                              // ret
+
+    // Copy to executable memory
+    code_size_ = g.code.size();
+    size_t page = sysconf(_SC_PAGESIZE);
+    mem_size_ = ((code_size_ + page - 1)/page)*page;
+    mem_ = mmap(nullptr, mem_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    casadi_assert(mem_!=MAP_FAILED, "Failed to allocate memory for native code");
+    std::memcpy(mem_, g.code.data(), code_size_);
+    if (mprotect(mem_, mem_size_, PROT_READ | PROT_EXEC)) {
+      munmap(mem_, mem_size_);
+      casadi_error("Failed to make native code executable");
+    }
+    fcn_ = reinterpret_cast<fcn_t>(mem_);
+#endif // CASADI_WITH_NATIVE_JIT
+  }
+
+  NativeJit::~NativeJit() {
+#ifdef CASADI_WITH_NATIVE_JIT
+    if (mem_) munmap(mem_, mem_size_);
+#endif // CASADI_WITH_NATIVE_JIT
+  }
+
+} // namespace casadi
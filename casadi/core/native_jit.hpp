@@ -0,0 +1,77 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_NATIVE_JIT_HPP
+#define CASADI_NATIVE_JIT_HPP
+
+#include "sx_function.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief In-memory translation of an SXFunction algorithm to x86-64 machine code
+   *
+   * The generated code has the signature
+   *   void (const double** arg, double** res, double* w)
+   * and follows the System V calling convention. Scalar SSE2 instructions are
+   * emitted for the elementary arithmetic, all other operations call into the
+   * casadi_math kernels. Work vector elements are cached in the xmm registers
+   * with a least-recently-used policy, using write-through stores so that
+   * evicting a register never requires a spill.
+   */
+  class CASADI_EXPORT NativeJit {
+  public:
+    /// Generate code for an algorithm with a given work vector size
+    NativeJit(const std::vector<ScalarAtomic>& algorithm, size_t worksize);
+
+    /// Destructor, releases the executable memory
+    ~NativeJit();
+
+    /// Is native code generation supported on this platform?
+    static bool is_supported();
+
+    /// Evaluate
+    void eval(const double** arg, double** res, double* w) const { fcn_(arg, res, w);}
+
+    /// Size of the generated code in bytes
+    size_t code_size() const { return code_size_;}
+
+  private:
+    /// Signature of the generated function
+    typedef void (*fcn_t)(const double** arg, double** res, double* w);
+
+    /// Executable memory
+    void* mem_;
+    size_t mem_size_, code_size_;
+
+    /// Entry point
+    fcn_t fcn_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NATIVE_JIT_HPP
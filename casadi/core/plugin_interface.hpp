@@ -31,6 +31,14 @@
 
 #include <stdlib.h>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
 /// \cond INTERNAL
 
 namespace casadi {
@@ -99,6 +107,14 @@ namespace casadi {
     /// Load and get the creator function
     static Plugin& getPlugin(const std::string& pname);
 
+#ifdef CASADI_WITH_THREAD
+    /// Guards the plugin registry, plugins may be requested from several threads
+    static std::recursive_mutex& plugin_mutex() {
+      static std::recursive_mutex mtx;
+      return mtx;
+    }
+#endif // CASADI_WITH_THREAD
+
     // Create solver instance
     template<class Problem>
       static Derived* instantiate(const std::string& fname,
@@ -127,6 +143,9 @@ namespace casadi {
 
   template<class Derived>
   bool PluginInterface<Derived>::has_plugin(const std::string& pname, bool verbose) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::recursive_mutex> lock(plugin_mutex());
+#endif // CASADI_WITH_THREAD
 
     // Quick return if available
     if (Derived::solvers_.find(pname) != Derived::solvers_.end()) {
@@ -195,6 +214,9 @@ namespace casadi {
   template<class Derived>
   typename PluginInterface<Derived>::Plugin
       PluginInterface<Derived>::load_plugin(const std::string& pname, bool register_plugin) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::recursive_mutex> lock(plugin_mutex());
+#endif // CASADI_WITH_THREAD
     // Issue warning and quick return if already loaded
     if (Derived::solvers_.find(pname) != Derived::solvers_.end()) {
       casadi_warning("PluginInterface: Solver " + pname + " is already in use. Ignored.");
@@ -255,6 +277,9 @@ namespace casadi {
 
   template<class Derived>
   void PluginInterface<Derived>::registerPlugin(const Plugin& plugin) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::recursive_mutex> lock(plugin_mutex());
+#endif // CASADI_WITH_THREAD
 
     // Check if the solver name is in use
     typename std::map<std::string, Plugin>::iterator it=Derived::solvers_.find(plugin.name);
@@ -268,6 +293,9 @@ namespace casadi {
   template<class Derived>
   typename PluginInterface<Derived>::Plugin&
   PluginInterface<Derived>::getPlugin(const std::string& pname) {
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::recursive_mutex> lock(plugin_mutex());
+#endif // CASADI_WITH_THREAD
 
     // Check if the solver has been loaded
     auto it=Derived::solvers_.find(pname);
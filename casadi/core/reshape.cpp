@@ -58,6 +58,18 @@ namespace casadi {
     return 0;
   }
 
+  int Reshape::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    copy_fwd(arg[0], res[0], nnz()*nw);
+    return 0;
+  }
+
+  int Reshape::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    copy_rev(arg[0], res[0], nnz()*nw);
+    return 0;
+  }
+
   std::string Reshape::disp(const std::vector<std::string>& arg) const {
     // For vectors, reshape is also a transpose
     if (dep().is_vector() && sparsity().is_vector()) {
@@ -58,6 +58,211 @@ void casadi_ldl(const casadi_int* sp_a, const T1* a,
   }
 }
 
+// SYMBOL "ldl_super_init"
+// Initialize the shared work vector of casadi_ldl_super_node
+// iw = [pinv (n), snode (n), head (nsuper), next (nsuper), lpos (nsuper)]
+inline
+void casadi_ldl_super_init(const casadi_int* p, const casadi_int* sn, casadi_int* iw) {
+  const casadi_int *super;
+  casadi_int n, nsuper, s, i, j;
+  casadi_int *pinv, *snode, *head;
+  n=sn[0]; nsuper=sn[1];
+  super=sn+2;
+  pinv=iw; snode=iw+n; head=iw+2*n;
+  // Inverse permutation, supernode of each column, empty update lists
+  for (i=0; i<n; ++i) pinv[p[i]] = i;
+  for (s=0; s<nsuper; ++s) {
+    for (j=super[s]; j<super[s+1]; ++j) snode[j] = s;
+    head[s] = -1;
+  }
+}
+
+// SYMBOL "ldl_super_link"
+// Add supernode t to the update list of the next supernode it updates, if before s_end
+inline
+void casadi_ldl_super_link(casadi_int t, casadi_int s_end, const casadi_int* sn, casadi_int* iw) {
+  const casadi_int *rowptr, *row_t;
+  casadi_int n, nsuper, k;
+  casadi_int *snode, *head, *next, *lpos;
+  n=sn[0]; nsuper=sn[1];
+  rowptr=sn+2+nsuper+1;
+  snode=iw+n; head=snode+n; next=head+nsuper; lpos=next+nsuper;
+  row_t=rowptr+2*(nsuper+1)+rowptr[t];
+  if (lpos[t]<rowptr[t+1]-rowptr[t]) {
+    k = snode[row_t[lpos[t]]];
+    if (k<s_end) {
+      next[t] = head[k];
+      head[k] = t;
+    }
+  }
+}
+
+// SYMBOL "ldl_super_node"
+// Factorize supernode s of casadi_ldl_super, all its descendants must be factorized
+// Supernodes that are done updating s are only linked to supernodes before s_end
+// Independent subtrees can be factorized concurrently, with their own upd and loc,
+// and linked to the top of the tree afterwards, cf. casadi_ldl_super_link
+// len[upd] >= max_s (rowptr[s+1]-rowptr[s]) * (super[s+1]-super[s]), len[loc] >= n
+template<typename T1>
+void casadi_ldl_super_node(casadi_int s, casadi_int s_end, const casadi_int* sp_a, const T1* a,
+                           T1* d, const casadi_int* p, const casadi_int* sn, T1* w, T1* upd,
+                           casadi_int* iw, casadi_int* loc) {
+  const casadi_int *a_colind, *a_row, *super, *rowptr, *nzptr, *row, *row_s, *row_t;
+  casadi_int n, nsuper, t, t_next, f, nr, nc, f_t, nr_t, nc_t, k0, k1, ldc, ld1, i, j, k, c, q, r;
+  casadi_int *pinv, *head, *next, *lpos;
+  T1 *x, *x1, *x_t, dj, v0, v1, v2, v3;
+  const T1 *l0, *l1, *l2, *l3;
+  // Extract sparsities
+  n=sn[0];
+  a_colind=sp_a+2; a_row=sp_a+2+n+1;
+  nsuper=sn[1];
+  super=sn+2; rowptr=super+nsuper+1; nzptr=rowptr+nsuper+1; row=nzptr+nsuper+1;
+  // Work vectors
+  pinv=iw; head=iw+2*n; next=head+nsuper; lpos=next+nsuper;
+  f=super[s]; nc=super[s+1]-f;
+  row_s=row+rowptr[s]; nr=rowptr[s+1]-rowptr[s];
+  x=w+nzptr[s];
+  // Position of each row in the block
+  for (k=0; k<nr; ++k) loc[row_s[k]] = k;
+  // Copy lower triangular entries of the permuted A to the block
+  for (k=0; k<nr*nc; ++k) x[k] = 0;
+  for (j=0; j<nc; ++j) {
+    c = p[f+j];
+    for (k=a_colind[c]; k<a_colind[c+1]; ++k) {
+      i = pinv[a_row[k]];
+      if (i>=f+j) x[loc[i] + j*nr] = a[k];
+    }
+  }
+  // Apply updates from descendants with rows f to f+nc-1
+  for (t=head[s]; t>=0; t=t_next) {
+    t_next = next[t];
+    f_t=super[t]; nc_t=super[t+1]-f_t;
+    row_t=row+rowptr[t]; nr_t=rowptr[t+1]-rowptr[t];
+    x_t=w+nzptr[t];
+    // Rows k0 to k1-1 of the descendant are columns of the supernode
+    k0 = lpos[t];
+    for (k1=k0; k1<nr_t && row_t[k1]<f+nc; ++k1) {}
+    // Update with L_t(k0:nr_t-1, :) * D_t * L_t(k0:k1-1, :)', lower trapezoid only
+    ldc = nr_t-k0;
+    if (loc[row_t[nr_t-1]]-loc[row_t[k0]]==ldc-1) {
+      // Rows are contiguous in the block: subtract in place
+      x1 = x + loc[row_t[k0]] + (row_t[k0]-f)*nr;
+      ld1 = nr;
+    } else {
+      // Otherwise update a dense buffer, added to the block below
+      x1 = upd;
+      ld1 = ldc;
+      for (k=0; k<ldc*(k1-k0); ++k) upd[k] = 0;
+    }
+    // Four columns of the descendant at a time
+    for (q=0; q<k1-k0; ++q) {
+      for (c=0; c+4<=nc_t; c+=4) {
+        l0 = x_t + k0 + c*nr_t;
+        l1 = l0 + nr_t;
+        l2 = l1 + nr_t;
+        l3 = l2 + nr_t;
+        v0 = d[f_t+c]*l0[q];
+        v1 = d[f_t+c+1]*l1[q];
+        v2 = d[f_t+c+2]*l2[q];
+        v3 = d[f_t+c+3]*l3[q];
+        for (r=q; r<ldc; ++r) x1[r + q*ld1] -= l0[r]*v0 + l1[r]*v1 + l2[r]*v2 + l3[r]*v3;
+      }
+      for (; c<nc_t; ++c) {
+        l0 = x_t + k0 + c*nr_t;
+        v0 = d[f_t+c]*l0[q];
+        for (r=q; r<ldc; ++r) x1[r + q*ld1] -= l0[r]*v0;
+      }
+    }
+    if (x1==upd) {
+      for (q=0; q<k1-k0; ++q) {
+        j = row_t[k0+q]-f;
+        for (r=q; r<ldc; ++r) x[loc[row_t[k0+r]] + j*nr] += upd[r + q*ldc];
+      }
+    }
+    // Move the descendant to the list of the next supernode it updates
+    lpos[t] = k1;
+    casadi_ldl_super_link(t, s_end, sn, iw);
+  }
+  // Dense LDL^T of the block, left-looking, four columns at a time
+  for (j=0; j<nc; ++j) {
+    x1 = x + j*nr;
+    for (k=0; k+4<=j; k+=4) {
+      l0 = x + k*nr;
+      l1 = l0 + nr;
+      l2 = l1 + nr;
+      l3 = l2 + nr;
+      v0 = d[f+k]*l0[j];
+      v1 = d[f+k+1]*l1[j];
+      v2 = d[f+k+2]*l2[j];
+      v3 = d[f+k+3]*l3[j];
+      for (i=j; i<nr; ++i) x1[i] -= l0[i]*v0 + l1[i]*v1 + l2[i]*v2 + l3[i]*v3;
+    }
+    for (; k<j; ++k) {
+      l0 = x + k*nr;
+      v0 = d[f+k]*l0[j];
+      for (i=j; i<nr; ++i) x1[i] -= l0[i]*v0;
+    }
+    dj = x1[j];
+    d[f+j] = dj;
+    for (i=j+1; i<nr; ++i) x1[i] /= dj;
+  }
+  // Add to the list of the first supernode it updates
+  lpos[s] = nc;
+  casadi_ldl_super_link(s, s_end, sn, iw);
+}
+
+// SYMBOL "ldl_super_lt"
+// Copy the strictly lower entries of the supernodes to L^T, skipping explicit zeros
+// of relaxed supernodes, len[iw] >= n
+template<typename T1>
+void casadi_ldl_super_lt(const casadi_int* sp_lt, T1* lt, const casadi_int* sn, const T1* w,
+                         casadi_int* iw) {
+  const casadi_int *lt_colind, *lt_row, *super, *rowptr, *nzptr, *row, *row_s;
+  casadi_int n, nsuper, s, f, nr, nc, i, j, k;
+  const T1 *x;
+  n=sp_lt[1];
+  lt_colind=sp_lt+2; lt_row=sp_lt+2+n+1;
+  nsuper=sn[1];
+  super=sn+2; rowptr=super+nsuper+1; nzptr=rowptr+nsuper+1; row=nzptr+nsuper+1;
+  // Rows of each column of L^T are visited in increasing order
+  for (i=0; i<n; ++i) iw[i] = lt_colind[i];
+  for (s=0; s<nsuper; ++s) {
+    f=super[s]; nc=super[s+1]-f;
+    row_s=row+rowptr[s]; nr=rowptr[s+1]-rowptr[s];
+    x=w+nzptr[s];
+    for (j=0; j<nc; ++j) {
+      for (k=j+1; k<nr; ++k) {
+        i = row_s[k];
+        if (iw[i]<lt_colind[i+1] && lt_row[iw[i]]==f+j) lt[iw[i]++] = x[k + j*nr];
+      }
+    }
+  }
+}
+
+// SYMBOL "ldl_super"
+// Supernodal, left-looking variant of casadi_ldl with the same result
+// Supernodes are factorized as dense blocks, updated by dense blocks of their descendants
+// sn = [n, nsuper, super, rowptr, nzptr, row], cf. Sparsity::ldl_supernodes
+// len[w] >= nzptr[nsuper] + max_s (rowptr[s+1]-rowptr[s]) * (super[s+1]-super[s])
+// len[iw] >= 3*n + 3*nsuper
+template<typename T1>
+void casadi_ldl_super(const casadi_int* sp_a, const T1* a, const casadi_int* sp_lt, T1* lt,
+                      T1* d, const casadi_int* p, const casadi_int* sn, T1* w, casadi_int* iw) {
+  casadi_int n, nsuper, s;
+  casadi_int *loc;
+  T1 *upd;
+  n=sn[0]; nsuper=sn[1];
+  // Work vectors
+  upd=w+sn[2+3*(nsuper+1)-1];
+  loc=iw+2*n+3*nsuper;
+  casadi_ldl_super_init(p, sn, iw);
+  // Loop over supernodes
+  for (s=0; s<nsuper; ++s) {
+    casadi_ldl_super_node(s, nsuper, sp_a, a, d, p, sn, w, upd, iw, loc);
+  }
+  casadi_ldl_super_lt(sp_lt, lt, sn, w, loc);
+}
+
 // SYMBOL "ldl_trs"
 // Solve for (I+R) with R an optionally transposed strictly upper triangular matrix.
 template<typename T1>
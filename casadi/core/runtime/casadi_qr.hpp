@@ -40,6 +40,51 @@ T1 casadi_house(T1* v, T1* beta, casadi_int nv) {
   return s;
 }
 
+// SYMBOL "qr_col"
+// Column c of the numeric QR factorization, cf. casadi_qr
+// Requires the columns of V in the pattern of R(:, c), i.e. its descendants in the
+// column elimination tree, so independent subtrees can be factorized concurrently
+// x must be zero on entry and is zero on exit, len[x] = nrow
+template<typename T1>
+void casadi_qr_col(casadi_int c, const casadi_int* sp_a, const T1* nz_a, T1* x,
+                   const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
+                   const casadi_int* prinv, const casadi_int* pc) {
+  // Local variables
+  casadi_int ncol, r, k, k1;
+  T1 alpha;
+  const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
+  // Extract sparsities
+  ncol = sp_a[1];
+  a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
+  v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
+  r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
+  nz_r += r_colind[c];
+  // Copy (permuted) column of A to x
+  for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
+  // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
+  // strictly upper triangular entries of R
+  for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
+    // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
+    alpha = 0;
+    for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
+    alpha *= beta[r];
+    // x -= alpha*v(:,r)
+    for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
+    // Get r entry
+    *nz_r++ = x[r];
+    // Strictly upper triangular entries in x no longer needed
+    x[r] = 0;
+  }
+  // Get V column
+  for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
+    nz_v[k] = x[v_row[k]];
+    // Lower triangular entries of x no longer needed
+    x[v_row[k]] = 0;
+  }
+  // Get diagonal entry of R, normalize V column
+  *nz_r = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+}
+
 // SYMBOL "qr"
 // Numeric QR factorization
 // Ref: Chapter 5, Direct Methods for Sparse Linear Systems by Tim Davis
@@ -54,43 +99,15 @@ void casadi_qr(const casadi_int* sp_a, const T1* nz_a, T1* x,
                const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
                const casadi_int* prinv, const casadi_int* pc) {
    // Local variables
-   casadi_int ncol, nrow, r, c, k, k1;
-   T1 alpha;
-   const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
+   casadi_int ncol, nrow, r, c;
    // Extract sparsities
    ncol = sp_a[1];
-   a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
    nrow = sp_v[0];
-   v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
-   r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
    // Clear work vector
    for (r=0; r<nrow; ++r) x[r] = 0;
    // Loop over columns of R, A and V
    for (c=0; c<ncol; ++c) {
-     // Copy (permuted) column of A to x
-     for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
-     // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
-     // strictly upper triangular entries of R
-     for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
-       // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
-       alpha = 0;
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
-       alpha *= beta[r];
-       // x -= alpha*v(:,r)
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
-       // Get r entry
-       *nz_r++ = x[r];
-       // Strictly upper triangular entries in x no longer needed
-       x[r] = 0;
-     }
-     // Get V column
-     for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
-       nz_v[k] = x[v_row[k]];
-       // Lower triangular entries of x no longer needed
-       x[v_row[k]] = 0;
-     }
-     // Get diagonal entry of R, normalize V column
-     *nz_r++ = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+     casadi_qr_col(c, sp_a, nz_a, x, sp_v, nz_v, sp_r, nz_r, beta, prinv, pc);
    }
  }
 
@@ -66,6 +66,20 @@ namespace casadi {
     return weak_ref_;
   }
 
+  bool SharedObjectInternal::try_count_up() {
+#ifdef CASADI_WITH_THREAD
+    casadi_int c = count.load();
+    while (c>0) {
+      if (count.compare_exchange_weak(c, c+1)) return true;
+    }
+    return false;
+#else // CASADI_WITH_THREAD
+    if (count==0) return false;
+    count++;
+    return true;
+#endif // CASADI_WITH_THREAD
+  }
+
   WeakRefInternal::WeakRefInternal(SharedObjectInternal* raw) : raw_(raw) {
   }
 
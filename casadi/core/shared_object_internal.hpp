@@ -68,6 +68,12 @@ namespace casadi {
         \identifier{1ai} */
     WeakRef* weak();
 
+    /** \brief Increase the reference count, unless it already dropped to zero
+
+        Allows recovering an object from a table of raw pointers while another
+        thread may be destroying it. Returns true if a reference was acquired. */
+    bool try_count_up();
+
   protected:
     /** Called in the constructor of singletons to avoid that the counter reaches zero */
     void initSingleton() {
@@ -520,11 +520,6 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
-  }
-
   const Sparsity& Sparsity::getScalar() {
     static ScalarSparsity ret;
     return ret;
@@ -618,15 +613,33 @@ namespace casadi {
   }
 
   Sparsity Sparsity::ldl(std::vector<casadi_int>& p, bool amd) const {
+    return ldl(p, std::string(amd ? "amd" : "none"));
+  }
+
+  Sparsity Sparsity::ldl(std::vector<casadi_int>& p, const std::string& ordering) const {
     casadi_assert(is_symmetric(),
                  "LDL factorization requires a symmetric matrix");
-    // Recursive call if AMD
-    if (amd) {
-      // Get AMD reordering
-      p = this->amd();
+    // Recursive call if reordering
+    if (ordering!="none") {
+      // Get fill-reducing reordering
+      if (ordering=="amd") {
+        p = this->amd();
+      } else if (ordering=="nested_dissection") {
+        p = nested_dissection();
+      } else {
+        casadi_error("Unknown ordering '" + ordering + "', "
+          "expected 'none', 'amd' or 'nested_dissection'");
+      }
       // Permute sparsity pattern
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(p, p, tmp);
+      // Postorder the elimination tree, same fill-in but contiguous supernodes
+      casadi_int n = size1();
+      std::vector<casadi_int> parent = Aperm.etree(), post(n), w(3*n);
+      SparsityInternal::postorder(get_ptr(parent), n, get_ptr(post), get_ptr(w));
+      for (casadi_int k=0; k<n; ++k) w[k] = p[post[k]];
+      std::copy(w.begin(), w.begin()+n, p.begin());
+      Aperm = sub(p, p, tmp);
       // Call recursively
       return Aperm.ldl(tmp, false);
     }
@@ -649,16 +662,40 @@ namespace casadi {
     return Sparsity(n, n, L_colind, L_row, true).T();
   }
 
+  std::vector<casadi_int> Sparsity::ldl_supernodes(bool relaxed) const {
+    return (*this)->ldl_supernodes(relaxed);
+  }
+
+  std::vector<casadi_int> Sparsity::etree_schedule(const std::vector<casadi_int>& parent,
+                                                   const std::vector<double>& work,
+                                                   casadi_int n_thread) {
+    return SparsityInternal::etree_schedule(parent, work, n_thread);
+  }
+
   void Sparsity::
   qr_sparse(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
             std::vector<casadi_int>& pc, bool amd) const {
+    qr_sparse(V, R, prinv, pc, std::string(amd ? "amd" : "none"));
+  }
+
+  void Sparsity::
+  qr_sparse(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
+            std::vector<casadi_int>& pc, const std::string& ordering) const {
     // Dimensions
     casadi_int size1=this->size1(), size2=this->size2();
 
-    // Recursive call if AMD
-    if (amd) {
-      // Get AMD reordering
-      pc = mtimes(T(), *this).amd();
+    // Recursive call if reordering
+    if (ordering!="none") {
+      // Get fill-reducing column reordering
+      Sparsity AtA = mtimes(T(), *this);
+      if (ordering=="amd") {
+        pc = AtA.amd();
+      } else if (ordering=="nested_dissection") {
+        pc = AtA.nested_dissection();
+      } else {
+        casadi_error("Unknown ordering '" + ordering + "', "
+          "expected 'none', 'amd' or 'nested_dissection'");
+      }
       // Permute sparsity pattern
       std::vector<casadi_int> tmp;
       Sparsity Aperm = sub(range(size1), pc, tmp);
@@ -707,6 +744,10 @@ namespace casadi {
     return (*this)->amd();
   }
 
+  std::vector<casadi_int> Sparsity::nested_dissection() const {
+    return (*this)->nested_dissection();
+  }
+
   casadi_int Sparsity::btf(std::vector<casadi_int>& rowperm, std::vector<casadi_int>& colperm,
                             std::vector<casadi_int>& rowblock, std::vector<casadi_int>& colblock,
                             std::vector<casadi_int>& coarse_rowblock,
@@ -745,11 +786,12 @@ namespace casadi {
     (*this)->get_nz(indices);
   }
 
-  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+                                  casadi_int ordering, casadi_int n_thread) const {
     if (AT.is_null()) {
-      return (*this)->uni_coloring(T(), cutoff);
+      return (*this)->uni_coloring(T(), cutoff, ordering, n_thread);
     } else {
-      return (*this)->uni_coloring(AT, cutoff);
+      return (*this)->uni_coloring(AT, cutoff, ordering, n_thread);
     }
   }
 
@@ -761,10 +803,34 @@ namespace casadi {
     return (*this)->star_coloring2(ordering, cutoff);
   }
 
+  Sparsity Sparsity::acyclic_coloring(casadi_int ordering, casadi_int cutoff) const {
+    return (*this)->acyclic_coloring(ordering, cutoff);
+  }
+
+  Sparsity Sparsity::distance2_coloring(casadi_int ordering, casadi_int cutoff,
+                                        casadi_int n_thread) const {
+    return (*this)->distance2_coloring(ordering, cutoff, n_thread);
+  }
+
+  Sparsity Sparsity::acyclic_recovery(const Sparsity& D, std::vector<casadi_int>& b_row,
+                                      std::vector<casadi_int>& b_color,
+                                      std::vector<casadi_int>& nz,
+                                      std::vector<casadi_int>& nz_tr) const {
+    return (*this)->acyclic_recovery(D, b_row, b_color, nz, nz_tr);
+  }
+
   std::vector<casadi_int> Sparsity::largest_first() const {
     return (*this)->largest_first();
   }
 
+  std::vector<casadi_int> Sparsity::smallest_last() const {
+    return (*this)->smallest_last();
+  }
+
+  std::vector<casadi_int> Sparsity::incidence_degree() const {
+    return (*this)->incidence_degree();
+  }
+
   Sparsity Sparsity::pmult(const std::vector<casadi_int>& p, bool permute_rows,
                             bool permute_columns, bool invert_permutation) const {
     return (*this)->pmult(p, permute_rows, permute_columns, invert_permutation);
@@ -872,92 +938,8 @@ namespace casadi {
     // Hash the pattern
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
-
-    // Record the current number of buckets (for garbage collection below)
-    casadi_int bucket_count_before = cache.bucket_count();
-
-    // WORKAROUND, functions do not appear to work when bucket_count==0
-    if (bucket_count_before>0) {
-
-      // Find the range of patterns equal to the key (normally only zero or one)
-      std::pair<CachingMap::iterator, CachingMap::iterator> eq = cache.equal_range(h);
-
-      // Loop over maching patterns
-      for (CachingMap::iterator i=eq.first; i!=eq.second; ++i) {
-
-        // Get a weak reference to the cached sparsity pattern
-        WeakRef& wref = i->second;
-
-        // Check if the pattern still exists
-        if (wref.alive()) {
-
-          // Get an owning reference to the cached pattern
-          Sparsity ref = shared_cast<Sparsity>(wref.shared());
-
-          // Check if the pattern matches
-          if (ref.is_equal(nrow, ncol, colind, row)) {
-
-            // Found match!
-            own(ref.get());
-            return;
-
-          } else { // There is a hash rowision (unlikely, but possible)
-            // Leave the pattern alone, continue to the next matching pattern
-            continue;
-          }
-        } else {
-
-          // Check if one of the other cache entries indeed has a matching sparsity
-          CachingMap::iterator j=i;
-          j++; // Start at the next matching key
-          for (; j!=eq.second; ++j) {
-            if (j->second.alive()) {
-
-              // Recover cached sparsity
-              Sparsity ref = shared_cast<Sparsity>(j->second.shared());
-
-              // Match found if sparsity matches
-              if (ref.is_equal(nrow, ncol, colind, row)) {
-                own(ref.get());
-                return;
-              }
-            }
-          }
-
-          // The cached entry has been deleted, create a new one
-          own(new SparsityInternal(nrow, ncol, colind, row));
-
-          // Cache this pattern
-          wref = *this;
-
-          // Return
-          return;
-        }
-      }
-    }
-
-    // No matching sparsity pattern could be found, create a new one
-    own(new SparsityInternal(nrow, ncol, colind, row));
-
-    // Cache this pattern
-    cache.insert(std::pair<std::size_t, WeakRef>(h, *this));
-
-    // Garbage collection (currently only supported for unordered_multimap)
-    casadi_int bucket_count_after = cache.bucket_count();
-
-    // We we increased the number of buckets, take time to garbage-collect deleted references
-    if (bucket_count_before!=bucket_count_after) {
-      CachingMap::const_iterator i=cache.begin();
-      while (i!=cache.end()) {
-        if (!i->second.alive()) {
-          i = cache.erase(i);
-        } else {
-          i++;
-        }
-      }
-    }
+    // Share the pattern with other expressions, creating it if not in use
+    *this = SparsityCache::instance().intern(nrow, ncol, colind, row, h);
   }
 
   Sparsity Sparsity::tril(const Sparsity& x, bool includeDiagonal) {
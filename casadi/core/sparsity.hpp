@@ -871,11 +871,6 @@ namespace casadi {
     void removeDuplicates(std::vector<casadi_int>& SWIG_INOUT(mapping));
 
 #ifndef SWIG
-    typedef std::unordered_multimap<std::size_t, WeakRef> CachingMap;
-
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
-
     /// (Dense) scalar
     static const Sparsity& getScalar();
 
@@ -909,9 +904,55 @@ namespace casadi {
         Copyright(c) Timothy A. Davis, 2005-2013
         Licensed as a derivative work under the GNU LGPL
 
+        With amd, an approximate minimum degree preordering is used.
+
         \identifier{d3} */
     Sparsity ldl(std::vector<casadi_int>& SWIG_OUTPUT(p), bool amd=true) const;
 
+    /** \brief Symbolic LDL factorization with a given preordering
+
+        Ordering options: "none", "amd" (approximate minimum degree) and
+        "nested_dissection". A fill-reducing ordering is postordered with respect to the
+        elimination tree, which leaves the fill-in unchanged and makes supernodes contiguous.
+    */
+    Sparsity ldl(std::vector<casadi_int>& SWIG_OUTPUT(p), const std::string& ordering) const;
+#ifndef SWIG
+    Sparsity ldl(std::vector<casadi_int>& p, const char* ordering) const {
+      return ldl(p, std::string(ordering));
+    }
+#endif // SWIG
+
+    /** \brief Supernodes of an LDL factorization
+
+        Called on the sparsity pattern of L^T, as returned by ldl. Fundamental
+        supernodes are chains of the elimination tree whose columns of L have
+        nested patterns, i.e. columns that can be factorized as one dense block.
+        Relaxed supernodes also merge chains whose patterns differ by a few entries,
+        which are then stored as explicit zeros.
+        The result is the input of casadi_ldl_super:
+        [n, nsuper, super (nsuper+1), rowptr (nsuper+1), nzptr (nsuper+1), row],
+        where supernode s spans columns super[s] to super[s+1]-1 of L, has the row
+        indices row[rowptr[s]] to row[rowptr[s+1]-1] and its dense, column major
+        block starts at offset nzptr[s].
+    */
+    std::vector<casadi_int> ldl_supernodes(bool relaxed=true) const;
+
+    /** \brief Distribute independent subtrees of an elimination tree over threads
+
+        parent is an elimination tree with parents after their children, as returned
+        by etree, and work an estimate of the cost of eliminating each node.
+        Subtrees with at most 1/(4*n_thread) of the total work are tasks that can be
+        processed concurrently, balanced over at most n_thread groups. The remaining
+        nodes, the top of the tree, are processed afterwards.
+        The result is [ngroup, gptr (ngroup+1), tptr (ntask+1), node, top], where group g
+        holds tasks gptr[g] to gptr[g+1]-1 and task t the nodes node[tptr[t]] to
+        node[tptr[t+1]-1] in increasing order, the last one being the root of the task.
+        Empty if there are fewer than two tasks.
+    */
+    static std::vector<casadi_int> etree_schedule(const std::vector<casadi_int>& parent,
+                                                  const std::vector<double>& work,
+                                                  casadi_int n_thread);
+
     /** \brief Symbolic QR factorization
 
         Returns the sparsity pattern of V (compact representation of Q) and R
@@ -920,11 +961,28 @@ namespace casadi {
         Copyright(c) Timothy A. Davis, 2006-2009
         Licensed as a derivative work under the GNU LGPL
 
+        With amd, an approximate minimum degree column preordering is used.
+
         \identifier{d4} */
     void qr_sparse(Sparsity& SWIG_OUTPUT(V), Sparsity& SWIG_OUTPUT(R),
                    std::vector<casadi_int>& SWIG_OUTPUT(prinv),
                    std::vector<casadi_int>& SWIG_OUTPUT(pc), bool amd=true) const;
 
+    /** \brief Symbolic QR factorization with a given column preordering
+
+        Ordering options: "none", "amd" (approximate minimum degree) and
+        "nested_dissection", the latter two of the pattern of A'*A
+    */
+    void qr_sparse(Sparsity& SWIG_OUTPUT(V), Sparsity& SWIG_OUTPUT(R),
+                   std::vector<casadi_int>& SWIG_OUTPUT(prinv),
+                   std::vector<casadi_int>& SWIG_OUTPUT(pc), const std::string& ordering) const;
+#ifndef SWIG
+    void qr_sparse(Sparsity& V, Sparsity& R, std::vector<casadi_int>& prinv,
+                   std::vector<casadi_int>& pc, const char* ordering) const {
+      qr_sparse(V, R, prinv, pc, std::string(ordering));
+    }
+#endif // SWIG
+
     /** \brief Depth-first search on the adjacency graph of the sparsity
 
         See Direct Methods for Sparse Linear Systems by Davis (2006).
@@ -1002,6 +1060,20 @@ namespace casadi {
         \identifier{d8} */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Nested dissection preordering
+
+      Fill-reducing ordering applied to the sparsity pattern of a linear system
+      prior to factorization, an alternative to amd for patterns from discretized
+      PDEs and long horizon optimal control problems, with a balanced elimination tree.
+      The adjacency graph is split recursively by multilevel vertex separators, the
+      separators are ordered last. The parts and separators are ordered by minimum
+      degree, constrained to this dissection. On small patterns and on long, narrow ones,
+      amd may give less fill-in, but a less balanced elimination tree.
+      The system must be symmetric, for an unsymmetric matrix A, first form the square
+      of the pattern, A'*A.
+    */
+    std::vector<casadi_int> nested_dissection() const;
+
 #ifndef SWIG
     /** \brief Propagate sparsity through a linear solve
 
@@ -1031,9 +1103,17 @@ namespace casadi {
 
         (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
 
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3), all of the column intersection graph.
+        With n_thread>1, the coloring is speculative and parallel (A. H. GEBREMEDHIN, F. MANNE,
+        Concurrency: Practice and Experience, 2000). Conflicts are resolved in favor of the
+        column that comes first, so the result only depends on n_thread, not on timing.
+        It may need a few more colors than the sequential coloring.
+
         \identifier{db} */
     Sparsity uni_coloring(const Sparsity& AT=Sparsity(),
-                          casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
+                          casadi_int cutoff = std::numeric_limits<casadi_int>::max(),
+                          casadi_int ordering=0, casadi_int n_thread=1) const;
 
     /** \brief Perform a star coloring of a symmetric matrix:
 
@@ -1043,7 +1123,7 @@ namespace casadi {
           A. H. GEBREMEDHIN, F. MANNE, A. POTHEN
           SIAM Rev., 47(4), 629–705 (2006)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2), incidence degree (3)
 
         \identifier{dc} */
     Sparsity star_coloring(casadi_int ordering = 1,
@@ -1057,17 +1137,70 @@ namespace casadi {
           A. H. GEBREMEDHIN, A. TARAFDAR, F. MANNE, A. POTHEN
           SIAM J. SCI. COMPUT. Vol. 29, No. 3, pp. 1042–1072 (2007)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2), incidence degree (3)
 
         \identifier{dd} */
     Sparsity star_coloring2(casadi_int ordering = 1,
                             casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
 
+    /** \brief Perform an acyclic coloring of a symmetric matrix:
+
+        A greedy distance-1 coloring where every cycle uses at least three colors.
+        Needs at most as many colors as a star coloring, but off-diagonal entries
+        must be recovered by substitution, see acyclic_recovery. As proposed in
+          NEW ACYCLIC AND STAR COLORING ALGORITHMS WITH APPLICATION TO COMPUTING HESSIANS
+          A. H. GEBREMEDHIN, A. TARAFDAR, F. MANNE, A. POTHEN
+          SIAM J. SCI. COMPUT. Vol. 29, No. 3, pp. 1042–1072 (2007)
+
+        Ordering options: None (0), largest first (1), smallest last (2), incidence degree (3)
+    */
+    Sparsity acyclic_coloring(casadi_int ordering = 1,
+                              casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
+
+    /** \brief Perform a distance-2 coloring of a symmetric matrix:
+
+        Columns at most a distance 2 apart get different colors, which makes it a
+        star coloring too. Needs more colors than star_coloring in general, but the
+        coloring can be carried out in parallel, see uni_coloring.
+
+        Ordering options: None (0), largest first (1), smallest last (2), incidence degree (3)
+    */
+    Sparsity distance2_coloring(casadi_int ordering = 1,
+                                casadi_int cutoff = std::numeric_limits<casadi_int>::max(),
+                                casadi_int n_thread=1) const;
+
+#ifndef SWIG
+    /** \brief Recover a symmetric matrix compressed with an acyclic coloring D
+
+        The two-colored subgraphs of an acyclic coloring are forests. With B the product of
+        the matrix with the seed matrix D, the off-diagonal entries h are the solution of the
+        unit lower triangular system M*h = b returned, where entry k of b is the entry of B in
+        row b_row[k] and column b_color[k]. Entry k of h is nonzero nz[k] of the matrix, as well
+        as its transpose nz_tr[k]. A diagonal entry i is the entry of B in row i and the
+        column of the color of i.
+
+        M is the identity if and only if D is also a star coloring.
+    */
+    Sparsity acyclic_recovery(const Sparsity& D, std::vector<casadi_int>& b_row,
+                              std::vector<casadi_int>& b_color, std::vector<casadi_int>& nz,
+                              std::vector<casadi_int>& nz_tr) const;
+#endif // SWIG
+
     /** \brief Order the columns by decreasing degree
 
         \identifier{de} */
     std::vector<casadi_int> largest_first() const;
 
+    /** \brief Order the columns of a symmetric matrix by repeatedly removing
+        a column of smallest degree, the ordering is the reverse of the removal
+    */
+    std::vector<casadi_int> smallest_last() const;
+
+    /** \brief Order the columns of a symmetric matrix by repeatedly picking
+        the column with the most already ordered neighbors
+    */
+    std::vector<casadi_int> incidence_degree() const;
+
     /** \brief Permute rows and/or columns
 
         Multiply the sparsity with a permutation matrix from the left and/or from the right
@@ -27,7 +27,19 @@
 #include "sparsity_internal.hpp"
 #include "casadi_misc.hpp"
 #include "global_options.hpp"
+#include "thread_pool.hpp"
 #include <climits>
+#include <unordered_map>
+#include <queue>
+#include <random>
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
 #include <cstdlib>
 #include <cmath>
 
@@ -124,6 +136,81 @@ namespace casadi {
     }
   }
 
+  std::vector<casadi_int> SparsityInternal::
+  etree_schedule(const std::vector<casadi_int>& parent, const std::vector<double>& work,
+                 casadi_int n_thread) {
+    casadi_int n = parent.size();
+    casadi_assert_dev(work.size()==n);
+    if (n_thread<2) return {};
+    // Work of each subtree, children come before their parents
+    std::vector<double> sw = work;
+    double total = 0;
+    for (casadi_int s=0; s<n; ++s) {
+      if (parent[s]<0) {
+        total += sw[s];
+      } else {
+        casadi_assert(parent[s]>s, "Parents must come after their children");
+        sw[parent[s]] += sw[s];
+      }
+    }
+    // Root of the task of each node, -1 for the top of the tree
+    double max_task = total/static_cast<double>(4*n_thread);
+    std::vector<casadi_int> task(n), roots;
+    for (casadi_int s=n-1; s>=0; --s) {
+      if (sw[s]>max_task) {
+        task[s] = -1;
+      } else if (parent[s]<0 || task[parent[s]]<0) {
+        task[s] = s;
+        roots.push_back(s);
+      } else {
+        task[s] = task[parent[s]];
+      }
+    }
+    if (roots.size()<2) return {};
+    // Largest task first to the group with the least work
+    std::stable_sort(roots.begin(), roots.end(),
+      [&](casadi_int a, casadi_int b) { return sw[a]>sw[b];});
+    casadi_int ngroup = std::min(n_thread, static_cast<casadi_int>(roots.size()));
+    std::vector<double> load(ngroup, 0);
+    std::vector<std::vector<casadi_int> > group_roots(ngroup);
+    for (casadi_int r : roots) {
+      casadi_int g = std::min_element(load.begin(), load.end()) - load.begin();
+      load[g] += sw[r];
+      group_roots[g].push_back(r);
+    }
+    // Task index of each root, tasks of a group in increasing order
+    std::vector<casadi_int> ret = {ngroup, 0};
+    std::vector<casadi_int> tind(n, -1), tsize;
+    for (auto& gr : group_roots) {
+      std::sort(gr.begin(), gr.end());
+      for (casadi_int r : gr) {
+        tind[r] = tsize.size();
+        tsize.push_back(0);
+      }
+      ret.push_back(tsize.size());
+    }
+    // Number of nodes in each task
+    for (casadi_int s=0; s<n; ++s) {
+      if (task[s]>=0) tsize[tind[task[s]]]++;
+    }
+    casadi_int ntask = tsize.size(), tptr_off = ret.size();
+    ret.push_back(0);
+    for (casadi_int t=0; t<ntask; ++t) ret.push_back(ret.back() + tsize[t]);
+    // Nodes of each task and top of the tree, in increasing order
+    casadi_int node_off = ret.size();
+    ret.resize(node_off + n);
+    std::vector<casadi_int> pos(ret.begin()+tptr_off, ret.begin()+tptr_off+ntask);
+    casadi_int top = node_off + ret[tptr_off+ntask];
+    for (casadi_int s=0; s<n; ++s) {
+      if (task[s]>=0) {
+        ret[node_off + pos[tind[task[s]]]++] = s;
+      } else {
+        ret[top++] = s;
+      }
+    }
+    return ret;
+  }
+
   casadi_int SparsityInternal::
   leaf(casadi_int i, casadi_int j, const casadi_int* first, casadi_int* maxfirst,
        casadi_int* prevleaf, casadi_int* ancestor, casadi_int* jleaf) {
@@ -446,10 +533,83 @@ namespace casadi {
     }
   }
 
+  std::vector<casadi_int> SparsityInternal::ldl_supernodes(bool relaxed) const {
+    casadi_assert(is_triu(true), "Expecting the strictly upper triangular pattern of L^T");
+    casadi_int n = size2();
+    // Column c of L^T is row c of L, transpose to get the columns of L
+    Sparsity L = T();
+    const casadi_int *l_colind = L.colind(), *l_row = L.row();
+    // Elimination tree: the parent of j is the first off-diagonal row of L(:, j)
+    std::vector<casadi_int> parent(n, -1), nchild(n, 0);
+    for (casadi_int j=0; j<n; ++j) {
+      if (l_colind[j]<l_colind[j+1]) {
+        parent[j] = l_row[l_colind[j]];
+        nchild[parent[j]]++;
+      }
+    }
+    // Column j joins the supernode of j-1 if j is the only child of j-1 and
+    // the pattern of L(:, j-1) is j followed by the pattern of L(:, j)
+    std::vector<casadi_int> super(1, 0);
+    for (casadi_int j=1; j<n; ++j) {
+      if (parent[j-1]!=j || nchild[j]!=1
+          || l_colind[j]-l_colind[j-1]!=l_colind[j+1]-l_colind[j]+1) {
+        super.push_back(j);
+      }
+    }
+    if (n>0) super.push_back(n);
+    casadi_int nsuper = super.size()-1;
+    // Relaxed supernodes: merge a supernode into the next one if the latter starts with
+    // the parent of its last column and the number of explicit zeros introduced is small
+    if (relaxed && nsuper>1) {
+      std::vector<casadi_int> rsuper(1, 0);
+      casadi_int nc = 0, nz = 0;
+      for (casadi_int s=0; s<nsuper; ++s) {
+        // Supernode s: columns, rows and nonzeros of the lower triangular block
+        casadi_int nc_s = super[s+1]-super[s];
+        casadi_int nr_s = nc_s + l_colind[super[s+1]]-l_colind[super[s+1]-1];
+        casadi_int nz_s = nc_s + l_colind[super[s+1]]-l_colind[super[s]];
+        if (nc>0 && parent[super[s]-1]==super[s]) {
+          // Merged block, the rows of the current supernode are columns or rows of s
+          casadi_int nc_m = nc + nc_s, nr_m = nc + nr_s, nz_m = nz + nz_s;
+          casadi_int total = nc_m*nr_m - nc_m*(nc_m-1)/2;
+          double zeros = static_cast<double>(total - nz_m)/static_cast<double>(total);
+          if ((nc_m<=16 && zeros<0.3) || (nc_m<=48 && zeros<0.1) || zeros<0.05) {
+            nc = nc_m;
+            nz = nz_m;
+            continue;
+          }
+        }
+        // Start a new supernode
+        if (nc>0) rsuper.push_back(super[s]);
+        nc = nc_s;
+        nz = nz_s;
+      }
+      rsuper.push_back(n);
+      super = rsuper;
+      nsuper = super.size()-1;
+    }
+    // Row indices: the columns of the supernode followed by those of its last column
+    std::vector<casadi_int> rowptr(1, 0), nzptr(1, 0), row;
+    for (casadi_int s=0; s<nsuper; ++s) {
+      casadi_int last = super[s+1]-1;
+      for (casadi_int j=super[s]; j<=last; ++j) row.push_back(j);
+      row.insert(row.end(), l_row+l_colind[last], l_row+l_colind[last+1]);
+      rowptr.push_back(row.size());
+      nzptr.push_back(nzptr.back() + (rowptr[s+1]-rowptr[s])*(super[s+1]-super[s]));
+    }
+    // Assemble
+    std::vector<casadi_int> ret = {n, nsuper};
+    ret.insert(ret.end(), super.begin(), super.end());
+    ret.insert(ret.end(), rowptr.begin(), rowptr.end());
+    ret.insert(ret.end(), nzptr.begin(), nzptr.end());
+    ret.insert(ret.end(), row.begin(), row.end());
+    return ret;
+  }
+
   SparsityInternal::
   SparsityInternal(casadi_int nrow, casadi_int ncol,
       const casadi_int* colind, const casadi_int* row) :
-    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr) {
+    sp_(2 + ncol+1 + colind[ncol]), btf_(nullptr), cached_(false), hash_(0) {
     sp_[0] = nrow;
     sp_[1] = ncol;
     std::copy(colind, colind+ncol+1, sp_.begin()+2);
@@ -457,14 +617,96 @@ namespace casadi {
   }
 
   SparsityInternal::~SparsityInternal() {
+    if (cached_) SparsityCache::instance().erase(this);
     delete btf_;
   }
 
+  struct SparsityCache::Shard {
+#ifdef CASADI_WITH_THREAD
+    std::mutex mtx;
+#endif // CASADI_WITH_THREAD
+    std::unordered_multimap<std::size_t, SparsityInternal*> map;
+  };
+
+  SparsityCache::SparsityCache() {
+    shards_.resize(n_shards);
+    for (auto&& s : shards_) s = new Shard();
+  }
+
+  SparsityCache& SparsityCache::instance() {
+    // Never destroyed: patterns may outlive static destruction of this unit
+    static SparsityCache* cache = new SparsityCache();
+    return *cache;
+  }
+
+  SparsityCache::Shard& SparsityCache::shard(std::size_t h) {
+    // Mix the high bits in, the low bits select the bucket within the shard
+    return *shards_[(h ^ (h >> 29) ^ (h >> 47)) % n_shards];
+  }
+
+  Sparsity SparsityCache::intern(casadi_int nrow, casadi_int ncol,
+      const casadi_int* colind, const casadi_int* row, std::size_t h) {
+    Shard& s = shard(h);
+    Sparsity ret;
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(s.mtx);
+#endif // CASADI_WITH_THREAD
+    // Look for a matching pattern that is still alive
+    auto eq = s.map.equal_range(h);
+    for (auto i=eq.first; i!=eq.second; ++i) {
+      SparsityInternal* sp = i->second;
+      // Entries being destroyed wait for the lock to unregister, skip them
+      if (sp->is_equal(nrow, ncol, colind, row) && sp->try_count_up()) {
+        ret.assign(sp);
+        return ret;
+      }
+    }
+    // Create and register a new pattern
+    SparsityInternal* sp = new SparsityInternal(nrow, ncol, colind, row);
+    sp->cached_ = true;
+    sp->hash_ = h;
+    ret.own(sp);
+    s.map.insert(std::make_pair(h, sp));
+    return ret;
+  }
+
+  void SparsityCache::erase(SparsityInternal* sp) {
+    Shard& s = shard(sp->hash_);
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(s.mtx);
+#endif // CASADI_WITH_THREAD
+    auto eq = s.map.equal_range(sp->hash_);
+    for (auto i=eq.first; i!=eq.second; ++i) {
+      if (i->second==sp) {
+        s.map.erase(i);
+        return;
+      }
+    }
+  }
+
+  casadi_int SparsityCache::size() {
+    casadi_int n = 0;
+    for (auto&& s : shards_) {
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(s->mtx);
+#endif // CASADI_WITH_THREAD
+      n += s->map.size();
+    }
+    return n;
+  }
+
   const SparsityInternal::Btf& SparsityInternal::btf() const {
     if (!btf_) {
-      btf_ = new SparsityInternal::Btf();
-      btf_->nb = btf(btf_->rowperm, btf_->colperm, btf_->rowblock, btf_->colblock,
-                     btf_->coarse_rowblock, btf_->coarse_colblock);
+      Btf* b = new SparsityInternal::Btf();
+      b->nb = btf(b->rowperm, b->colperm, b->rowblock, b->colblock,
+                  b->coarse_rowblock, b->coarse_colblock);
+#ifdef CASADI_WITH_THREAD
+      // The pattern may be shared between threads, keep the first result
+      Btf* expected = nullptr;
+      if (!btf_.compare_exchange_strong(expected, b)) delete b;
+#else // CASADI_WITH_THREAD
+      btf_ = b;
+#endif // CASADI_WITH_THREAD
     }
     return *btf_;
   }
@@ -654,6 +896,10 @@ namespace casadi {
   }
 
   std::vector<casadi_int> SparsityInternal::amd() const {
+    return amd(std::vector<casadi_int>());
+  }
+
+  std::vector<casadi_int> SparsityInternal::amd(const std::vector<casadi_int>& cons) const {
     /*
     Modified version of cs_amd in CSparse
     Copyright(c) Timothy A. Davis, 2006-2009
@@ -662,6 +908,8 @@ namespace casadi {
     casadi_assert(is_symmetric(), "AMD requires a symmetric matrix");
     // Get sparsity
     casadi_int n=size2();
+    casadi_assert(cons.empty() || cons.size()==n,
+      "Constraint sets must have length " + str(n) + ", got " + str(cons.size()));
     std::vector<casadi_int> colind = get_colind();
     std::vector<casadi_int> row = get_row();
     // Drop diagonal entries
@@ -690,6 +938,23 @@ namespace casadi {
                 w(n+1), hhead(n+1);
     // Number of elements
     casadi_int nel = 0;
+    // Constraint sets, eliminated one after the other
+    bool has_cons = !cons.empty();
+    casadi_int ns = 0;
+    for (casadi_int c : cons) {
+      casadi_assert(c>=0, "Constraint sets must be nonnegative");
+      ns = std::max(ns, c+1);
+    }
+    // Nodes of each set and the number of them not yet eliminated
+    std::vector<casadi_int> cptr(ns+1, 0), cnode(cons.size()), cleft(ns);
+    for (casadi_int c : cons) cptr[c+1]++;
+    for (casadi_int c=0; c<ns; ++c) cptr[c+1] += cptr[c];
+    std::copy(cptr.begin(), cptr.end()-1, cleft.begin());
+    for (casadi_int i=0; i<cons.size(); ++i) cnode[cleft[cons[i]]++] = i;
+    for (casadi_int c=0; c<ns; ++c) cleft[c] = cptr[c+1] - cptr[c];
+    // Current set, only its nodes are candidates for pivots
+    casadi_int cur = 0;
+    #define ACTIVE(i) (!has_cons || cons[i] == cur)
     // Minimal degree
     casadi_int mindeg = 0;
     // Maximum length of w
@@ -701,7 +966,7 @@ namespace casadi {
     // Flip
     #define FLIP(i) (-(i)-2)
     // Elbow room
-    //casadi_int t = nnz + nnz/5 + 2*n;
+    row.resize(nnz + nnz/5 + 2*n);
     // Initialize quotient graph
     for (casadi_int k = 0; k<n; ++k) len[k] = colind[k+1] - colind[k];
     len[n] = 0;
@@ -726,21 +991,38 @@ namespace casadi {
       if (d == 0) {                        // node i is empty
         elen[i] = -2;                      // element i is dead
         nel++;
+        if (has_cons) cleft[cons[i]]--;
         colind[i] = -1;                    // i is a root of assembly tree
         w[i] = 0;
       } else if (d > dense) {              // node i is dense
         nv[i] = 0;                         // absorb i into element n
         elen[i] = -1;                      // node i is dead
         nel++;
+        if (has_cons) cleft[cons[i]]--;
         colind[i] = FLIP(n);
         nv[n]++;
-      } else {
+      } else if (ACTIVE(i)) {
         if (head[d] != -1) P[head[d]] = i;
         next[i] = head[d];                 // put node i in degree list d
         head[d] = i;
       }
     }
     while (nel < n) {                        // while (selecting pivots) do
+      // Move on to the next set once the current one has been eliminated
+      if (has_cons && cleft[cur] == 0) {
+        while (cleft[cur] == 0) cur++;
+        mindeg = n;
+        for (casadi_int q = cptr[cur]; q < cptr[cur+1]; q++) {
+          casadi_int i = cnode[q];
+          if (nv[i] <= 0 || elen[i] < 0) continue; // skip if dead or an element
+          d = degree[i];
+          if (head[d] != -1) P[head[d]] = i;
+          next[i] = head[d];               // put node i in degree list d
+          P[i] = -1;
+          head[d] = i;
+          mindeg = std::min(mindeg, d);
+        }
+      }
       // Select node of minimum approximate degree
       casadi_int k;
       for (k = -1; mindeg < n && (k = head[mindeg]) == -1; mindeg++) {}
@@ -749,6 +1031,7 @@ namespace casadi {
       casadi_int elenk = elen[k];             // elenk = |Ek|
       casadi_int nvk = nv[k];                     // # of nodes k represents
       nel += nvk;                      // nv[k] nodes of A eliminated
+      if (has_cons) cleft[cur] -= nvk;
       // Garbage collection
       if (elenk > 0 && nnz + mindeg >= nzmax) {
         for (casadi_int j = 0; j < n; j++) {
@@ -793,6 +1076,7 @@ namespace casadi {
           dk += nvi;                 // degree[Lk] += size of node i
           nv[i] = -nvi;              // negate nv[i] to denote i in Lk
           row[pk2++] = i;            // place i in Lk
+          if (!ACTIVE(i)) continue;  // i is not in a degree list
           if (next[i] != -1) P[next[i]] = P[i];
           if (P[i] != -1) {          // remove i from degree list
             next[P[i]] = next[i];
@@ -858,12 +1142,13 @@ namespace casadi {
           row[pn++] = j;             // place j in node list of i
           h += j;                    // compute hash for node i
         }
-        if (d == 0) {                    // check for mass elimination
+        if (d == 0 && ACTIVE(i)) {       // check for mass elimination
           colind[i] = FLIP(k);      // absorb i into k
           casadi_int nvi = -nv[i];
           dk -= nvi;                 // |Lk| -= |i|
           nvk += nvi;                // |k| += nv[i]
           nel += nvi;
+          if (has_cons) cleft[cur] -= nvi;
           nv[i] = 0;
           elen[i] = -1;             // node i is dead
         } else {
@@ -894,7 +1179,8 @@ namespace casadi {
           for (p = colind[i]+1; p <= colind[i] + ln-1; p++) w[row[p]] = mark;
           casadi_int jlast = i;
           for (casadi_int j = next[i]; j != -1; ) { // compare i with all j
-            casadi_int ok = (len[j] == ln) && (elen[j] == eln);
+            casadi_int ok = (len[j] == ln) && (elen[j] == eln)
+              && (!has_cons || cons[i] == cons[j]);
             for (p = colind[j] + 1; ok && p <= colind[j] + ln - 1; p++) {
               if (w[row[p]] != mark) ok = 0; // compare i and j
             }
@@ -921,13 +1207,14 @@ namespace casadi {
         nv[i] = nvi;                      // restore nv[i]
         d = degree[i] + dk - nvi;         // compute external degree(i)
         d = std::min(d, n - nel - nvi);
+        degree[i] = d;
+        row[p++] = i;                    // place i in Lk
+        if (!ACTIVE(i)) continue;        // not in a degree list yet
         if (head[d] != -1) P[head[d]] = i;
         next[i] = head[d];               // put i back in degree list
         P[i] = -1;
         head[d] = i;
         mindeg = std::min(mindeg, d);    // find new minimum degree
-        degree[i] = d;
-        row[p++] = i;                    // place i in Lk
       }
       nv[k] = nvk;                      // # nodes absorbed into k
       if ((len[k] = p-pk1) == 0) {      // length of adj list of element k
@@ -957,9 +1244,569 @@ namespace casadi {
     }
     P.resize(n);
     return P;
+    #undef ACTIVE
     #undef FLIP
   }
 
+  std::vector<casadi_int> SparsityInternal::nested_dissection(casadi_int leaf_size) const {
+    casadi_assert(is_symmetric(), "Nested dissection requires a symmetric matrix");
+    casadi_assert(leaf_size>=1, "Leaf size must be positive");
+    casadi_int n = size2();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Adjacency graph, diagonal entries dropped
+    std::vector<casadi_int> xadj(n+1, 0), adj;
+    adj.reserve(nnz());
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        if (row[el]!=c) adj.push_back(row[el]);
+      }
+      xadj[c+1] = adj.size();
+    }
+
+    // Dissect recursively, then order by minimum degree within the dissection
+    std::vector<casadi_int> loc(n, -1), cons(n);
+    casadi_int nset = 0;
+    nd_order(xadj, adj, range(n), leaf_size, loc, cons, nset);
+    return amd(cons);
+  }
+
+  void SparsityInternal::nd_order(const std::vector<casadi_int>& xadj,
+                                  const std::vector<casadi_int>& adj,
+                                  const std::vector<casadi_int>& verts, casadi_int leaf_size,
+                                  std::vector<casadi_int>& loc, std::vector<casadi_int>& cons,
+                                  casadi_int& nset) {
+    casadi_int nv = verts.size();
+    if (nv==0) return;
+
+    // Small parts are leaves, ordered by minimum degree only
+    if (nv<=leaf_size) {
+      for (casadi_int v : verts) cons[v] = nset;
+      nset++;
+      return;
+    }
+
+    // Induced subgraph with local numbering, rows remain sorted as verts is sorted
+    for (casadi_int k=0; k<nv; ++k) loc[verts[k]] = k;
+    std::vector<casadi_int> sxadj(nv+1, 0), sadj;
+    for (casadi_int k=0; k<nv; ++k) {
+      casadi_int v = verts[k];
+      for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+        casadi_int w = loc[adj[el]];
+        if (w>=0) sadj.push_back(w);
+      }
+      sxadj[k+1] = sadj.size();
+    }
+    for (casadi_int k=0; k<nv; ++k) loc[verts[k]] = -1;
+
+    // Connected components
+    std::vector<casadi_int> comp(nv, -1), comp_size;
+    for (casadi_int k=0; k<nv; ++k) {
+      if (comp[k]>=0) continue;
+      casadi_int c = comp_size.size();
+      std::vector<casadi_int> queue(1, k);
+      comp[k] = c;
+      for (casadi_int q=0; q<queue.size(); ++q) {
+        for (casadi_int el=sxadj[queue[q]]; el<sxadj[queue[q]+1]; ++el) {
+          if (comp[sadj[el]]<0) {
+            comp[sadj[el]] = c;
+            queue.push_back(sadj[el]);
+          }
+        }
+      }
+      comp_size.push_back(queue.size());
+    }
+
+    if (comp_size.size()>1) {
+      // Large components are dissected separately, small ones are ordered together
+      std::vector<std::vector<casadi_int> > cverts(comp_size.size());
+      std::vector<casadi_int> small;
+      for (casadi_int k=0; k<nv; ++k) {
+        if (comp_size[comp[k]]>leaf_size) {
+          cverts[comp[k]].push_back(verts[k]);
+        } else {
+          small.push_back(verts[k]);
+        }
+      }
+      for (auto& cv : cverts) nd_order(xadj, adj, cv, leaf_size, loc, cons, nset);
+      nd_order(xadj, adj, small, std::max(leaf_size, casadi_int(small.size())), loc, cons,
+               nset);
+      return;
+    }
+
+    // Split into two parts and a separator, which is eliminated last
+    std::vector<casadi_int> part = nd_separator(sxadj, sadj, std::vector<casadi_int>(sadj.size(), 1),
+                                                std::vector<casadi_int>(nv, 1));
+    std::vector<casadi_int> v0, v1, vs;
+    for (casadi_int k=0; k<nv; ++k) {
+      if (part[k]==0) {
+        v0.push_back(verts[k]);
+      } else if (part[k]==1) {
+        v1.push_back(verts[k]);
+      } else {
+        vs.push_back(verts[k]);
+      }
+    }
+    if (!v0.empty() && !v1.empty()) {
+      nd_order(xadj, adj, v0, leaf_size, loc, cons, nset);
+      nd_order(xadj, adj, v1, leaf_size, loc, cons, nset);
+      for (casadi_int v : vs) cons[v] = nset;
+      nset++;
+      return;
+    }
+
+    // Not separable: a leaf
+    for (casadi_int v : verts) cons[v] = nset;
+    nset++;
+  }
+
+  std::vector<casadi_int> SparsityInternal::nd_separator(const std::vector<casadi_int>& xadj,
+                                                         const std::vector<casadi_int>& adj,
+                                                         const std::vector<casadi_int>& adjwgt,
+                                                         const std::vector<casadi_int>& vwgt) {
+    casadi_int n = vwgt.size();
+
+    // Separator of a coarsened graph, projected and refined
+    if (n>64) {
+      std::vector<casadi_int> cmap, cxadj, cadj, cadjwgt, cvwgt;
+      nd_coarsen(xadj, adj, adjwgt, vwgt, cmap, cxadj, cadj, cadjwgt, cvwgt);
+      if (10*static_cast<casadi_int>(cvwgt.size())<9*n) {
+        std::vector<casadi_int> cwhere = nd_separator(cxadj, cadj, cadjwgt, cvwgt);
+        std::vector<casadi_int> where(n);
+        for (casadi_int v=0; v<n; ++v) where[v] = cwhere[cmap[v]];
+        nd_refine_separator(xadj, adj, vwgt, where);
+        return where;
+      }
+    }
+
+    // Edge separator of the coarsest graph
+    std::vector<casadi_int> where = nd_bisect(xadj, adj, adjwgt, vwgt);
+
+    // Maximum matching on the bipartite graph of the cut edges, by augmenting paths
+    std::vector<casadi_int> mate(n, -1), pred(n, -1), visited(n, -1), queue;
+    for (casadi_int u=0; u<n; ++u) {
+      if (where[u]!=0) continue;
+      queue.assign(1, u);
+      for (casadi_int q=0; q<queue.size(); ++q) {
+        casadi_int x = queue[q];
+        bool found = false;
+        for (casadi_int el=xadj[x]; el<xadj[x+1]; ++el) {
+          casadi_int y = adj[el];
+          if (where[y]==0 || visited[y]==u) continue;
+          visited[y] = u;
+          pred[y] = x;
+          if (mate[y]<0) {
+            // Augment along the path
+            while (y>=0) {
+              casadi_int x_prev = pred[y], y_next = mate[x_prev];
+              mate[y] = x_prev;
+              mate[x_prev] = y;
+              y = y_next;
+            }
+            found = true;
+            break;
+          }
+          queue.push_back(mate[y]);
+        }
+        if (found) break;
+      }
+    }
+
+    // Vertices reachable by alternating paths from unmatched vertices of part 0 (Konig)
+    std::vector<bool> reached(n, false);
+    queue.clear();
+    for (casadi_int u=0; u<n; ++u) {
+      if (where[u]==0 && mate[u]<0) {
+        reached[u] = true;
+        queue.push_back(u);
+      }
+    }
+    for (casadi_int q=0; q<queue.size(); ++q) {
+      casadi_int x = queue[q];
+      for (casadi_int el=xadj[x]; el<xadj[x+1]; ++el) {
+        casadi_int y = adj[el];
+        if (where[y]==0 || y==mate[x] || reached[y]) continue;
+        reached[y] = true;
+        if (mate[y]>=0 && !reached[mate[y]]) {
+          reached[mate[y]] = true;
+          queue.push_back(mate[y]);
+        }
+      }
+    }
+
+    // The minimum vertex cover of the cut edges is the separator
+    for (casadi_int u=0; u<n; ++u) {
+      bool cut = false;
+      for (casadi_int el=xadj[u]; el<xadj[u+1] && !cut; ++el) cut = where[adj[el]]!=where[u];
+      if (!cut) continue;
+      if (where[u]==0 ? !reached[u] : reached[u]) where[u] = 2;
+    }
+    nd_refine_separator(xadj, adj, vwgt, where);
+    return where;
+  }
+
+  std::vector<casadi_int> SparsityInternal::nd_bisect(const std::vector<casadi_int>& xadj,
+                                                      const std::vector<casadi_int>& adj,
+                                                      const std::vector<casadi_int>& adjwgt,
+                                                      const std::vector<casadi_int>& vwgt) {
+    casadi_int n = vwgt.size();
+
+    // Grow a part by breadth-first search from a few starting vertices, keep the best
+    casadi_int total = 0;
+    for (casadi_int w : vwgt) total += w;
+    std::vector<casadi_int> where, best_where;
+    casadi_int best_cut = -1, seed = 0;
+    for (casadi_int trial=0; trial<4; ++trial) {
+      where.assign(n, 1);
+      std::vector<casadi_int> queue(1, seed);
+      std::vector<bool> queued(n, false);
+      queued[seed] = true;
+      casadi_int w0 = 0;
+      for (casadi_int q=0; q<queue.size(); ++q) {
+        casadi_int v = queue[q];
+        if (2*w0<total) {
+          where[v] = 0;
+          w0 += vwgt[v];
+        }
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          if (!queued[adj[el]]) {
+            queued[adj[el]] = true;
+            queue.push_back(adj[el]);
+          }
+        }
+      }
+      nd_refine(xadj, adj, adjwgt, vwgt, where);
+      casadi_int cut = 0;
+      for (casadi_int v=0; v<n; ++v) {
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          if (where[adj[el]]!=where[v]) cut += adjwgt[el];
+        }
+      }
+      if (best_cut<0 || cut<best_cut) {
+        best_cut = cut;
+        best_where = where;
+      }
+      // Next start: the last vertex reached, far away from the current one
+      seed = queue.back();
+    }
+    return best_where;
+  }
+
+  void SparsityInternal::nd_coarsen(const std::vector<casadi_int>& xadj,
+                                    const std::vector<casadi_int>& adj,
+                                    const std::vector<casadi_int>& adjwgt,
+                                    const std::vector<casadi_int>& vwgt,
+                                    std::vector<casadi_int>& cmap, std::vector<casadi_int>& cxadj,
+                                    std::vector<casadi_int>& cadj,
+                                    std::vector<casadi_int>& cadjwgt,
+                                    std::vector<casadi_int>& cvwgt) {
+    casadi_int n = vwgt.size();
+
+    // Visit the vertices in a reproducible pseudo-random order
+    std::vector<casadi_int> order = range(n);
+    std::minstd_rand gen(n);
+    for (casadi_int k=n-1; k>0; --k) std::swap(order[k], order[gen() % (k+1)]);
+
+    // Heavy edge matching
+    std::vector<casadi_int> match(n, -1);
+    for (casadi_int v : order) {
+      if (match[v]>=0) continue;
+      casadi_int best = v, best_wgt = -1;
+      for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+        casadi_int u = adj[el];
+        if (match[u]<0 && u!=v && adjwgt[el]>best_wgt) {
+          best = u;
+          best_wgt = adjwgt[el];
+        }
+      }
+      match[v] = best;
+      match[best] = v;
+    }
+
+    // Matched pairs become coarse vertices
+    cmap.assign(n, -1);
+    std::vector<casadi_int> rep;
+    for (casadi_int v=0; v<n; ++v) {
+      if (cmap[v]>=0) continue;
+      cmap[v] = cmap[match[v]] = rep.size();
+      rep.push_back(v);
+    }
+    casadi_int cn = rep.size();
+
+    // Coarse graph, merging parallel edges
+    cxadj.assign(cn+1, 0);
+    cadj.clear();
+    cadjwgt.clear();
+    cvwgt.assign(cn, 0);
+    std::vector<casadi_int> pos(cn, -1);
+    for (casadi_int c=0; c<cn; ++c) {
+      casadi_int start = cadj.size();
+      casadi_int v1 = rep[c], v2 = match[v1];
+      for (casadi_int v : {v1, v2}) {
+        cvwgt[c] += vwgt[v];
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          casadi_int cu = cmap[adj[el]];
+          if (cu==c) continue;
+          if (pos[cu]<0) {
+            pos[cu] = cadj.size();
+            cadj.push_back(cu);
+            cadjwgt.push_back(adjwgt[el]);
+          } else {
+            cadjwgt[pos[cu]] += adjwgt[el];
+          }
+        }
+        if (v1==v2) break;
+      }
+      for (casadi_int el=start; el<cadj.size(); ++el) pos[cadj[el]] = -1;
+      cxadj[c+1] = cadj.size();
+    }
+  }
+
+  void SparsityInternal::nd_refine(const std::vector<casadi_int>& xadj,
+                                   const std::vector<casadi_int>& adj,
+                                   const std::vector<casadi_int>& adjwgt,
+                                   const std::vector<casadi_int>& vwgt,
+                                   std::vector<casadi_int>& where) {
+    casadi_int n = vwgt.size();
+
+    // Part weights, a part may exceed half the total weight by 10% or one vertex
+    casadi_int pw[2] = {0, 0}, max_vwgt = 0;
+    for (casadi_int v=0; v<n; ++v) {
+      pw[where[v]] += vwgt[v];
+      max_vwgt = std::max(max_vwgt, vwgt[v]);
+    }
+    casadi_int total = pw[0] + pw[1];
+    casadi_int max_pw = std::max((11*total+19)/20, (total+1)/2 + max_vwgt);
+
+    // Internal and external degree of each vertex
+    std::vector<casadi_int> id(n), ed(n), moved;
+    std::vector<bool> locked(n);
+    for (casadi_int pass=0; pass<10; ++pass) {
+      casadi_int cut = 0;
+      for (casadi_int v=0; v<n; ++v) {
+        id[v] = ed[v] = 0;
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          (where[adj[el]]==where[v] ? id[v] : ed[v]) += adjwgt[el];
+        }
+        cut += ed[v];
+      }
+      cut /= 2;
+
+      // Boundary vertices by decreasing gain, entries are checked when popped
+      std::priority_queue<std::pair<casadi_int, casadi_int> > queue[2];
+      for (casadi_int v=0; v<n; ++v) {
+        if (ed[v]>0) queue[where[v]].push(std::make_pair(ed[v]-id[v], v));
+      }
+
+      // Fiduccia-Mattheyses: move the best vertex, keep the best state seen
+      std::fill(locked.begin(), locked.end(), false);
+      moved.clear();
+      casadi_int best_excess = std::max(casadi_int(0), std::max(pw[0], pw[1])-max_pw);
+      casadi_int best_cut = cut, best_moved = 0;
+      casadi_int max_bad = std::max(casadi_int(50), n/50);
+      while (true) {
+        // Candidate of each part, if it can be moved
+        casadi_int cand[2] = {-1, -1};
+        for (casadi_int s=0; s<2; ++s) {
+          while (!queue[s].empty()) {
+            casadi_int v = queue[s].top().second;
+            if (!locked[v] && where[v]==s && queue[s].top().first==ed[v]-id[v]) break;
+            queue[s].pop();
+          }
+          if (queue[s].empty()) continue;
+          casadi_int v = queue[s].top().second;
+          if (pw[1-s]+vwgt[v]<=max_pw || pw[s]>max_pw) cand[s] = v;
+        }
+
+        // Restore the balance first, else take the largest gain
+        casadi_int from;
+        if (pw[0]>max_pw && cand[0]>=0) {
+          from = 0;
+        } else if (pw[1]>max_pw && cand[1]>=0) {
+          from = 1;
+        } else if (cand[0]>=0 && cand[1]>=0) {
+          casadi_int g0 = ed[cand[0]]-id[cand[0]], g1 = ed[cand[1]]-id[cand[1]];
+          from = g0>g1 || (g0==g1 && pw[0]>=pw[1]) ? 0 : 1;
+        } else if (cand[0]>=0) {
+          from = 0;
+        } else if (cand[1]>=0) {
+          from = 1;
+        } else {
+          break;
+        }
+
+        // Move the vertex
+        casadi_int v = cand[from], to = 1-from;
+        queue[from].pop();
+        cut -= ed[v]-id[v];
+        pw[from] -= vwgt[v];
+        pw[to] += vwgt[v];
+        where[v] = to;
+        std::swap(id[v], ed[v]);
+        locked[v] = true;
+        moved.push_back(v);
+
+        // Update the neighbors
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          casadi_int u = adj[el];
+          if (where[u]==to) {
+            id[u] += adjwgt[el];
+            ed[u] -= adjwgt[el];
+          } else {
+            id[u] -= adjwgt[el];
+            ed[u] += adjwgt[el];
+          }
+          if (!locked[u] && ed[u]>0) queue[where[u]].push(std::make_pair(ed[u]-id[u], u));
+        }
+
+        // Best state: balanced first, then smallest cut
+        casadi_int excess = std::max(casadi_int(0), std::max(pw[0], pw[1])-max_pw);
+        if (excess<best_excess || (excess==best_excess && cut<best_cut)) {
+          best_excess = excess;
+          best_cut = cut;
+          best_moved = moved.size();
+        } else if (static_cast<casadi_int>(moved.size())-best_moved>max_bad) {
+          break;
+        }
+      }
+
+      // Undo the moves after the best state
+      for (casadi_int k=moved.size()-1; k>=best_moved; --k) {
+        casadi_int v = moved[k];
+        pw[where[v]] -= vwgt[v];
+        where[v] = 1-where[v];
+        pw[where[v]] += vwgt[v];
+      }
+
+      // Stop if no improvement
+      if (best_moved==0) break;
+    }
+  }
+
+  void SparsityInternal::nd_refine_separator(const std::vector<casadi_int>& xadj,
+                                             const std::vector<casadi_int>& adj,
+                                             const std::vector<casadi_int>& vwgt,
+                                             std::vector<casadi_int>& where) {
+    casadi_int n = vwgt.size();
+
+    // Part and separator weights, a part may exceed half the total weight by 10% or one vertex
+    casadi_int pw[3] = {0, 0, 0}, max_vwgt = 0;
+    for (casadi_int v=0; v<n; ++v) {
+      pw[where[v]] += vwgt[v];
+      max_vwgt = std::max(max_vwgt, vwgt[v]);
+    }
+    casadi_int total = pw[0] + pw[1] + pw[2];
+    casadi_int max_pw = std::max((11*total+19)/20, (total+1)/2 + max_vwgt);
+
+    // Decrease of the separator weight when moving separator vertex v into part s:
+    // v leaves the separator, its neighbors in the other part enter it
+    auto gain = [&](casadi_int v, casadi_int s) {
+      casadi_int g = vwgt[v];
+      for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+        if (where[adj[el]]==1-s) g -= vwgt[adj[el]];
+      }
+      return g;
+    };
+
+    // Moved vertices with their previous part, for undoing
+    std::vector<std::pair<casadi_int, casadi_int> > moved;
+    std::vector<bool> locked(n);
+    for (casadi_int pass=0; pass<10; ++pass) {
+      // Separator vertices by decreasing gain, entries are checked when popped
+      std::priority_queue<std::pair<casadi_int, casadi_int> > queue[2];
+      for (casadi_int v=0; v<n; ++v) {
+        if (where[v]!=2) continue;
+        for (casadi_int s=0; s<2; ++s) queue[s].push(std::make_pair(gain(v, s), v));
+      }
+
+      // Fiduccia-Mattheyses: move the best vertex, keep the best state seen
+      std::fill(locked.begin(), locked.end(), false);
+      moved.clear();
+      casadi_int best_sep = pw[2], best_imbalance = std::abs(pw[0]-pw[1]);
+      casadi_int n_moves = 0, best_moves = 0, best_moved = 0;
+      casadi_int max_bad = std::max(casadi_int(50), n/50);
+      while (true) {
+        // Candidate for each part, if the part does not get too heavy
+        casadi_int cand[2] = {-1, -1}, cand_gain[2] = {0, 0};
+        for (casadi_int s=0; s<2; ++s) {
+          while (!queue[s].empty()) {
+            casadi_int v = queue[s].top().second;
+            if (!locked[v] && where[v]==2 && queue[s].top().first==gain(v, s)) break;
+            queue[s].pop();
+          }
+          if (queue[s].empty()) continue;
+          casadi_int v = queue[s].top().second;
+          if (pw[s]+vwgt[v]<=max_pw) {
+            cand[s] = v;
+            cand_gain[s] = queue[s].top().first;
+          }
+        }
+
+        // Largest gain, else into the lighter part
+        casadi_int to;
+        if (cand[0]>=0 && cand[1]>=0) {
+          to = cand_gain[0]>cand_gain[1] || (cand_gain[0]==cand_gain[1] && pw[0]<=pw[1]) ? 0 : 1;
+        } else if (cand[0]>=0) {
+          to = 0;
+        } else if (cand[1]>=0) {
+          to = 1;
+        } else {
+          break;
+        }
+
+        // Move the vertex into the part, its neighbors in the other part into the separator
+        casadi_int v = cand[to], from = 1-to;
+        queue[to].pop();
+        moved.push_back(std::make_pair(v, 2));
+        where[v] = to;
+        pw[2] -= vwgt[v];
+        pw[to] += vwgt[v];
+        locked[v] = true;
+        n_moves++;
+        for (casadi_int el=xadj[v]; el<xadj[v+1]; ++el) {
+          casadi_int u = adj[el];
+          if (where[u]==from) {
+            moved.push_back(std::make_pair(u, from));
+            where[u] = 2;
+            pw[from] -= vwgt[u];
+            pw[2] += vwgt[u];
+            for (casadi_int s=0; s<2; ++s) queue[s].push(std::make_pair(gain(u, s), u));
+            // Separator neighbors of u have one neighbor less in the other part
+            for (casadi_int el2=xadj[u]; el2<xadj[u+1]; ++el2) {
+              casadi_int w = adj[el2];
+              if (where[w]==2 && !locked[w]) queue[to].push(std::make_pair(gain(w, to), w));
+            }
+          } else if (where[u]==2 && !locked[u]) {
+            queue[from].push(std::make_pair(gain(u, from), u));
+          }
+        }
+
+        // Best state: smallest separator, then best balance
+        casadi_int imbalance = std::abs(pw[0]-pw[1]);
+        if (pw[2]<best_sep || (pw[2]==best_sep && imbalance<best_imbalance)) {
+          best_sep = pw[2];
+          best_imbalance = imbalance;
+          best_moves = n_moves;
+          best_moved = moved.size();
+        } else if (n_moves-best_moves>max_bad) {
+          break;
+        }
+      }
+
+      // Undo the moves after the best state
+      for (casadi_int k=moved.size()-1; k>=best_moved; --k) {
+        casadi_int v = moved[k].first;
+        pw[where[v]] -= vwgt[v];
+        where[v] = moved[k].second;
+        pw[where[v]] += vwgt[v];
+      }
+
+      // Stop if no improvement
+      if (best_moved==0) break;
+    }
+  }
+
   void SparsityInternal::bfs(casadi_int n, std::vector<casadi_int>& wi, std::vector<casadi_int>& wj,
                               std::vector<casadi_int>& queue, const std::vector<casadi_int>& imatch,
                               const std::vector<casadi_int>& jmatch, casadi_int mark) const {
@@ -2944,7 +3791,25 @@ namespace casadi {
     std::fill(it, indices.end(), -1);
   }
 
-  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+                                          casadi_int ordering, casadi_int n_thread) const {
+    // Reorder, if necessary
+    if (ordering!=0) {
+      // Ordering of the column intersection graph
+      Sparsity G = AT->_mtimes(shared_from_this<Sparsity>());
+      std::vector<casadi_int> ord = G->coloring_ordering(ordering);
+
+      // Coloring of the matrix with permuted columns
+      Sparsity ret_permuted = pmult(ord, false, true, true)
+        .uni_coloring(AT.pmult(ord, true, false, true), cutoff, 0, n_thread);
+      if (ret_permuted.is_null()) return ret_permuted;
+
+      // Permute result back
+      return ret_permuted.pmult(ord, true, false, false);
+    }
+
+    // Speculative parallel coloring
+    if (n_thread>1) return uni_coloring_parallel(AT, cutoff, n_thread);
 
     // Allocate temporary vectors
     std::vector<casadi_int> forbiddenColors;
@@ -3033,6 +3898,128 @@ namespace casadi {
 ;
   }
 
+  Sparsity SparsityInternal::uni_coloring_parallel(const Sparsity& AT, casadi_int cutoff,
+                                                   casadi_int n_thread) const {
+    casadi_int n = size2();
+    const casadi_int* AT_colind = AT.colind();
+    const casadi_int* AT_row = AT.row();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Color of each column, -1 if not colored
+    std::vector<casadi_int> color(n, -1);
+
+    // Colors at the start of the current round
+    std::vector<casadi_int> color_prev;
+
+    // Position in the current round, -1 if not in the round
+    std::vector<casadi_int> rank(n, -1);
+
+    // Block coloring each column in the current round, -1 if not in the round
+    std::vector<casadi_int> owner(n, -1);
+
+    // Forbidden colors and columns to be recolored, per block
+    std::vector<std::vector<casadi_int> > forbidden(n_thread), conflicts(n_thread);
+
+    // Number of colors of the columns that are done
+    casadi_int num_colors = 0;
+
+    // Columns to be colored in the current round
+    std::vector<casadi_int> work = range(n);
+    while (!work.empty()) {
+      // Split up into contiguous blocks
+      casadi_int nw = work.size();
+      casadi_int nb = std::min(n_thread, nw);
+      for (casadi_int b=0; b<nb; ++b) {
+        for (casadi_int k=b*nw/nb; k<(b+1)*nw/nb; ++k) {
+          rank[work[k]] = k;
+          owner[work[k]] = b;
+        }
+      }
+      color_prev = color;
+
+      // Each block colors its columns greedily, seeing the colors of its own block
+      // and of earlier rounds only, so that the result does not depend on timing.
+      // Conflicts between blocks are detected afterwards.
+      int flag = ThreadPool::instance()->run(nb, [&](casadi_int b) -> int {
+        std::vector<casadi_int>& forbiddenColors = forbidden[b];
+        std::fill(forbiddenColors.begin(), forbiddenColors.end(), -1);
+        for (casadi_int k=b*nw/nb; k<(b+1)*nw/nb; ++k) {
+          casadi_int i = work[k];
+          for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+            casadi_int c = row[el];
+            for (casadi_int el_other=AT_colind[c]; el_other<AT_colind[c+1]; ++el_other) {
+              casadi_int j = AT_row[el_other];
+              if (j==i) continue;
+              casadi_int color_j = owner[j]==b ? color[j] : color_prev[j];
+              if (color_j<0) continue;
+              if (color_j>=forbiddenColors.size()) forbiddenColors.resize(color_j+1, -1);
+              forbiddenColors[color_j] = i;
+            }
+          }
+          casadi_int color_i = 0;
+          while (color_i<forbiddenColors.size() && forbiddenColors[color_i]==i) color_i++;
+          color[i] = color_i;
+        }
+        return 0;
+      });
+      casadi_assert(flag==0, "Parallel coloring failed");
+
+      // Of two conflicting columns, the one earlier in the round keeps its color
+      flag = ThreadPool::instance()->run(nb, [&](casadi_int b) -> int {
+        conflicts[b].clear();
+        for (casadi_int k=b*nw/nb; k<(b+1)*nw/nb; ++k) {
+          casadi_int i = work[k];
+          bool conflict = false;
+          for (casadi_int el=colind[i]; el<colind[i+1] && !conflict; ++el) {
+            casadi_int c = row[el];
+            for (casadi_int el_other=AT_colind[c]; el_other<AT_colind[c+1]; ++el_other) {
+              casadi_int j = AT_row[el_other];
+              if (color[j]==color[i] && rank[j]>=0 && rank[j]<k) {
+                conflict = true;
+                break;
+              }
+            }
+          }
+          if (conflict) conflicts[b].push_back(i);
+        }
+        return 0;
+      });
+      casadi_assert(flag==0, "Parallel coloring failed");
+
+      // Columns without conflicts are done
+      for (casadi_int b=0; b<nb; ++b) {
+        for (casadi_int i : conflicts[b]) color[i] = -1;
+      }
+      for (casadi_int i : work) {
+        rank[i] = owner[i] = -1;
+        num_colors = std::max(num_colors, color[i]+1);
+      }
+
+      // Cutoff if too many colors
+      if (num_colors>cutoff) return Sparsity();
+
+      // Recolor the conflicting columns in the next round
+      work.clear();
+      for (casadi_int b=0; b<nb; ++b) {
+        work.insert(work.end(), conflicts[b].begin(), conflicts[b].end());
+      }
+    }
+
+    // Return sparsity in sparse triplet format
+    return Sparsity::triplet(n, num_colors, range(n), color);
+  }
+
+  Sparsity SparsityInternal::distance2_coloring(casadi_int ordering, casadi_int cutoff,
+                                                casadi_int n_thread) const {
+    casadi_assert(is_square(), "Distance-2 coloring requires a square matrix, got "
+      + dim() + ".");
+
+    // Two columns of A+I intersect if and only if they are at most a distance 2 apart
+    Sparsity A = shared_from_this<Sparsity>() + Sparsity::diag(size2());
+    return A->uni_coloring(A, cutoff, ordering, n_thread);
+  }
+
   Sparsity SparsityInternal::star_coloring2(casadi_int ordering, casadi_int cutoff) const {
     if (!is_square()) {
       // NOTE(@jaeandersson) Why warning and not error?
@@ -3044,10 +4031,8 @@ namespace casadi {
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
     if (ordering!=0) {
-      casadi_assert_dev(ordering==1);
-
       // Ordering
-      std::vector<casadi_int> ord = largest_first();
+      std::vector<casadi_int> ord = coloring_ordering(ordering);
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
@@ -3286,6 +4271,282 @@ namespace casadi {
     return Sparsity(size2(), forbiddenColors.size(), ret_colind, ret_row);
   }
 
+  Sparsity SparsityInternal::acyclic_coloring(casadi_int ordering, casadi_int cutoff) const {
+    casadi_assert(is_symmetric(), "Acyclic coloring requires a symmetric matrix, got "
+      + dim() + ".");
+
+    // Reorder, if necessary
+    if (ordering!=0) {
+      // Ordering
+      std::vector<casadi_int> ord = coloring_ordering(ordering);
+
+      // Acyclic coloring for the permuted matrix
+      Sparsity ret_permuted = pmult(ord, true, true, true).acyclic_coloring(0, cutoff);
+      if (ret_permuted.is_null()) return ret_permuted;
+
+      // Permute result back
+      return ret_permuted.pmult(ord, true, false, false);
+    }
+
+    casadi_int n = size2();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Index of the (undirected) edge of each off-diagonal nonzero
+    std::vector<casadi_int> Tmapping;
+    transpose(Tmapping);
+    std::vector<casadi_int> edge(nnz(), -1);
+    casadi_int n_edge = 0;
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+        if (row[el]>i) {
+          edge[el] = edge[Tmapping[el]] = n_edge++;
+        }
+      }
+    }
+
+    // The two-colored trees, as disjoint sets of edges
+    std::vector<casadi_int> set_parent = range(n_edge), set_rank(n_edge, 0);
+    auto find = [&](casadi_int e) {
+      while (set_parent[e]!=e) e = set_parent[e] = set_parent[set_parent[e]];
+      return e;
+    };
+    auto merge = [&](casadi_int e1, casadi_int e2) {
+      e1 = find(e1);
+      e2 = find(e2);
+      if (e1==e2) return;
+      if (set_rank[e1]<set_rank[e2]) std::swap(e1, e2);
+      set_parent[e2] = e1;
+      if (set_rank[e1]==set_rank[e2]) set_rank[e1]++;
+    };
+
+    // First vertex being colored, and its neighbor, that reached each tree
+    std::vector<casadi_int> first_visit_v(n_edge, -1), first_visit_w(n_edge, -1);
+
+    // First neighbor of each color of the vertex being colored
+    std::vector<casadi_int> first_neighbor_v, first_neighbor_el;
+
+    std::vector<casadi_int> forbiddenColors;
+    forbiddenColors.reserve(n);
+    std::vector<casadi_int> color(n, -1);
+
+    for (casadi_int v=0; v<n; ++v) {
+      // Distance-1 coloring
+      for (casadi_int w_el=colind[v]; w_el<colind[v+1]; ++w_el) {
+        casadi_int w = row[w_el];
+        if (w!=v && color[w]>=0) forbiddenColors[color[w]] = v;
+      }
+
+      // Forbid the colors that would close a two-colored cycle, i.e. reach the same
+      // tree through two different neighbors
+      for (casadi_int w_el=colind[v]; w_el<colind[v+1]; ++w_el) {
+        casadi_int w = row[w_el];
+        if (w==v || color[w]<0) continue;
+        for (casadi_int x_el=colind[w]; x_el<colind[w+1]; ++x_el) {
+          casadi_int x = row[x_el];
+          if (x==w || x==v || color[x]<0 || forbiddenColors[color[x]]==v) continue;
+          casadi_int e = find(edge[x_el]);
+          if (first_visit_v[e]!=v) {
+            first_visit_v[e] = v;
+            first_visit_w[e] = w;
+          } else if (first_visit_w[e]!=w) {
+            forbiddenColors[color[x]] = v;
+          }
+        }
+      }
+
+      // Smallest permitted color
+      casadi_int color_v;
+      for (color_v=0; color_v<forbiddenColors.size(); ++color_v) {
+        if (forbiddenColors[color_v]!=v) break;
+      }
+      if (color_v==forbiddenColors.size()) {
+        forbiddenColors.push_back(-1);
+        first_neighbor_v.push_back(-1);
+        first_neighbor_el.push_back(-1);
+
+        // Cutoff if too many colors
+        if (forbiddenColors.size()>cutoff) {
+          return Sparsity();
+        }
+      }
+      color[v] = color_v;
+
+      // Edges to neighbors of the same color belong to the same tree
+      for (casadi_int w_el=colind[v]; w_el<colind[v+1]; ++w_el) {
+        casadi_int w = row[w_el];
+        if (w==v || color[w]<0) continue;
+        casadi_int color_w = color[w];
+        if (first_neighbor_v[color_w]==v) {
+          merge(edge[w_el], edge[first_neighbor_el[color_w]]);
+        } else {
+          first_neighbor_v[color_w] = v;
+          first_neighbor_el[color_w] = w_el;
+        }
+      }
+
+      // Join the trees connected through v
+      for (casadi_int w_el=colind[v]; w_el<colind[v+1]; ++w_el) {
+        casadi_int w = row[w_el];
+        if (w==v || color[w]<0) continue;
+        for (casadi_int x_el=colind[w]; x_el<colind[w+1]; ++x_el) {
+          casadi_int x = row[x_el];
+          if (x!=v && color[x]==color_v) merge(edge[w_el], edge[x_el]);
+        }
+      }
+    }
+
+    // Create return sparsity containing the coloring
+    std::vector<casadi_int> ret_colind(forbiddenColors.size()+1, 0), ret_row(n);
+    for (casadi_int i=0; i<n; ++i) ret_colind[color[i]+1]++;
+    for (casadi_int j=0; j<forbiddenColors.size(); ++j) ret_colind[j+1] += ret_colind[j];
+    std::vector<casadi_int> pos(ret_colind.begin(), ret_colind.end()-1);
+    for (casadi_int i=0; i<n; ++i) ret_row[pos[color[i]]++] = i;
+    return Sparsity(n, forbiddenColors.size(), ret_colind, ret_row);
+  }
+
+  Sparsity SparsityInternal::
+  acyclic_recovery(const Sparsity& D, std::vector<casadi_int>& b_row,
+                   std::vector<casadi_int>& b_color, std::vector<casadi_int>& nz,
+                   std::vector<casadi_int>& nz_tr) const {
+    casadi_assert(is_symmetric(), "Recovery requires a symmetric matrix, got " + dim() + ".");
+    casadi_assert(D.size1()==size2(), "Coloring dimension mismatch");
+    casadi_int n = size2();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Color of each column
+    std::vector<casadi_int> color(n, -1);
+    for (casadi_int c=0; c<D.size2(); ++c) {
+      for (casadi_int el=D.colind()[c]; el<D.colind()[c+1]; ++el) color[D.row()[el]] = c;
+    }
+
+    // Off-diagonal nonzeros in the lower triangular part, grouped by pair of colors
+    std::vector<casadi_int> Tmapping;
+    transpose(Tmapping);
+    std::vector<casadi_int> lower, key;
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+        casadi_int j = row[el];
+        if (j<=i) continue;
+        casadi_assert(color[i]>=0 && color[j]>=0 && color[i]!=color[j],
+          "Columns " + str(i) + " and " + str(j) + " are not properly colored");
+        lower.push_back(el);
+        key.push_back(std::min(color[i], color[j])*D.size2() + std::max(color[i], color[j]));
+      }
+    }
+    std::vector<casadi_int> order = range(lower.size());
+    std::stable_sort(order.begin(), order.end(),
+      [&](casadi_int a, casadi_int b) { return key[a]<key[b];});
+
+    // Local vertex index, parent and its nonzeros, and number of the unknown
+    std::vector<casadi_int> loc(n, -1), parent, parent_el, parent_el_tr, unknown;
+    std::vector<casadi_int> verts, adj_offset, adj, adj_el, bfs, m_row, m_col;
+
+    b_row.clear();
+    b_color.clear();
+    nz.clear();
+    nz_tr.clear();
+
+    // Each pair of colors spans a forest
+    for (casadi_int g0=0, g1=0; g0<order.size(); g0=g1) {
+      for (g1=g0; g1<order.size() && key[order[g1]]==key[order[g0]]; ++g1) {}
+
+      // Vertices and adjacency of the forest
+      verts.clear();
+      for (casadi_int k=g0; k<g1; ++k) {
+        casadi_int el = lower[order[k]];
+        for (casadi_int v : {row[el], row[Tmapping[el]]}) {
+          if (loc[v]<0) {
+            loc[v] = verts.size();
+            verts.push_back(v);
+          }
+        }
+      }
+      casadi_int nv = verts.size();
+      adj_offset.assign(nv+1, 0);
+      for (casadi_int k=g0; k<g1; ++k) {
+        casadi_int el = lower[order[k]];
+        adj_offset[loc[row[el]]+1]++;
+        adj_offset[loc[row[Tmapping[el]]]+1]++;
+      }
+      for (casadi_int i=0; i<nv; ++i) adj_offset[i+1] += adj_offset[i];
+      adj.resize(adj_offset[nv]);
+      adj_el.resize(adj_offset[nv]);
+      std::vector<casadi_int> pos(adj_offset.begin(), adj_offset.end()-1);
+      for (casadi_int k=g0; k<g1; ++k) {
+        // Nonzero el is in the column of the vertex with the lower index
+        casadi_int el = lower[order[k]], el_tr = Tmapping[el];
+        casadi_int i = loc[row[el_tr]], j = loc[row[el]];
+        adj[pos[i]] = j;
+        adj_el[pos[i]++] = el;
+        adj[pos[j]] = i;
+        adj_el[pos[j]++] = el_tr;
+      }
+
+      // Root each tree at its vertex of highest degree, so that stars need no substitution
+      std::vector<casadi_int> roots = range(nv);
+      std::stable_sort(roots.begin(), roots.end(), [&](casadi_int a, casadi_int b) {
+        return adj_offset[a+1]-adj_offset[a] > adj_offset[b+1]-adj_offset[b];});
+      parent.assign(nv, -2);
+      parent_el.assign(nv, -1);
+      parent_el_tr.assign(nv, -1);
+      bfs.clear();
+      for (casadi_int r : roots) {
+        if (parent[r]!=-2) continue;
+        parent[r] = -1;
+        casadi_int first = bfs.size();
+        bfs.push_back(r);
+        for (casadi_int q=first; q<bfs.size(); ++q) {
+          casadi_int u = bfs[q];
+          for (casadi_int k=adj_offset[u]; k<adj_offset[u+1]; ++k) {
+            casadi_int y = adj[k];
+            if (y==parent[u]) continue;
+            casadi_assert(parent[y]==-2,
+              "Coloring is not acyclic, colors " + str(color[verts[u]]) + " and "
+              + str(color[verts[y]]) + " form a cycle");
+            parent[y] = u;
+            // Nonzero in the column of the parent, and in the column of the child
+            parent_el[y] = adj_el[k];
+            parent_el_tr[y] = Tmapping[adj_el[k]];
+            bfs.push_back(y);
+          }
+        }
+      }
+
+      // Unknowns in reverse breadth-first order, children before their parents
+      unknown.assign(nv, -1);
+      for (auto it=bfs.rbegin(); it!=bfs.rend(); ++it) {
+        casadi_int v = *it, p = parent[v];
+        if (p<0) continue;
+        unknown[v] = b_row.size();
+        b_row.push_back(verts[v]);
+        b_color.push_back(color[verts[p]]);
+        nz.push_back(parent_el[v]);
+        nz_tr.push_back(parent_el_tr[v]);
+      }
+
+      // Compressed entry of v for the color of its parent: the edge to the parent plus the
+      // edges to its children
+      for (casadi_int v=0; v<nv; ++v) {
+        if (unknown[v]<0) continue;
+        m_row.push_back(unknown[v]);
+        m_col.push_back(unknown[v]);
+        casadi_int p = parent[v];
+        if (unknown[p]>=0) {
+          m_row.push_back(unknown[p]);
+          m_col.push_back(unknown[v]);
+        }
+      }
+
+      // Reset
+      for (casadi_int v : verts) loc[v] = -1;
+    }
+
+    casadi_int m = b_row.size();
+    return Sparsity::triplet(m, m, m_row, m_col);
+  }
+
   Sparsity SparsityInternal::star_coloring(casadi_int ordering, casadi_int cutoff) const {
     if (!is_square()) {
       // NOTE(@jaeandersson) Why warning and not error?
@@ -3294,10 +4555,8 @@ namespace casadi {
 
     // Reorder, if necessary
     if (ordering!=0) {
-      casadi_assert_dev(ordering==1);
-
       // Ordering
-      std::vector<casadi_int> ord = largest_first();
+      std::vector<casadi_int> ord = coloring_ordering(ordering);
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
@@ -3434,6 +4693,117 @@ namespace casadi {
     return reverse_ordering;
   }
 
+  std::vector<casadi_int> SparsityInternal::smallest_last() const {
+    casadi_int n = size2();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Degree of each vertex, diagonal entries excluded
+    std::vector<casadi_int> degree(n, 0);
+    casadi_int max_degree = 0;
+    for (casadi_int i=0; i<n; ++i) {
+      for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
+        if (row[el]!=i) degree[i]++;
+      }
+      max_degree = std::max(max_degree, degree[i]);
+    }
+
+    // Doubly linked lists of the vertices of each degree
+    std::vector<casadi_int> head(max_degree+1, -1), next(n, -1), prev(n, -1);
+    for (casadi_int i=n-1; i>=0; --i) bucket_insert(head, next, prev, i, degree[i]);
+
+    // Repeatedly remove a vertex of smallest degree and order it last
+    std::vector<casadi_int> ordering(n);
+    casadi_int min_degree = 0;
+    for (casadi_int k=n-1; k>=0; --k) {
+      while (head[min_degree]<0) min_degree++;
+      casadi_int v = head[min_degree];
+      bucket_remove(head, next, prev, v, min_degree);
+      ordering[k] = v;
+      degree[v] = -1;
+
+      // Update the degrees of the remaining neighbors
+      for (casadi_int el=colind[v]; el<colind[v+1]; ++el) {
+        casadi_int w = row[el];
+        if (degree[w]<0) continue;
+        bucket_remove(head, next, prev, w, degree[w]);
+        bucket_insert(head, next, prev, w, --degree[w]);
+      }
+
+      // The smallest degree decreases by at most one
+      min_degree = std::max(min_degree-1, casadi_int(0));
+    }
+    return ordering;
+  }
+
+  std::vector<casadi_int> SparsityInternal::incidence_degree() const {
+    casadi_int n = size2();
+    const casadi_int* colind = this->colind();
+    const casadi_int* row = this->row();
+
+    // Number of ordered neighbors of each vertex, -1 if ordered
+    std::vector<casadi_int> inc(n, 0);
+
+    // Doubly linked lists of the vertices with a given number of ordered neighbors,
+    // initially with the vertices of largest degree first
+    std::vector<casadi_int> head(n+1, -1), next(n, -1), prev(n, -1);
+    std::vector<casadi_int> lf = largest_first();
+    for (casadi_int k=n-1; k>=0; --k) bucket_insert(head, next, prev, lf[k], 0);
+
+    // Repeatedly order a vertex with the most ordered neighbors
+    std::vector<casadi_int> ordering(n);
+    casadi_int max_inc = 0;
+    for (casadi_int k=0; k<n; ++k) {
+      while (head[max_inc]<0) max_inc--;
+      casadi_int v = head[max_inc];
+      bucket_remove(head, next, prev, v, max_inc);
+      ordering[k] = v;
+      inc[v] = -1;
+
+      // Update the remaining neighbors
+      for (casadi_int el=colind[v]; el<colind[v+1]; ++el) {
+        casadi_int w = row[el];
+        if (inc[w]<0) continue;
+        bucket_remove(head, next, prev, w, inc[w]);
+        bucket_insert(head, next, prev, w, ++inc[w]);
+        max_inc = std::max(max_inc, inc[w]);
+      }
+    }
+    return ordering;
+  }
+
+  void SparsityInternal::bucket_insert(std::vector<casadi_int>& head,
+                                       std::vector<casadi_int>& next,
+                                       std::vector<casadi_int>& prev,
+                                       casadi_int v, casadi_int b) {
+    next[v] = head[b];
+    prev[v] = -1;
+    if (head[b]>=0) prev[head[b]] = v;
+    head[b] = v;
+  }
+
+  void SparsityInternal::bucket_remove(std::vector<casadi_int>& head,
+                                       std::vector<casadi_int>& next,
+                                       std::vector<casadi_int>& prev,
+                                       casadi_int v, casadi_int b) {
+    if (prev[v]>=0) {
+      next[prev[v]] = next[v];
+    } else {
+      head[b] = next[v];
+    }
+    if (next[v]>=0) prev[next[v]] = prev[v];
+  }
+
+  std::vector<casadi_int> SparsityInternal::coloring_ordering(casadi_int ordering) const {
+    switch (ordering) {
+      case 1: return largest_first();
+      case 2: return smallest_last();
+      case 3: return incidence_degree();
+      default: casadi_error("Unknown ordering " + str(ordering) + ", expected "
+        "None (0), largest first (1), smallest last (2) or incidence degree (3)");
+    }
+  }
+
   Sparsity SparsityInternal::pmult(const std::vector<casadi_int>& p, bool permute_rows,
                                    bool permute_columns, bool invert_permutation) const {
     // Invert p, possibly
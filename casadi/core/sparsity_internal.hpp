@@ -61,7 +61,16 @@ namespace casadi {
       Calculated on first call, then cached
 
         \identifier{23j} */
+#ifdef CASADI_WITH_THREAD
+    mutable std::atomic<Btf*> btf_;
+#else // CASADI_WITH_THREAD
     mutable Btf* btf_;
+#endif // CASADI_WITH_THREAD
+
+    /// Is the pattern registered in SparsityCache, and under which hash?
+    bool cached_;
+    std::size_t hash_;
+    friend class SparsityCache;
 
   public:
     /// Construct a sparsity pattern from arrays
@@ -141,6 +150,75 @@ namespace casadi {
         \identifier{en} */
     std::vector<casadi_int> amd() const;
 
+    /** \brief Constrained approximate minimal degree preordering
+
+      * Nodes are eliminated set by set in increasing order of cons, by minimum
+      * degree within each set. The degrees account for the fill-in from all
+      * nodes eliminated before, as in CAMD by Timothy A. Davis et al. The result
+      * is a postordering of this elimination, with the same fill-in.
+      */
+    std::vector<casadi_int> amd(const std::vector<casadi_int>& cons) const;
+
+    /** \brief Nested dissection preordering
+
+      * Recursively splits the adjacency graph by a vertex separator, which is ordered
+      * after the two parts. Separators are found on a graph coarsened by heavy edge
+      * matching, from a bisection by graph growing, and refined by Fiduccia-Mattheyses
+      * on every level when projected back. Parts of at most leaf_size vertices are
+      * leaves. The leaves and separators are ordered by constrained minimum degree on
+      * the whole pattern, so that each sees the fill-in from the parts eliminated
+      * before it.
+      */
+    std::vector<casadi_int> nested_dissection(casadi_int leaf_size=256) const;
+
+    /** \brief Dissect the subgraph induced by verts (sorted)
+
+      * Leaves and separators are numbered consecutively in elimination order in cons,
+      * starting at nset
+      */
+    static void nd_order(const std::vector<casadi_int>& xadj, const std::vector<casadi_int>& adj,
+                         const std::vector<casadi_int>& verts, casadi_int leaf_size,
+                         std::vector<casadi_int>& loc, std::vector<casadi_int>& cons,
+                         casadi_int& nset);
+
+    /** \brief Vertex separator of a connected weighted graph: part 0 or 1, or 2 for the separator
+
+      * The separator of the coarsest graph is a minimum vertex cover of the cut edges of
+      * a bisection. It is projected back level by level and refined on each.
+      */
+    static std::vector<casadi_int> nd_separator(const std::vector<casadi_int>& xadj,
+                                                const std::vector<casadi_int>& adj,
+                                                const std::vector<casadi_int>& adjwgt,
+                                                const std::vector<casadi_int>& vwgt);
+
+    /// Bisection of a small weighted graph, minimizing the edge cut
+    static std::vector<casadi_int> nd_bisect(const std::vector<casadi_int>& xadj,
+                                             const std::vector<casadi_int>& adj,
+                                             const std::vector<casadi_int>& adjwgt,
+                                             const std::vector<casadi_int>& vwgt);
+
+    /// Coarsen a weighted graph by heavy edge matching
+    static void nd_coarsen(const std::vector<casadi_int>& xadj,
+                           const std::vector<casadi_int>& adj,
+                           const std::vector<casadi_int>& adjwgt,
+                           const std::vector<casadi_int>& vwgt,
+                           std::vector<casadi_int>& cmap, std::vector<casadi_int>& cxadj,
+                           std::vector<casadi_int>& cadj, std::vector<casadi_int>& cadjwgt,
+                           std::vector<casadi_int>& cvwgt);
+
+    /// Fiduccia-Mattheyses refinement of a bisection
+    static void nd_refine(const std::vector<casadi_int>& xadj,
+                          const std::vector<casadi_int>& adj,
+                          const std::vector<casadi_int>& adjwgt,
+                          const std::vector<casadi_int>& vwgt,
+                          std::vector<casadi_int>& where);
+
+    /// Fiduccia-Mattheyses refinement of a vertex separator, minimizing its weight
+    static void nd_refine_separator(const std::vector<casadi_int>& xadj,
+                                    const std::vector<casadi_int>& adj,
+                                    const std::vector<casadi_int>& vwgt,
+                                    std::vector<casadi_int>& where);
+
     /** \brief Calculate the elimination tree for a matrix
 
       * len[w] >= ata ? ncol + nrow : ncol
@@ -176,6 +254,19 @@ namespace casadi {
         \identifier{eq} */
     static void postorder(const casadi_int* parent, casadi_int n, casadi_int* post, casadi_int* w);
 
+    /** \brief Distribute independent subtrees of an elimination tree over threads
+
+      * Parents must have larger indices than their children. Subtrees with at most
+      * 1/(4*n_thread) of the total work become tasks, balanced greedily over at most
+      * n_thread groups. The remaining nodes form the top of the tree.
+      * Layout: [ngroup, gptr (ngroup+1), tptr (ntask+1), node, top], where group g
+      * holds tasks gptr[g] to gptr[g+1]-1 and task t the nodes node[tptr[t]] to
+      * node[tptr[t+1]-1] in increasing order, the last one being the root.
+      * Empty if there are fewer than two tasks.
+      */
+    static std::vector<casadi_int> etree_schedule(const std::vector<casadi_int>& parent,
+      const std::vector<double>& work, casadi_int n_thread);
+
     /** \brief Needed by casadi_qr_colind
 
       * Ref: Chapter 4, Direct Methods for Sparse Linear Systems by Tim Davis
@@ -276,6 +367,14 @@ namespace casadi {
     static void ldl_row(const casadi_int* sp, const casadi_int* parent,
       casadi_int* l_colind, casadi_int* l_row, casadi_int *w);
 
+    /** \brief Supernodes of an LDL^T factorization, pattern of L^T
+
+      * Fundamental supernodes, optionally merged with their parents when few explicit
+      * zeros are introduced: up to 30%, 10% and 5% for at most 16, 48 and more columns.
+      * Layout: [n, nsuper, super (nsuper+1), rowptr (nsuper+1), nzptr (nsuper+1), row]
+      */
+    std::vector<casadi_int> ldl_supernodes(bool relaxed) const;
+
     /// Transpose the matrix
     Sparsity T() const;
 
@@ -704,7 +803,27 @@ namespace casadi {
      * (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
 
         \identifier{fn} */
-    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff) const;
+    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff,
+                          casadi_int ordering=0, casadi_int n_thread=1) const;
+
+    /** \brief Speculative parallel unidirectional coloring
+
+     * The columns are split up into blocks that are colored concurrently.
+     * Columns that conflict with a column of another block are recolored
+     * in a next round. As proposed in
+     *   A scalable parallel graph coloring algorithm
+     *   A. H. GEBREMEDHIN, F. MANNE
+     *   Concurrency: Practice and Experience, 12(12), 1131-1146 (2000)
+     */
+    Sparsity uni_coloring_parallel(const Sparsity& AT, casadi_int cutoff,
+                                   casadi_int n_thread) const;
+
+    /** \brief A greedy distance-2 coloring of a symmetric matrix
+
+     * See description in public class.
+     */
+    Sparsity distance2_coloring(casadi_int ordering, casadi_int cutoff,
+                                casadi_int n_thread) const;
 
     /** \brief A greedy distance-2 coloring algorithm
 
@@ -720,9 +839,40 @@ namespace casadi {
         \identifier{fp} */
     Sparsity star_coloring2(casadi_int ordering, casadi_int cutoff) const;
 
+    /** \brief An acyclic distance-1 coloring
+
+     * See description in public class.
+     */
+    Sparsity acyclic_coloring(casadi_int ordering, casadi_int cutoff) const;
+
+    /** \brief Recovery of a matrix compressed with an acyclic coloring
+
+     * See description in public class.
+     */
+    Sparsity acyclic_recovery(const Sparsity& D, std::vector<casadi_int>& b_row,
+                              std::vector<casadi_int>& b_color, std::vector<casadi_int>& nz,
+                              std::vector<casadi_int>& nz_tr) const;
+
     /// Order the columns by decreasing degree
     std::vector<casadi_int> largest_first() const;
 
+    /// Smallest last ordering of the columns of a symmetric matrix
+    std::vector<casadi_int> smallest_last() const;
+
+    /// Incidence degree ordering of the columns of a symmetric matrix
+    std::vector<casadi_int> incidence_degree() const;
+
+    /// Ordering for graph coloring: largest first (1), smallest last (2), incidence degree (3)
+    std::vector<casadi_int> coloring_ordering(casadi_int ordering) const;
+
+    ///@{
+    /// Maintain doubly linked lists of vertices, bucket b starting at head[b]
+    static void bucket_insert(std::vector<casadi_int>& head, std::vector<casadi_int>& next,
+                              std::vector<casadi_int>& prev, casadi_int v, casadi_int b);
+    static void bucket_remove(std::vector<casadi_int>& head, std::vector<casadi_int>& next,
+                              std::vector<casadi_int>& prev, casadi_int v, casadi_int b);
+    ///@}
+
     /// Permute rows and/or columns
     Sparsity pmult(const std::vector<casadi_int>& p, bool permute_rows=true, bool permute_cols=true,
                    bool invert_permutation=false) const;
@@ -745,6 +895,44 @@ namespace casadi {
     void spsolve(bvec_t* X, bvec_t* B, bool tr) const;
 };
 
+  /** \brief Process-wide table of the sparsity patterns in use
+
+      Used by Sparsity::assign_cached to share patterns between expressions.
+      The table is split into shards selected by the hash of the pattern, each
+      with its own lock, so that threads constructing expressions concurrently
+      rarely contend. Entries are raw pointers that a pattern removes from its
+      shard when it is destroyed: the table never holds expired entries, and a
+      lookup cannot recover a pattern whose last reference is being dropped.
+  */
+  class CASADI_EXPORT SparsityCache {
+  public:
+    /// Get the process-wide instance
+    static SparsityCache& instance();
+
+    /// Get a matching pattern in use, or create and register a new one
+    Sparsity intern(casadi_int nrow, casadi_int ncol,
+                    const casadi_int* colind, const casadi_int* row, std::size_t h);
+
+    /// Unregister a pattern, called upon destruction
+    void erase(SparsityInternal* sp);
+
+    /// Number of patterns registered
+    casadi_int size();
+
+  private:
+    /// Constructor, allocates the shards
+    SparsityCache();
+
+    /// Number of shards, power of two
+    static const casadi_int n_shards = 64;
+
+    /// Shard holding the patterns with hash h
+    struct Shard;
+    Shard& shard(std::size_t h);
+
+    std::vector<Shard*> shards_;
+  };
+
 } // namespace casadi
 /// \endcond
 
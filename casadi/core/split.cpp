@@ -65,7 +65,8 @@ namespace casadi {
     for (casadi_int i=0; i<nx; ++i) {
       casadi_int nz_first = offset_[i];
       casadi_int nz_last = offset_[i+1];
-      if (res[i]!=nullptr) {
+      // Results may share the data of the argument
+      if (res[i]!=nullptr && res[i]!=arg[0]+nz_first) {
         std::copy(arg[0]+nz_first, arg[0]+nz_last, res[i]);
       }
     }
@@ -75,7 +76,7 @@ namespace casadi {
   int Split::sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
     casadi_int nx = offset_.size()-1;
     for (casadi_int i=0; i<nx; ++i) {
-      if (res[i]!=nullptr) {
+      if (res[i]!=nullptr && res[i]!=arg[0]+offset_[i]) {
         const bvec_t *arg_ptr = arg[0] + offset_[i];
         casadi_int n_i = sparsity(i).nnz();
         bvec_t *res_i_ptr = res[i];
@@ -90,7 +91,7 @@ namespace casadi {
   int Split::sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w) const {
     casadi_int nx = offset_.size()-1;
     for (casadi_int i=0; i<nx; ++i) {
-      if (res[i]!=nullptr) {
+      if (res[i]!=nullptr && res[i]!=arg[0]+offset_[i]) {
         bvec_t *arg_ptr = arg[0] + offset_[i];
         casadi_int n_i = sparsity(i).nnz();
         bvec_t *res_i_ptr = res[i];
@@ -41,6 +41,8 @@ template<> inline std::string matrixName<SXElem>() { return "SX"; }
   template<>
   casadi_int SX::get_max_depth();
   template<>
+  Dict SX::memory_usage();
+  template<>
   SX SX::_sym(const std::string& name, const Sparsity& sp);
 
   template<>
@@ -39,9 +39,22 @@ namespace casadi {
 
 
 
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+  // Per-thread caching
+  ThreadConstantCache<casadi_int, IntegerSX>& IntegerSX::thread_cache() {
+    static thread_local ThreadConstantCache<casadi_int, IntegerSX> cache;
+    return cache;
+  }
+
+  ThreadConstantCache<double, RealtypeSX>& RealtypeSX::thread_cache() {
+    static thread_local ThreadConstantCache<double, RealtypeSX> cache;
+    return cache;
+  }
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
   // Allocate storage for the caching
   CACHING_MAP<casadi_int, IntegerSX*> IntegerSX::cached_constants_;
   CACHING_MAP<double, RealtypeSX*> RealtypeSX::cached_constants_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
   SXElem::SXElem() {
     node = casadi_limits<SXElem>::nan.node;
@@ -537,16 +550,18 @@ namespace casadi {
   }
 
   // node corresponding to a constant 0
-  const SXElem casadi_limits<SXElem>::zero(ZeroSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem casadi_limits<SXElem>::zero(ZeroSX::singleton(), false);
   // node corresponding to a constant 1
-  const SXElem casadi_limits<SXElem>::one(OneSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem casadi_limits<SXElem>::one(OneSX::singleton(), false);
   // node corresponding to a constant 2
-  const SXElem casadi_limits<SXElem>::two(IntegerSX::create(2), false);
+  CASADI_SYMBOLICS_TLS const SXElem casadi_limits<SXElem>::two(IntegerSX::create(2), false);
   // node corresponding to a constant -1
-  const SXElem casadi_limits<SXElem>::minus_one(MinusOneSX::singleton(), false);
-  const SXElem casadi_limits<SXElem>::nan(NanSX::singleton(), false);
-  const SXElem casadi_limits<SXElem>::inf(InfSX::singleton(), false);
-  const SXElem casadi_limits<SXElem>::minus_inf(MinusInfSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem
+    casadi_limits<SXElem>::minus_one(MinusOneSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem casadi_limits<SXElem>::nan(NanSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem casadi_limits<SXElem>::inf(InfSX::singleton(), false);
+  CASADI_SYMBOLICS_TLS const SXElem
+    casadi_limits<SXElem>::minus_inf(MinusInfSX::singleton(), false);
 
   bool casadi_limits<SXElem>::is_zero(const SXElem& val) {
     return val.is_zero();
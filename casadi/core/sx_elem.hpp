@@ -44,6 +44,17 @@
 #include <string>
 #include <vector>
 
+/** \brief Storage of symbolic constants shared by all expressions of a thread
+
+    With CASADI_WITH_THREADSAFE_SYMBOLICS, every thread gets its own constant nodes,
+    so that expressions built independently in different threads never share a node.
+*/
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#define CASADI_SYMBOLICS_TLS thread_local
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+#define CASADI_SYMBOLICS_TLS
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
 namespace casadi {
 
   /** \brief  forward declaration of Node and Matrix
@@ -291,13 +302,13 @@ namespace casadi {
     static bool is_minus_inf(const SXElem& val);
     static bool is_nan(const SXElem& val);
 
-    static const SXElem zero;
-    static const SXElem one;
-    static const SXElem two;
-    static const SXElem minus_one;
-    static const SXElem nan;
-    static const SXElem inf;
-    static const SXElem minus_inf;
+    static CASADI_SYMBOLICS_TLS const SXElem zero;
+    static CASADI_SYMBOLICS_TLS const SXElem one;
+    static CASADI_SYMBOLICS_TLS const SXElem two;
+    static CASADI_SYMBOLICS_TLS const SXElem minus_one;
+    static CASADI_SYMBOLICS_TLS const SXElem nan;
+    static CASADI_SYMBOLICS_TLS const SXElem inf;
+    static CASADI_SYMBOLICS_TLS const SXElem minus_inf;
   };
 
 #endif // SWIG
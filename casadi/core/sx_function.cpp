@@ -34,9 +34,159 @@
 #include "sparsity_internal.hpp"
 #include "casadi_interrupt.hpp"
 #include "serializing_stream.hpp"
+#include "native_jit.hpp"
+#include "thread_pool.hpp"
+#include <list>
+#include <set>
+#include <unordered_map>
 
 namespace casadi {
 
+  /** \brief Reorder an algorithm with work vector indices equal to node indices
+
+      Greedy list scheduling: among the instructions with all operands available, pick the
+      one that ends the most live ranges, then the one whose operands were computed most
+      recently. Constants and symbolic primitives are emitted right before their first use.
+      Returns the new position-to-old position mapping.
+  */
+  static std::vector<casadi_int> schedule_locality(const std::vector<ScalarAtomic>& alg) {
+    casadi_int n = alg.size();
+    // Is the instruction a leaf, i.e. without dependencies?
+    auto is_leaf = [&](casadi_int k) { return casadi_math<double>::ndeps(alg[k].op)==0;};
+    // Distinct dependencies of an instruction
+    auto get_deps = [&](casadi_int k, casadi_int* d) -> casadi_int {
+      casadi_int ndeps = casadi_math<double>::ndeps(alg[k].op);
+      if (ndeps>0) d[0] = alg[k].i1;
+      if (ndeps>1) d[1] = alg[k].i2;
+      if (ndeps==2 && d[0]==d[1]) ndeps = 1;
+      return ndeps;
+    };
+    // Consumers of each instruction, compressed column format
+    std::vector<casadi_int> cons_ptr(n+1, 0), pending(n, 0);
+    casadi_int d[2];
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_int nd = get_deps(k, d);
+      for (casadi_int c=0; c<nd; ++c) {
+        cons_ptr[d[c]+1]++;
+        if (!is_leaf(d[c])) pending[k]++;
+      }
+    }
+    for (casadi_int k=0; k<n; ++k) cons_ptr[k+1] += cons_ptr[k];
+    std::vector<casadi_int> cons(cons_ptr.back()), pos(cons_ptr.begin(), cons_ptr.end()-1);
+    for (casadi_int k=0; k<n; ++k) {
+      casadi_int nd = get_deps(k, d);
+      for (casadi_int c=0; c<nd; ++c) cons[pos[d[c]]++] = k;
+    }
+    // Number of consumers not yet emitted
+    std::vector<casadi_int> remaining(n);
+    for (casadi_int k=0; k<n; ++k) remaining[k] = cons_ptr[k+1] - cons_ptr[k];
+    // Position in the new order, -1 if not yet emitted
+    std::vector<casadi_int> time(n, -1);
+    // Priority of ready instructions: live ranges ended, most recent operand, original order
+    typedef std::pair<std::pair<casadi_int, casadi_int>, casadi_int> Key;
+    std::vector<Key> key(n);
+    std::set<Key> ready;
+    auto make_ready = [&](casadi_int k) {
+      casadi_int nd = get_deps(k, d), kills = 0, recent = -1;
+      for (casadi_int c=0; c<nd; ++c) {
+        if (time[d[c]]>=0) {
+          if (remaining[d[c]]==1) kills++;
+          recent = std::max(recent, time[d[c]]);
+        }
+      }
+      key[k] = Key(std::make_pair(kills, recent), -k);
+      ready.insert(key[k]);
+    };
+    for (casadi_int k=0; k<n; ++k) {
+      if (!is_leaf(k) && pending[k]==0) make_ready(k);
+    }
+    std::vector<casadi_int> order;
+    order.reserve(n);
+    while (!ready.empty()) {
+      casadi_int k = -ready.rbegin()->second;
+      ready.erase(std::prev(ready.end()));
+      // Emit leaves right before their first use
+      casadi_int nd = get_deps(k, d);
+      for (casadi_int c=0; c<nd; ++c) {
+        if (time[d[c]]<0) {
+          time[d[c]] = order.size();
+          order.push_back(d[c]);
+        }
+      }
+      time[k] = order.size();
+      order.push_back(k);
+      // Update the live ranges of the operands
+      for (casadi_int c=0; c<nd; ++c) {
+        if (--remaining[d[c]]==1) {
+          // The last consumer will end the live range
+          for (casadi_int i=cons_ptr[d[c]]; i<cons_ptr[d[c]+1]; ++i) {
+            casadi_int j = cons[i];
+            if (time[j]<0 && ready.erase(key[j])) {
+              key[j].first.first++;
+              ready.insert(key[j]);
+            }
+          }
+        }
+      }
+      // Consumers that have become ready
+      for (casadi_int i=cons_ptr[k]; i<cons_ptr[k+1]; ++i) {
+        if (--pending[cons[i]]==0) make_ready(cons[i]);
+      }
+    }
+    casadi_assert(order.size()==n, "Scheduling failed");
+    return order;
+  }
+
+  /** \brief Largest number of simultaneously live work vector elements for a given order
+  */
+  static casadi_int max_live(const std::vector<ScalarAtomic>& alg,
+      const std::vector<casadi_int>& order) {
+    std::vector<casadi_int> refcount(alg.size(), 0);
+    for (auto&& e : alg) {
+      casadi_int ndeps = casadi_math<double>::ndeps(e.op);
+      if (ndeps>0) refcount[e.i1]++;
+      if (ndeps>1) refcount[e.i2]++;
+    }
+    casadi_int live = 0, ret = 0;
+    for (casadi_int k : order) {
+      const ScalarAtomic& e = alg[k];
+      casadi_int ndeps = casadi_math<double>::ndeps(e.op);
+      if (ndeps>0 && --refcount[e.i1]==0) live--;
+      if (ndeps>1 && --refcount[e.i2]==0) live--;
+      if (e.op!=OP_OUTPUT) ret = std::max(ret, ++live);
+    }
+    return ret;
+  }
+
+  /** \brief Fully associative cache with least-recently-used replacement
+  */
+  class LruCache {
+  public:
+    explicit LruCache(size_t n_lines) : n_lines_(n_lines), n_access_(0), n_miss_(0) {}
+    // Access a cache line
+    void access(size_t line) {
+      n_access_++;
+      auto it = map_.find(line);
+      if (it!=map_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+      }
+      n_miss_++;
+      lru_.push_front(line);
+      map_[line] = lru_.begin();
+      if (lru_.size()>n_lines_) {
+        map_.erase(lru_.back());
+        lru_.pop_back();
+      }
+    }
+    // Miss rate
+    double miss_rate() const { return n_access_==0 ? 0 : n_miss_/static_cast<double>(n_access_);}
+  private:
+    size_t n_lines_, n_access_, n_miss_;
+    std::list<size_t> lru_;
+    std::unordered_map<size_t, std::list<size_t>::iterator> map_;
+  };
+
   SXFunction::SXFunction(const std::string& name,
                          const std::vector<SX >& inputv,
                          const std::vector<SX >& outputv,
@@ -47,10 +197,15 @@ namespace casadi {
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    jit_native_ = false;
+    native_ = nullptr;
+    parallelization_ = "serial";
+    parallel_grain_ = 1000;
   }
 
   SXFunction::~SXFunction() {
     clear_mem();
+    if (native_) delete native_;
   }
 
   int SXFunction::eval(const double** arg, double** res,
@@ -65,10 +220,39 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // Reevaluate what depends on changed inputs, if requested
+    if (incremental_ && mem) return eval_incremental(arg, res, static_cast<XFunctionMemory*>(mem));
+
+    // Evaluate level by level on the thread pool, if requested
+    if (!par_stage_.empty()) return eval_parallel(arg, res, w);
+
+    // Evaluate native machine code, if available
+    if (native_) {
+      native_->eval(arg, res, w);
+      return 0;
+    }
+
     // NOTE: The implementation of this function is very delicate. Small changes in the
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
 
+    // Evaluate the compact encoding, if available
+    if (!compact_.empty()) {
+      const double* c = get_ptr(compact_constants_);
+      for (auto&& e : compact_) {
+        switch (e.op) {
+          CASADI_MATH_FUN_BUILTIN(w[e.i1], w[e.i2], w[e.i0])
+
+        case OP_CONST: w[e.i0] = c[e.i1 | static_cast<uint32_t>(e.i2) << 16]; break;
+        case OP_INPUT: w[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2]; break;
+        case OP_OUTPUT: if (res[e.i0]!=nullptr) res[e.i0][e.i2] = w[e.i1]; break;
+        default:
+          casadi_error("Unknown operation" + str(e.op));
+        }
+      }
+      return 0;
+    }
+
     // Evaluate the algorithm
     for (auto&& e : algorithm_) {
       switch (e.op) {
@@ -84,6 +268,106 @@ namespace casadi {
     return 0;
   }
 
+  // Evaluate a range of instructions
+  static void eval_range(const ScalarAtomic* begin, const ScalarAtomic* end,
+      const double** arg, double** res, double* w) {
+    for (const ScalarAtomic* e=begin; e!=end; ++e) {
+      switch (e->op) {
+        CASADI_MATH_FUN_BUILTIN(w[e->i1], w[e->i2], w[e->i0])
+
+      case OP_CONST: w[e->i0] = e->d; break;
+      case OP_INPUT: w[e->i0] = arg[e->i1]==nullptr ? 0 : arg[e->i1][e->i2]; break;
+      case OP_OUTPUT: if (res[e->i0]!=nullptr) res[e->i0][e->i2] = w[e->i1]; break;
+      default:
+        casadi_error("Unknown operation" + str(e->op));
+      }
+    }
+  }
+
+  int SXFunction::eval_parallel(const double** arg, double** res, double* w) const {
+    std::shared_ptr<ThreadPool> pool = ThreadPool::instance();
+    const AlgEl* alg = get_ptr(par_algorithm_);
+    for (casadi_int s=0; s+1<par_stage_.size(); ++s) {
+      casadi_int begin = par_stage_[s], end = par_stage_[s+1];
+      if (!par_parallel_[s]) {
+        eval_range(alg+begin, alg+end, arg, res, w);
+        continue;
+      }
+      // Split the level into contiguous slices, one task each
+      casadi_int n_task = std::min((end-begin)/parallel_grain_, pool->size()+1);
+      int flag = pool->run(n_task, [&](casadi_int t) {
+        casadi_int b = begin + t*(end-begin)/n_task, e = begin + (t+1)*(end-begin)/n_task;
+        eval_range(alg+b, alg+e, arg, res, w);
+        return 0;
+      });
+      if (flag) return flag;
+    }
+    return 0;
+  }
+
+  int SXFunction::eval_incremental(const double** arg, double** res,
+      XFunctionMemory* m) const {
+    bool first = !m->valid;
+    bvec_t changed = incremental_changed(arg, m);
+    double* w = get_ptr(m->w);
+    const AlgEl* alg = get_ptr(algorithm_);
+    if (first) {
+      eval_range(alg, alg+algorithm_.size(), arg, res, w);
+      return 0;
+    }
+    // Reevaluate the runs that depend on changed inputs
+    for (casadi_int r=0; r<incr_mask_.size(); ++r) {
+      if (incr_mask_[r] & changed) eval_range(alg+incr_run_[r], alg+incr_run_[r+1], arg, res, w);
+    }
+    // Outputs are always written
+    for (casadi_int k : incr_output_) eval_range(alg+k, alg+k+1, arg, res, w);
+    return 0;
+  }
+
+  bool SXFunction::has_eval_batch() const {
+    // Only when the virtual machine is used and no instrumentation is requested
+    return eval_==nullptr && free_vars_.empty() && !record_time_
+      && !print_in_ && !print_out_ && !dump_in_ && !dump_out_ && !dump_
+      && !regularity_check_;
+  }
+
+  int SXFunction::eval_batch(const double** arg, double** res,
+      casadi_int* iw, double* w, casadi_int n) const {
+    if (verbose_) casadi_message(name_ + "::eval_batch");
+    casadi_assert_dev(has_eval_batch());
+
+    // Evaluate the algorithm, n lanes at a time. Lane k of work element i is stored in w[i*n+k]
+    for (auto&& e : algorithm_) {
+      double* f = w + e.i0*n;
+      switch (e.op) {
+      case OP_CONST:
+        std::fill_n(f, n, e.d);
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          std::fill_n(f, n, 0);
+        } else {
+          const double* a = arg[e.i1] + e.i2;
+          casadi_int stride = nnz_in(e.i1);
+          for (casadi_int k=0; k<n; ++k) f[k] = a[k*stride];
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) {
+          double* r = res[e.i0] + e.i2;
+          const double* x = w + e.i1*n;
+          casadi_int stride = nnz_out(e.i0);
+          for (casadi_int k=0; k<n; ++k) r[k*stride] = x[k];
+        }
+        break;
+      default:
+        // Vector-vector kernels, in-place safe since lanes are independent
+        casadi_math<double>::fun(e.op, w + e.i1*n, w + e.i2*n, f, n);
+      }
+    }
+    return 0;
+  }
+
   bool SXFunction::is_smooth() const {
     // Go through all nodes and check if any node is non-smooth
     for (auto&& a : algorithm_) {
@@ -184,9 +468,40 @@ namespace casadi {
       {"just_in_time_opencl",
        {OT_BOOL,
         "Just-in-time compilation for numeric evaluation using OpenCL (experimental)"}},
+      {"jit_native",
+       {OT_BOOL,
+        "Translate the algorithm to machine code in memory at initialization, "
+        "without invoking an external compiler (x86-64 only)"}},
       {"live_variables",
        {OT_BOOL,
         "Reuse variables in the work vector"}},
+      {"schedule_locality",
+       {OT_BOOL,
+        "Reorder the instructions to shorten live ranges and keep work vector "
+        "accesses local (Default: false)"}},
+      {"compact_tape",
+       {OT_BOOL,
+        "Evaluate using an 8-byte instruction encoding when the work vector "
+        "and all indices fit in 16 bits (Default: false)"}},
+      {"estimate_cache",
+       {OT_BOOL,
+        "Report estimated cache miss rates of one evaluation in info(), "
+        "computed on each call by replaying the memory accesses (Default: false)"}},
+      {"parallelization",
+       {OT_STRING,
+        "serial|thread: evaluate independent instructions, grouped by dependency level, "
+        "on the shared thread pool. Live variables are disabled unless set explicitly "
+        "(Default: serial)"}},
+      {"incremental",
+       {OT_BOOL,
+        "Keep the work vector between calls and only reevaluate the instructions "
+        "that depend on inputs that changed since the previous call. "
+        "Disables live variables unless set explicitly (Default: false)"}},
+      {"parallel_grain",
+       {OT_INT,
+        "Smallest number of instructions per task in parallel evaluation, "
+        "levels with fewer than twice as many instructions are evaluated serially "
+        "(Default: 1000)"}},
       {"cse",
        {OT_BOOL,
         "Perform common subexpression elimination (complexity is N*log(N) in graph size)"}},
@@ -203,8 +518,14 @@ namespace casadi {
     Dict opts = FunctionInternal::generate_options(target);
     //opts["default_in"] = default_in_;
     opts["live_variables"] = live_variables_;
+    opts["schedule_locality"] = schedule_locality_;
+    opts["compact_tape"] = compact_tape_;
     opts["just_in_time_sparsity"] = just_in_time_sparsity_;
     opts["just_in_time_opencl"] = just_in_time_opencl_;
+    opts["jit_native"] = jit_native_;
+    opts["parallelization"] = parallelization_;
+    opts["parallel_grain"] = parallel_grain_;
+    opts["incremental"] = incremental_;
     return opts;
   }
 
@@ -215,6 +536,9 @@ namespace casadi {
 
     // Default (temporary) options
     live_variables_ = true;
+    schedule_locality_ = false;
+    compact_tape_ = false;
+    estimate_cache_ = false;
 
     bool cse_opt = false;
     bool allow_free = false;
@@ -225,10 +549,22 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables_ = op.second;
+      } else if (op.first=="schedule_locality") {
+        schedule_locality_ = op.second;
+      } else if (op.first=="compact_tape") {
+        compact_tape_ = op.second;
+      } else if (op.first=="estimate_cache") {
+        estimate_cache_ = op.second;
       } else if (op.first=="just_in_time_opencl") {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
         just_in_time_sparsity_ = op.second;
+      } else if (op.first=="jit_native") {
+        jit_native_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
+      } else if (op.first=="parallel_grain") {
+        parallel_grain_ = op.second;
       } else if (op.first=="cse") {
         cse_opt = op.second;
       } else if (op.first=="allow_free") {
@@ -236,6 +572,17 @@ namespace casadi {
       }
     }
 
+    casadi_assert(parallelization_=="serial" || parallelization_=="thread",
+      "Unknown parallelization '" + parallelization_ + "', expected 'serial' or 'thread'");
+    casadi_assert(parallel_grain_>0, "Option 'parallel_grain' must be positive");
+
+    // Reused work vector elements serialize otherwise independent instructions
+    if ((parallelization_=="thread" || incremental_) && opts.find("live_variables")==opts.end()) {
+      live_variables_ = false;
+    }
+    casadi_assert(!(incremental_ && live_variables_),
+      "Options 'incremental' and 'live_variables' cannot be combined");
+
     if (cse_opt) out_ = cse(out_);
 
     // Check/set default inputs
@@ -274,19 +621,6 @@ namespace casadi {
       }
     }
 
-    // Sort the nodes by type
-    constants_.clear();
-    operations_.clear();
-    for (std::vector<SXNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-      SXNode* t = *it;
-      if (t) {
-        if (t->is_constant())
-          constants_.push_back(SXElem::create(t));
-        else if (!t->is_symbolic())
-          operations_.push_back(SXElem::create(t));
-      }
-    }
-
     // Input instructions
     std::vector<std::pair<int, SXNode*> > symb_loc;
 
@@ -362,6 +696,45 @@ namespace casadi {
       algorithm_.push_back(ae);
     }
 
+    // Reorder the instructions, work vector indices still refer to the unsorted nodes
+    if (schedule_locality_) {
+      std::vector<casadi_int> order = schedule_locality(algorithm_);
+      casadi_int live_before = max_live(algorithm_, range(algorithm_.size()));
+      casadi_int live_after = max_live(algorithm_, order);
+      if (verbose_) casadi_message("Locality scheduling: at most " + str(live_after)
+        + " instead of " + str(live_before) + " live variables");
+      // Keep the original order unless the working set is reduced
+      if (live_after<live_before) {
+        std::vector<AlgEl> algorithm(algorithm_.size());
+        std::vector<SXNode*> sorted(nodes.size());
+        for (casadi_int k=0; k<order.size(); ++k) {
+          algorithm[k] = algorithm_[order[k]];
+          sorted[k] = nodes[order[k]];
+        }
+        algorithm_.swap(algorithm);
+        nodes.swap(sorted);
+        // Update the location of the inputs
+        symb_loc.clear();
+        for (casadi_int k=0; k<algorithm_.size(); ++k) {
+          if (algorithm_[k].op==OP_PARAMETER) symb_loc.push_back(std::make_pair(k, nodes[k]));
+        }
+      }
+    }
+
+    // Sort the nodes by type, in the order of execution
+    constants_.clear();
+    operations_.clear();
+    for (std::vector<SXNode*>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+      SXNode* t = *it;
+      if (t) {
+        if (t->is_constant())
+          constants_.push_back(SXElem::create(t));
+        else if (!t->is_symbolic())
+          operations_.push_back(SXElem::create(t));
+      }
+    }
+
+
     // Place in the work vector for each of the nodes in the tree (overwrites the reference counter)
     std::vector<int> place(nodes.size());
 
@@ -489,8 +862,245 @@ namespace casadi {
       casadi_error("OpenCL is not supported in this version of CasADi");
     }
 
+    // Translate to native machine code
+    if (jit_native_) init_native();
+
+    // Compact encoding for numerical evaluation
+    init_compact();
+
+    // Dependency levels for parallel evaluation
+    init_parallel();
+
+    // Dependency masks for incremental evaluation
+    init_incremental();
+
     // Print
-    if (verbose_) casadi_message(str(algorithm_.size()) + " elementary operations");
+    if (verbose_) {
+      casadi_message(str(algorithm_.size()) + " elementary operations");
+      Dict stats = info(), cache = cache_info();
+      casadi_message("Tape of " + str(stats["tape_bytes"]) + " bytes, "
+        + str(cache["cache_miss_rate_l1"]) + " (L1) and "
+        + str(cache["cache_miss_rate_l2"]) + " (L2) estimated cache miss rate");
+    }
+  }
+
+  void SXFunction::init_compact() {
+    compact_.clear();
+    compact_constants_.clear();
+    if (!compact_tape_ || !free_vars_.empty()) return;
+    // Make sure that all indices fit
+    const casadi_int max_ind = std::numeric_limits<uint16_t>::max();
+    if (worksize_>max_ind+1) return;
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_INPUT) {
+        if (e.i1>max_ind || e.i2>max_ind) return;
+      } else if (e.op==OP_OUTPUT) {
+        if (e.i0>max_ind || e.i2>max_ind) return;
+      }
+    }
+    // Translate
+    compact_.reserve(algorithm_.size());
+    for (auto&& e : algorithm_) {
+      CompactAtomic c;
+      c.op = static_cast<uint16_t>(e.op);
+      c.i0 = static_cast<uint16_t>(e.i0);
+      if (e.op==OP_CONST) {
+        uint32_t ind = static_cast<uint32_t>(compact_constants_.size());
+        compact_constants_.push_back(e.d);
+        c.i1 = static_cast<uint16_t>(ind & 0xFFFF);
+        c.i2 = static_cast<uint16_t>(ind >> 16);
+      } else {
+        c.i1 = static_cast<uint16_t>(e.i1);
+        c.i2 = static_cast<uint16_t>(e.i2);
+      }
+      compact_.push_back(c);
+    }
+  }
+
+  void SXFunction::init_parallel() {
+    par_algorithm_.clear();
+    par_stage_.clear();
+    par_parallel_.clear();
+    if (parallelization_!="thread" || !free_vars_.empty()) return;
+#ifndef CASADI_WITH_THREAD
+    casadi_warning(name_ + ": parallelization 'thread' requires thread support, "
+      "evaluating serially");
+    return;
+#endif // CASADI_WITH_THREAD
+    if (ThreadPool::default_size()<=1) return;
+
+    // Assign each instruction to the first level after the instructions that write its
+    // operands (read after write), and after the previous readers and writers of the work
+    // vector element it writes (write after read, write after write)
+    std::vector<casadi_int> level(algorithm_.size());
+    std::vector<casadi_int> last_write(worksize_, -1), last_read(worksize_, -1);
+    casadi_int n_level = 0;
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      casadi_int ndeps = e.op==OP_OUTPUT ? 1 : casadi_math<double>::ndeps(e.op);
+      casadi_int lev = 0;
+      if (ndeps>=1) lev = std::max(lev, last_write[e.i1]+1);
+      if (ndeps==2) lev = std::max(lev, last_write[e.i2]+1);
+      if (e.op!=OP_OUTPUT) {
+        lev = std::max(lev, std::max(last_read[e.i0], last_write[e.i0])+1);
+      }
+      if (ndeps>=1) last_read[e.i1] = std::max(last_read[e.i1], lev);
+      if (ndeps==2) last_read[e.i2] = std::max(last_read[e.i2], lev);
+      if (e.op!=OP_OUTPUT) {
+        last_write[e.i0] = lev;
+        last_read[e.i0] = -1;
+      }
+      level[k] = lev;
+      n_level = std::max(n_level, lev+1);
+    }
+
+    // Sort the instructions by level, keeping the original order within each level
+    std::vector<casadi_int> level_offset(n_level+1, 0);
+    for (casadi_int lev : level) level_offset[lev+1]++;
+    for (casadi_int lev=0; lev<n_level; ++lev) level_offset[lev+1] += level_offset[lev];
+    par_algorithm_.resize(algorithm_.size());
+    std::vector<casadi_int> pos(level_offset.begin(), level_offset.end()-1);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) par_algorithm_[pos[level[k]]++] = algorithm_[k];
+
+    // Evaluate large levels in parallel, merge consecutive small levels into serial stages
+    bool any_parallel = false;
+    par_stage_.push_back(0);
+    for (casadi_int lev=0; lev<n_level; ++lev) {
+      bool parallel = level_offset[lev+1]-level_offset[lev] >= 2*parallel_grain_;
+      if (parallel || par_parallel_.empty() || par_parallel_.back()) {
+        if (lev>0) par_stage_.push_back(level_offset[lev]);
+        par_parallel_.push_back(parallel);
+      }
+      any_parallel = any_parallel || parallel;
+    }
+    par_stage_.push_back(algorithm_.size());
+
+    if (verbose_) {
+      casadi_message(name_ + ": " + str(n_level) + " dependency levels in "
+        + str(par_parallel_.size()) + " stages");
+    }
+
+    // Nothing to gain
+    if (!any_parallel) {
+      par_algorithm_.clear();
+      par_stage_.clear();
+      par_parallel_.clear();
+    }
+  }
+
+  void SXFunction::init_incremental() {
+    incr_run_.clear();
+    incr_mask_.clear();
+    incr_output_.clear();
+    if (!incremental_) return;
+    // Input nonzero groups that each work vector element depends on
+    std::vector<bvec_t> dep(worksize_, 0);
+    casadi_int nnz = nnz_in();
+    std::vector<casadi_int> offset(n_in_+1, 0);
+    for (casadi_int i=0; i<n_in_; ++i) offset[i+1] = offset[i] + nnz_in(i);
+    // Split the algorithm into runs with the same dependencies
+    incr_run_.push_back(0);
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      bvec_t mask;
+      switch (e.op) {
+        case OP_CONST:
+        case OP_PARAMETER:
+          mask = 0;
+          break;
+        case OP_INPUT:
+          mask = incremental_bit(offset[e.i1] + e.i2, nnz);
+          break;
+        case OP_OUTPUT:
+          incr_output_.push_back(k);
+          // Part of the current run
+          mask = incr_mask_.empty() ? 0 : incr_mask_.back();
+          break;
+        default:
+          mask = dep[e.i1] | dep[e.i2];
+      }
+      if (e.op!=OP_OUTPUT) dep[e.i0] = mask;
+      if (incr_mask_.empty() || mask!=incr_mask_.back()) {
+        if (k>0) incr_run_.push_back(k);
+        incr_mask_.push_back(mask);
+      }
+    }
+    incr_run_.push_back(algorithm_.size());
+    if (incr_mask_.empty()) incr_run_.resize(1);
+    if (verbose_) {
+      casadi_message(name_ + ": " + str(incr_mask_.size()) + " runs for incremental evaluation");
+    }
+  }
+
+  Dict SXFunction::info() const {
+    Dict ret = XFunction<SXFunction, SX, SXNode>::info();
+    if (!par_stage_.empty()) {
+      casadi_int n_parallel = 0;
+      for (bool p : par_parallel_) if (p) n_parallel++;
+      ret["parallel_stages"] = static_cast<casadi_int>(par_parallel_.size());
+      ret["parallel_stages_threaded"] = n_parallel;
+    }
+    bool compact = !compact_.empty();
+    size_t el_size = compact ? sizeof(CompactAtomic) : sizeof(AlgEl);
+    ret["n_instructions"] = static_cast<casadi_int>(algorithm_.size());
+    ret["sz_w"] = static_cast<casadi_int>(worksize_);
+    ret["compact_tape"] = compact;
+    ret["native_code_bytes"] = static_cast<casadi_int>(native_ ? native_->code_size() : 0);
+    ret["tape_bytes"] = static_cast<casadi_int>(el_size*algorithm_.size()
+      + sizeof(double)*compact_constants_.size());
+    if (estimate_cache_) {
+      for (auto&& e : cache_info()) ret[e.first] = e.second;
+    }
+    return ret;
+  }
+
+  Dict SXFunction::cache_info() const {
+    Dict ret;
+    bool compact = !compact_.empty();
+    size_t el_size = compact ? sizeof(CompactAtomic) : sizeof(AlgEl);
+
+    // Estimate cache miss rates by replaying the memory accesses of one evaluation,
+    // 64-byte lines in a fully associative LRU cache of 32 KiB (L1) and 1 MiB (L2).
+    // The tape, the constant table and the work vector are assumed to be disjoint.
+    const size_t line = 64;
+    LruCache l1(32768/line), l2(1048576/line);
+    size_t tape_begin = 0;
+    size_t const_begin = tape_begin + el_size*algorithm_.size() + line;
+    size_t w_begin = const_begin + sizeof(double)*compact_constants_.size() + line;
+    auto access = [&](size_t addr) {
+      l1.access(addr/line);
+      l2.access(addr/line);
+    };
+    casadi_int n_const = 0;
+    for (casadi_int k=0; k<algorithm_.size(); ++k) {
+      const AlgEl& e = algorithm_[k];
+      access(tape_begin + el_size*k);
+      casadi_int ndeps = casadi_math<double>::ndeps(e.op);
+      if (e.op==OP_OUTPUT) {
+        access(w_begin + sizeof(double)*e.i1);
+        continue;
+      }
+      if (e.op==OP_CONST && compact) access(const_begin + sizeof(double)*n_const++);
+      if (ndeps>0) access(w_begin + sizeof(double)*e.i1);
+      if (ndeps>1) access(w_begin + sizeof(double)*e.i2);
+      access(w_begin + sizeof(double)*e.i0);
+    }
+    ret["cache_miss_rate_l1"] = l1.miss_rate();
+    ret["cache_miss_rate_l2"] = l2.miss_rate();
+    return ret;
+  }
+
+  void SXFunction::init_native() {
+    if (native_) delete native_;
+    native_ = nullptr;
+    if (!NativeJit::is_supported()) {
+      casadi_warning("Native code generation is not supported on this platform. "
+                     "Falling back to the virtual machine.");
+    } else if (free_vars_.empty()) {
+      native_ = new NativeJit(algorithm_, worksize_);
+      if (verbose_) casadi_message("Generated " + str(native_->code_size())
+        + " bytes of machine code");
+    }
   }
 
   SX SXFunction::instructions_sx() const {
@@ -860,6 +1470,115 @@ namespace casadi {
     return 0;
   }
 
+  /** \brief Forward sparsity propagation with nw bvec_t per nonzero, C words at a time
+
+      The words are staged in local arrays of fixed length, which allows the compiler to
+      use SIMD registers for the bitwise operations also when operands alias.
+  */
+  template<casadi_int C>
+  static void sp_forward_wide_alg(const std::vector<ScalarAtomic>& alg,
+      const bvec_t** arg, bvec_t** res, bvec_t* w, casadi_int nw) {
+    bvec_t s[C];
+    for (auto&& e : alg) {
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        std::fill_n(w + e.i0*nw, nw, 0);
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          std::fill_n(w + e.i0*nw, nw, 0);
+        } else {
+          std::copy_n(arg[e.i1] + e.i2*nw, nw, w + e.i0*nw);
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) std::copy_n(w + e.i1*nw, nw, res[e.i0] + e.i2*nw);
+        break;
+      default: // Unary or binary operation
+        for (casadi_int c=0; c<nw; c+=C) {
+          const bvec_t *x = w + e.i1*nw + c, *y = w + e.i2*nw + c;
+          bvec_t* r = w + e.i0*nw + c;
+          for (casadi_int j=0; j<C; ++j) s[j] = x[j] | y[j];
+          for (casadi_int j=0; j<C; ++j) r[j] = s[j];
+        }
+      }
+    }
+  }
+
+  /** \brief Reverse sparsity propagation with nw bvec_t per nonzero, C words at a time
+  */
+  template<casadi_int C>
+  static void sp_reverse_wide_alg(const std::vector<ScalarAtomic>& alg,
+      bvec_t** arg, bvec_t** res, bvec_t* w, casadi_int nw) {
+    bvec_t s[C];
+    for (auto it=alg.rbegin(); it!=alg.rend(); ++it) {
+      const ScalarAtomic& e = *it;
+      bvec_t* r = e.op==OP_OUTPUT ? w + e.i1*nw : w + e.i0*nw;
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        std::fill_n(r, nw, 0);
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]!=nullptr) {
+          bvec_t* a = arg[e.i1] + e.i2*nw;
+          for (casadi_int j=0; j<nw; ++j) a[j] |= r[j];
+        }
+        std::fill_n(r, nw, 0);
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) {
+          bvec_t* a = res[e.i0] + e.i2*nw;
+          for (casadi_int j=0; j<nw; ++j) r[j] |= a[j];
+          std::fill_n(a, nw, 0);
+        }
+        break;
+      default: // Unary or binary operation
+        for (casadi_int c=0; c<nw; c+=C, r+=C) {
+          bvec_t *x = w + e.i1*nw + c, *y = w + e.i2*nw + c;
+          for (casadi_int j=0; j<C; ++j) s[j] = r[j];
+          for (casadi_int j=0; j<C; ++j) r[j] = 0;
+          for (casadi_int j=0; j<C; ++j) x[j] |= s[j];
+          for (casadi_int j=0; j<C; ++j) y[j] |= s[j];
+        }
+      }
+    }
+  }
+
+  int SXFunction::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Fall back when forward mode not allowed
+    if (sp_weight()==1 || sp_weight()==-1)
+      return FunctionInternal::sp_forward_wide(arg, res, iw, w, mem, nw);
+    // Propagate sparsity forward, 256 or 512 bits at a time if possible
+    if (nw%8==0) {
+      sp_forward_wide_alg<8>(algorithm_, arg, res, w, nw);
+    } else if (nw%4==0) {
+      sp_forward_wide_alg<4>(algorithm_, arg, res, w, nw);
+    } else {
+      sp_forward_wide_alg<1>(algorithm_, arg, res, w, nw);
+    }
+    return 0;
+  }
+
+  int SXFunction::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    // Fall back when reverse mode not allowed
+    if (sp_weight()==0 || sp_weight()==-1)
+      return FunctionInternal::sp_reverse_wide(arg, res, iw, w, mem, nw);
+    std::fill_n(w, sz_w()*nw, 0);
+    // Propagate sparsity backward, 256 or 512 bits at a time if possible
+    if (nw%8==0) {
+      sp_reverse_wide_alg<8>(algorithm_, arg, res, w, nw);
+    } else if (nw%4==0) {
+      sp_reverse_wide_alg<4>(algorithm_, arg, res, w, nw);
+    } else {
+      sp_reverse_wide_alg<1>(algorithm_, arg, res, w, nw);
+    }
+    return 0;
+  }
+
   const SX SXFunction::sx_in(casadi_int ind) const {
     return in_.at(ind);
   }
@@ -975,7 +1694,7 @@ namespace casadi {
 
   SXFunction::SXFunction(DeserializingStream& s) :
     XFunction<SXFunction, SX, SXNode>(s) {
-    s.version("SXFunction", 1);
+    int version = s.version("SXFunction", 1, 4);
     size_t n_instructions;
     s.unpack("SXFunction::n_instr", n_instructions);
 
@@ -1000,12 +1719,34 @@ namespace casadi {
 
     s.unpack("SXFunction::live_variables", live_variables_);
 
+    jit_native_ = false;
+    native_ = nullptr;
+    if (version>=2) s.unpack("SXFunction::jit_native", jit_native_);
+    schedule_locality_ = false;
+    compact_tape_ = false;
+    estimate_cache_ = false;
+    if (version>=3) {
+      s.unpack("SXFunction::schedule_locality", schedule_locality_);
+      s.unpack("SXFunction::compact_tape", compact_tape_);
+    }
+    parallelization_ = "serial";
+    parallel_grain_ = 1000;
+    if (version>=4) {
+      s.unpack("SXFunction::parallelization", parallelization_);
+      s.unpack("SXFunction::parallel_grain", parallel_grain_);
+    }
+
     XFunction<SXFunction, SX, SXNode>::delayed_deserialize_members(s);
+
+    if (jit_native_) init_native();
+    init_compact();
+    init_parallel();
+    init_incremental();
   }
 
   void SXFunction::serialize_body(SerializingStream &s) const {
     XFunction<SXFunction, SX, SXNode>::serialize_body(s);
-    s.version("SXFunction", 1);
+    s.version("SXFunction", 4);
     s.pack("SXFunction::n_instr", algorithm_.size());
 
     s.pack("SXFunction::worksize", worksize_);
@@ -1023,6 +1764,11 @@ namespace casadi {
     }
 
     s.pack("SXFunction::live_variables", live_variables_);
+    s.pack("SXFunction::jit_native", jit_native_);
+    s.pack("SXFunction::schedule_locality", schedule_locality_);
+    s.pack("SXFunction::compact_tape", compact_tape_);
+    s.pack("SXFunction::parallelization", parallelization_);
+    s.pack("SXFunction::parallel_grain", parallel_grain_);
 
     XFunction<SXFunction, SX, SXNode>::delayed_serialize_members(s);
   }
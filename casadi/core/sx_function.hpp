@@ -27,10 +27,14 @@
 #define CASADI_SX_FUNCTION_HPP
 
 #include "x_function.hpp"
+#include <cstdint>
 
 /// \cond INTERNAL
 
 namespace casadi {
+  // Forward declaration
+  class NativeJit;
+
   /** \brief  An atomic operation for the SXElem virtual machine
 
       \identifier{ua} */
@@ -43,6 +47,16 @@ namespace casadi {
     };
   };
 
+  /** \brief  A compact, 8-byte encoding of ScalarAtomic
+
+      Used for evaluation when the work vector, the input and output indices and
+      the nonzero indices all fit in 16 bits. Constants are stored in a separate
+      table, indexed by i1 + 2^16*i2.
+  */
+  struct CompactAtomic {
+    uint16_t op, i0, i1, i2;
+  };
+
 /** \brief  Internal node class for SXFunction
 
     Do not use any internal class directly - always use the public Function
@@ -72,6 +86,20 @@ class CASADI_EXPORT SXFunction :
       \identifier{ue} */
   int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+  /** \brief Can the function be evaluated for several inputs at once with eval_batch?
+  */
+  bool has_eval_batch() const;
+
+  /** \brief Evaluate numerically for n sets of inputs in a single pass over the algorithm
+
+      Input i of evaluation k is read from arg[i] + k*nnz_in(i) and output i is written to
+      res[i] + k*nnz_out(i), i.e. the layout used by Map. The work vector w must hold
+      n*sz_w() elements and is used in a structure-of-arrays layout, so that each instruction
+      is dispatched once and evaluated with a vector-vector kernel over all n evaluations.
+  */
+  int eval_batch(const double** arg, double** res,
+    casadi_int* iw, double* w, casadi_int n) const;
+
   /** \brief  evaluate symbolically while also propagating directional derivatives
 
       \identifier{uf} */
@@ -95,6 +123,17 @@ class CASADI_EXPORT SXFunction :
   void ad_reverse(const std::vector<std::vector<SX> >& aseed,
                             std::vector<std::vector<SX> >& asens) const;
 
+  /** \brief Obtain information about the function
+
+      Reports the tape size for numerical evaluation, and a cache miss rate estimate
+      if the option estimate_cache is set
+  */
+  Dict info() const override;
+
+  /** \brief Estimated cache miss rates of one numerical evaluation
+  */
+  Dict cache_info() const;
+
   /** \brief  Check if smooth
 
       \identifier{ui} */
@@ -234,6 +273,12 @@ class CASADI_EXPORT SXFunction :
   /// Default input values
   std::vector<double> default_in_;
 
+  /// Compact encoding of the algorithm for numerical evaluation, if any
+  std::vector<CompactAtomic> compact_;
+
+  /// Constants referenced by the compact encoding
+  std::vector<double> compact_constants_;
+
     /** \brief Serialize an object without type information
 
         \identifier{v0} */
@@ -260,6 +305,24 @@ class CASADI_EXPORT SXFunction :
       \identifier{v3} */
   void init(const Dict& opts) override;
 
+  /** \brief Translate the algorithm to native machine code */
+  void init_native();
+
+  /** \brief Generate the compact encoding of the algorithm, if possible */
+  void init_compact();
+
+  /** \brief Sort the algorithm into dependency levels for parallel evaluation */
+  void init_parallel();
+
+  /** \brief Evaluate level by level, distributing large levels over the thread pool */
+  int eval_parallel(const double** arg, double** res, double* w) const;
+
+  /** \brief Group the algorithm by input dependencies for incremental evaluation */
+  void init_incremental();
+
+  /** \brief Reevaluate the instructions that depend on changed inputs */
+  int eval_incremental(const double** arg, double** res, XFunctionMemory* m) const;
+
   /** \brief Generate code for the declarations of the C function
 
       \identifier{v4} */
@@ -281,6 +344,17 @@ class CASADI_EXPORT SXFunction :
       \identifier{v7} */
   int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+  /** \brief Is sparsity propagation with several bvec_t per nonzero supported natively? */
+  bool has_sp_wide() const override { return true;}
+
+  /** \brief  Propagate sparsity forward, nw consecutive bvec_t per nonzero */
+  int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+    casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
+  /** \brief  Propagate sparsity backwards, nw consecutive bvec_t per nonzero */
+  int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+    casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
   /** *\brief get SX expression associated with instructions
 
        \identifier{v8} */
@@ -306,6 +380,45 @@ class CASADI_EXPORT SXFunction :
   /// Live variables?
   bool live_variables_;
 
+  /// Reorder instructions for locality?
+  bool schedule_locality_;
+
+  /// Use the compact encoding when possible?
+  bool compact_tape_;
+
+  /// Report estimated cache miss rates in info()?
+  bool estimate_cache_;
+
+  /// Translate the algorithm to native machine code?
+  bool jit_native_;
+
+  /// Native machine code, if any
+  NativeJit* native_;
+
+  /// Evaluation strategy, "serial" or "thread"
+  std::string parallelization_;
+
+  /// Smallest number of instructions per task in parallel evaluation
+  casadi_int parallel_grain_;
+
+  /// The algorithm sorted by dependency level, if evaluated in parallel
+  std::vector<AlgEl> par_algorithm_;
+
+  /// Stage k is par_algorithm_[par_stage_[k]] to par_algorithm_[par_stage_[k+1]-1]
+  std::vector<casadi_int> par_stage_;
+
+  /// Are the instructions of a stage independent?
+  std::vector<bool> par_parallel_;
+
+  /// Runs of instructions with the same input dependencies, for incremental evaluation
+  std::vector<casadi_int> incr_run_;
+
+  /// Input nonzero groups that each run depends on
+  std::vector<bvec_t> incr_mask_;
+
+  /// Output instructions, executed in every incremental evaluation
+  std::vector<casadi_int> incr_output_;
+
 protected:
   /** \brief Deserializing constructor
 
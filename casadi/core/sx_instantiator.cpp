@@ -47,6 +47,11 @@ namespace casadi {
     return SXNode::eq_depth_;
   }
 
+  template<>
+  Dict CASADI_EXPORT SX::memory_usage() {
+    return SXNode::memory_usage();
+  }
+
   template<>
   SX CASADI_EXPORT SX::_sym(const std::string& name, const Sparsity& sp) {
     // Create a dense n-by-m matrix
@@ -1158,5 +1163,14 @@ namespace casadi {
     casadi_error("Not implemented");
   }
 
+  // The member specializations above instantiate the class implicitly, so GCC ignores
+  // the export attribute here, other compilers (dllexport) still need it
+#if __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#endif
   template class CASADI_EXPORT Matrix< SXElem >;
+#if __GNUC__
+#pragma GCC diagnostic pop
+#endif
 } // namespace casadi
@@ -29,9 +29,20 @@
 #include "binary_sx.hpp"
 #include "constant_sx.hpp"
 #include "symbolic_sx.hpp"
+#include "global_options.hpp"
+#include "generic_type.hpp"
 
 #include <limits>
 #include <stack>
+#include <algorithm>
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <atomic>
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
 namespace casadi {
 
@@ -197,6 +208,200 @@ namespace casadi {
 
   casadi_int SXNode::eq_depth_ = 1;
 
+  /** \brief Pool of fixed-size blocks for SXNode allocation
+
+      Memory is reserved in chunks, each of which holds nodes of a single size class.
+      Freed blocks are kept in a per-chunk free list, a chunk where all blocks have
+      been freed is released as a whole.
+  */
+  class SXNodePool {
+  public:
+    // Bytes per chunk
+    static const size_t chunk_bytes = 1 << 20;
+
+    // Size classes 8, 16, ..., 8*n_class bytes
+    static const size_t n_class = 8;
+
+    // A chunk of memory
+    struct Chunk {
+      char* data;
+      size_t obj_size, cap, bump, live;
+      void* free;
+      bool partial;
+    };
+
+    SXNodePool() : bytes_in_use_(0), peak_bytes_(0), n_alloc_(0), n_free_(0), last_(nullptr) {
+      std::fill(current_, current_+n_class, nullptr);
+    }
+
+    // Singleton, never destroyed since nodes may be freed during static destruction
+    static SXNodePool& instance() {
+      static SXNodePool* pool = new SXNodePool();
+      return *pool;
+    }
+
+    // Allocate a block, nullptr if the size is not pooled
+    void* allocate(size_t sz) {
+      if (sz==0 || sz>8*n_class) return nullptr;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      size_t c = (sz+7)/8-1;
+      Chunk* ch = current_[c];
+      if (ch==nullptr || (ch->free==nullptr && ch->bump==ch->cap)) ch = current_[c] = next(c);
+      void* ret;
+      if (ch->free) {
+        ret = ch->free;
+        ch->free = *static_cast<void**>(ret);
+      } else {
+        ret = ch->data + ch->obj_size*ch->bump++;
+      }
+      ch->live++;
+      bytes_in_use_ += ch->obj_size;
+      n_alloc_++;
+      return ret;
+    }
+
+    // Free a block, false if it is not in the pool
+    bool deallocate(void* ptr) {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      Chunk* ch = find(static_cast<char*>(ptr));
+      if (ch==nullptr) return false;
+      *static_cast<void**>(ptr) = ch->free;
+      ch->free = ptr;
+      ch->live--;
+      bytes_in_use_ -= ch->obj_size;
+      n_free_++;
+      size_t c = ch->obj_size/8-1;
+      if (ch!=current_[c]) {
+        if (ch->live==0) {
+          release(ch);
+        } else if (!ch->partial) {
+          ch->partial = true;
+          partial_[c].push_back(ch);
+        }
+      }
+      return true;
+    }
+
+    // Statistics
+    void stats(Dict& st) const {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      st["pool_chunks"] = static_cast<casadi_int>(chunks_.size());
+      st["pool_bytes_reserved"] = static_cast<casadi_int>(chunks_.size()*chunk_bytes);
+      st["pool_bytes_peak"] = static_cast<casadi_int>(peak_bytes_);
+      st["pool_bytes_in_use"] = static_cast<casadi_int>(bytes_in_use_);
+      st["pool_n_alloc"] = static_cast<casadi_int>(n_alloc_);
+      st["pool_n_free"] = static_cast<casadi_int>(n_free_);
+    }
+
+  private:
+    // Get a chunk with free blocks for a size class
+    Chunk* next(size_t c) {
+      // Reuse a partially freed chunk, if any
+      if (!partial_[c].empty()) {
+        Chunk* ch = partial_[c].back();
+        partial_[c].pop_back();
+        ch->partial = false;
+        return ch;
+      }
+      // Reserve a new chunk
+      Chunk* ch = new Chunk();
+      ch->obj_size = 8*(c+1);
+      ch->cap = chunk_bytes/ch->obj_size;
+      ch->data = new char[ch->cap*ch->obj_size];
+      ch->bump = ch->live = 0;
+      ch->free = nullptr;
+      ch->partial = false;
+      auto it = std::upper_bound(chunks_.begin(), chunks_.end(), ch, cmp);
+      chunks_.insert(it, ch);
+      peak_bytes_ = std::max(peak_bytes_, chunks_.size()*chunk_bytes);
+      return ch;
+    }
+
+    // Return a chunk to the system
+    void release(Chunk* ch) {
+      size_t c = ch->obj_size/8-1;
+      if (ch->partial) {
+        partial_[c].erase(std::find(partial_[c].begin(), partial_[c].end(), ch));
+      }
+      chunks_.erase(std::lower_bound(chunks_.begin(), chunks_.end(), ch, cmp));
+      if (last_==ch) last_ = nullptr;
+      delete[] ch->data;
+      delete ch;
+    }
+
+    // Locate the chunk containing a block
+    Chunk* find(char* ptr) {
+      // Consecutive frees tend to hit the same chunk
+      if (last_ && ptr>=last_->data && ptr<end(last_)) return last_;
+      if (chunks_.empty()) return nullptr;
+      auto it = std::upper_bound(chunks_.begin(), chunks_.end(), ptr,
+        [](char* p, const Chunk* ch) { return p < ch->data;});
+      if (it==chunks_.begin()) return nullptr;
+      Chunk* ch = *--it;
+      if (ptr>=end(ch)) return nullptr;
+      return last_ = ch;
+    }
+
+    static bool cmp(const Chunk* a, const Chunk* b) { return a->data < b->data;}
+
+    static char* end(const Chunk* ch) { return ch->data + ch->cap*ch->obj_size;}
+
+    // All chunks, sorted by address
+    std::vector<Chunk*> chunks_;
+    // Chunk being filled, for each size class
+    Chunk* current_[n_class];
+    // Chunks with free blocks, for each size class
+    std::vector<Chunk*> partial_[n_class];
+    // Statistics
+    size_t bytes_in_use_, peak_bytes_, n_alloc_, n_free_;
+    // Most recently located chunk
+    Chunk* last_;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    // Nodes are allocated and freed from any thread
+    mutable std::mutex mtx_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+  };
+
+  // Live nodes and their size, pooled or not
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+  static std::atomic<size_t> sx_node_count(0), sx_node_bytes(0);
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
+  static size_t sx_node_count = 0, sx_node_bytes = 0;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
+  void* SXNode::operator new(std::size_t sz) {
+    sx_node_count++;
+    sx_node_bytes += sz;
+    if (GlobalOptions::sx_node_pool) {
+      void* ret = SXNodePool::instance().allocate(sz);
+      if (ret) return ret;
+    }
+    return ::operator new(sz);
+  }
+
+  void SXNode::operator delete(void* ptr, std::size_t sz) {
+    if (ptr==nullptr) return;
+    sx_node_count--;
+    sx_node_bytes -= sz;
+    // Blocks allocated while the pool was enabled are returned to the pool
+    if (!SXNodePool::instance().deallocate(ptr)) ::operator delete(ptr);
+  }
+
+  Dict SXNode::memory_usage() {
+    Dict st;
+    st["sx_node_pool"] = GlobalOptions::sx_node_pool;
+    st["n_nodes"] = static_cast<casadi_int>(sx_node_count);
+    st["node_bytes"] = static_cast<casadi_int>(sx_node_bytes);
+    SXNodePool::instance().stats(st);
+    return st;
+  }
+
   void SXNode::serialize_node(SerializingStream& s) const {
     casadi_error("'serialize_node' not defined for class " + class_name());
   }
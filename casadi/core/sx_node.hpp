@@ -30,6 +30,9 @@
 #include <math.h>
 #include <sstream>
 #include <string>
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+#include <atomic>
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class)
 
@@ -157,17 +160,37 @@ namespace casadi {
         \identifier{a9} */
     static void safe_delete(SXNode* n);
 
+    ///@{
+    /** \brief Allocate and free nodes
+
+        Nodes are taken from a pool of fixed-size blocks when
+        GlobalOptions::sx_node_pool is set. A block of pool memory is returned to the
+        system as soon as all nodes allocated in it have been freed. The pool is only
+        thread-safe with CASADI_WITH_THREADSAFE_SYMBOLICS.
+    */
+    static void* operator new(std::size_t sz);
+    static void operator delete(void* ptr, std::size_t sz);
+    ///@}
+
+    /** \brief Memory usage of SX nodes, including node pool statistics */
+    static Dict memory_usage();
+
     // Depth when checking equalities
     static casadi_int eq_depth_;
 
     /** Temporary variables to be used in user algorithms like sorting,
-        the user is responsible of making sure that use is thread-safe
+        the user is responsible of making sure that use is thread-safe,
+        e.g. by only building Functions from expressions not used by other threads.
         The variable is initialized to zero
     */
     mutable int temp;
 
     // Reference counter -- counts the number of parents of the node
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::atomic<unsigned int> count;
+#else // CASADI_WITH_THREADSAFE_SYMBOLICS
     unsigned int count;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
     /** \brief Serialize an object
 
@@ -0,0 +1,318 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "thread_pool.hpp"
+#include "global_options.hpp"
+#include "exception.hpp"
+
+#if defined(CASADI_WITH_THREAD) && defined(__linux__) && !defined(CASADI_WITH_THREAD_MINGW)
+#include <pthread.h>
+#include <sched.h>
+#define CASADI_THREAD_POOL_PINNING
+#endif
+
+namespace casadi {
+
+#ifdef CASADI_WITH_THREAD
+  struct ThreadPool::Batch {
+    // Function to be evaluated for every task
+    const std::function<int(casadi_int)>* f;
+    // Return flags, one per task
+    std::vector<int> ret;
+    // Number of tasks not yet completed
+    std::atomic<casadi_int> n_pending;
+    // Signal completion
+    std::mutex mtx;
+    std::condition_variable cv;
+    // Owned function of a submitted task, nobody waits for the batch
+    std::function<int(casadi_int)> own;
+    bool detached = false;
+  };
+
+  // Index of the worker owning the current thread, -1 if not a worker
+  thread_local casadi_int thread_pool_worker = -1;
+
+  // Pool of that worker, a retired pool may still be finishing its tasks
+  thread_local const ThreadPool* thread_pool_owner = nullptr;
+
+  // Index of the worker of pool p owning the current thread, -1 if not a worker of p
+  inline casadi_int thread_pool_worker_of(const ThreadPool* p) {
+    return thread_pool_owner==p ? thread_pool_worker : -1;
+  }
+#endif // CASADI_WITH_THREAD
+
+  casadi_int ThreadPool::default_size() {
+    casadi_int n = GlobalOptions::thread_pool_size;
+#ifdef CASADI_WITH_THREAD
+    if (n<=0) n = std::thread::hardware_concurrency();
+#endif // CASADI_WITH_THREAD
+    return std::max(n, casadi_int(1));
+  }
+
+  std::shared_ptr<ThreadPool> ThreadPool::instance() {
+#ifdef CASADI_WITH_THREAD
+    static std::mutex mtx;
+    std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREAD
+    static std::shared_ptr<ThreadPool> pool;
+    casadi_int size = default_size();
+    bool pinning = GlobalOptions::thread_pool_pinning;
+    if (!pool) {
+      pool.reset(new ThreadPool(size, pinning));
+    } else if (pool->size_!=size || pool->pinning_!=pinning) {
+#ifdef CASADI_WITH_THREAD
+      // Only reconfigure an idle pool, never from within a worker
+      if (pool->n_active_==0 && thread_pool_worker<0) {
+        pool.reset(new ThreadPool(size, pinning));
+      }
+#else // CASADI_WITH_THREAD
+      pool.reset(new ThreadPool(size, pinning));
+#endif // CASADI_WITH_THREAD
+    }
+    return pool;
+  }
+
+  ThreadPool::ThreadPool(casadi_int size, bool pinning) : size_(size), pinning_(pinning) {
+#ifdef CASADI_WITH_THREAD
+    n_queued_ = 0;
+    n_active_ = 0;
+    next_queue_ = 0;
+    stop_ = false;
+    for (casadi_int k=0; k<size_; ++k) queues_.emplace_back(new Queue());
+    for (casadi_int k=0; k<size_; ++k) {
+      workers_.emplace_back([this, k]() { work(k); });
+#ifdef CASADI_THREAD_POOL_PINNING
+      if (pinning_) {
+        casadi_int n_cpu = std::max(std::thread::hardware_concurrency(), 1u);
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(k % n_cpu, &cpuset);
+        if (pthread_setaffinity_np(workers_.back().native_handle(), sizeof(cpu_set_t), &cpuset)) {
+          casadi_warning("Failed to pin thread pool worker " + str(k) + " to a core.");
+        }
+      }
+#endif // CASADI_THREAD_POOL_PINNING
+    }
+#ifndef CASADI_THREAD_POOL_PINNING
+    if (pinning_) casadi_warning("Pinning of thread pool workers not supported on this platform.");
+#endif // CASADI_THREAD_POOL_PINNING
+#endif // CASADI_WITH_THREAD
+  }
+
+  ThreadPool::~ThreadPool() {
+#ifdef CASADI_WITH_THREAD
+    {
+      std::lock_guard<std::mutex> lock(idle_mtx_);
+      stop_ = true;
+    }
+    idle_cv_.notify_all();
+    for (auto&& th : workers_) th.join();
+#endif // CASADI_WITH_THREAD
+  }
+
+  int ThreadPool::run(casadi_int n, const std::function<int(casadi_int)>& f) {
+#ifdef CASADI_WITH_THREAD
+    if (n>1) return run_parallel(n, f);
+#endif // CASADI_WITH_THREAD
+    // Serial evaluation
+    int ret = 0;
+    for (casadi_int i=0; i<n; ++i) {
+      try {
+        ret = f(i) || ret;
+      } catch (std::exception& e) {
+        ret = 1;
+        casadi_warning("Exception raised: " + std::string(e.what()));
+      } catch (...) {
+        ret = 1;
+        casadi_warning("Uncaught exception.");
+      }
+    }
+    return ret;
+  }
+
+  void ThreadPool::submit(std::function<void()> f) {
+#ifdef CASADI_WITH_THREAD
+    Batch* b = new Batch();
+    b->own = [f](casadi_int) { f(); return 0;};
+    b->f = &b->own;
+    b->ret.resize(1, 0);
+    b->n_pending = 1;
+    b->detached = true;
+    n_active_++;
+    casadi_int k = thread_pool_worker_of(this);
+    if (k<0) k = next_queue_++ % size_;
+    {
+      Queue& q = *queues_[k];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      q.tasks.push_back({b, 0});
+    }
+    {
+      std::lock_guard<std::mutex> lock(idle_mtx_);
+      n_queued_++;
+    }
+    idle_cv_.notify_one();
+#else // CASADI_WITH_THREAD
+    try {
+      f();
+    } catch (std::exception& e) {
+      casadi_warning("Exception raised: " + std::string(e.what()));
+    } catch (...) {
+      casadi_warning("Uncaught exception.");
+    }
+#endif // CASADI_WITH_THREAD
+  }
+
+#ifdef CASADI_WITH_THREAD
+  void ThreadPool::wait(const std::function<bool()>& done,
+      std::mutex& mtx, std::condition_variable& cv) {
+    casadi_int k = thread_pool_worker_of(this);
+    if (k>=0) {
+      // Keep the worker busy with queued tasks
+      Task t;
+      while (true) {
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          if (done()) return;
+        }
+        if (take(k, t)) {
+          execute(t);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, done);
+  }
+
+  int ThreadPool::run_parallel(casadi_int n, const std::function<int(casadi_int)>& f) {
+    // Prepare batch
+    Batch b;
+    b.f = &f;
+    b.ret.resize(n, 0);
+    b.n_pending = n;
+    n_active_++;
+
+    // Distribute the tasks over the queues, starting with our own if we are a worker
+    casadi_int k0 = thread_pool_worker_of(this);
+    if (k0<0) k0 = next_queue_++ % size_;
+    for (casadi_int i=0; i<n; ++i) {
+      Queue& q = *queues_[(k0 + i) % size_];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      q.tasks.push_back({&b, i});
+    }
+    {
+      std::lock_guard<std::mutex> lock(idle_mtx_);
+      n_queued_ += n;
+    }
+    idle_cv_.notify_all();
+
+    // Help out until all tasks of the batch have been completed
+    Task t;
+    while (b.n_pending>0) {
+      if (take(k0, t)) {
+        execute(t);
+      } else {
+        std::unique_lock<std::mutex> lock(b.mtx);
+        b.cv.wait(lock, [&b]() { return b.n_pending==0;});
+      }
+    }
+    // Make sure the last task has released the batch before it goes out of scope
+    { std::lock_guard<std::mutex> lock(b.mtx); }
+    n_active_--;
+
+    // Collect return flags
+    int ret = 0;
+    for (int e : b.ret) ret = ret || e;
+    return ret;
+  }
+
+  bool ThreadPool::take(casadi_int k, Task& t) {
+    if (n_queued_==0) return false;
+    // Own queue: last in, first out
+    {
+      Queue& q = *queues_[k];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.tasks.empty()) {
+        t = q.tasks.back();
+        q.tasks.pop_back();
+        n_queued_--;
+        return true;
+      }
+    }
+    // Steal from the other queues: first in, first out
+    for (casadi_int i=1; i<size_; ++i) {
+      Queue& q = *queues_[(k + i) % size_];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.tasks.empty()) {
+        t = q.tasks.front();
+        q.tasks.pop_front();
+        n_queued_--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void ThreadPool::execute(const Task& t) {
+    Batch& b = *t.batch;
+    try {
+      b.ret[t.ind] = (*b.f)(t.ind);
+    } catch (std::exception& e) {
+      b.ret[t.ind] = 1;
+      casadi_warning("Exception raised: " + std::string(e.what()));
+    } catch (...) {
+      b.ret[t.ind] = 1;
+      casadi_warning("Uncaught exception.");
+    }
+    // Submitted tasks clean up after themselves
+    if (b.detached) {
+      delete t.batch;
+      n_active_--;
+      return;
+    }
+    // Last task to finish wakes up the submitting thread
+    std::lock_guard<std::mutex> lock(b.mtx);
+    if (--b.n_pending==0) b.cv.notify_all();
+  }
+
+  void ThreadPool::work(casadi_int k) {
+    thread_pool_worker = k;
+    thread_pool_owner = this;
+    Task t;
+    while (true) {
+      if (take(k, t)) {
+        execute(t);
+      } else {
+        std::unique_lock<std::mutex> lock(idle_mtx_);
+        idle_cv_.wait(lock, [this]() { return stop_ || n_queued_>0;});
+        // Submitted tasks are completed before shutting down
+        if (stop_ && n_queued_==0) return;
+      }
+    }
+  }
+#endif // CASADI_WITH_THREAD
+
+} // namespace casadi
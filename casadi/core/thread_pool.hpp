@@ -0,0 +1,173 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_THREAD_POOL_HPP
+#define CASADI_THREAD_POOL_HPP
+
+#include "casadi_common.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#include <atomic>
+#include <deque>
+#endif // CASADI_WITH_THREAD
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Process-wide pool of persistent worker threads
+   *
+   * Each worker owns a task deque. Workers pop from the back of their own
+   * deque and, when it runs dry, steal from the front of the other deques.
+   * A thread waiting for a batch of tasks helps executing queued tasks, so
+   * nested parallel regions (e.g. a ThreadMap inside a ThreadMap) cannot
+   * deadlock the pool.
+   *
+   * The number of workers and whether workers are pinned to cores are taken
+   * from GlobalOptions. Changes take effect the next time the pool is
+   * retrieved while it is idle.
+   *
+   * Without CASADI_WITH_THREAD, all work is executed serially by the caller.
+   */
+  class CASADI_EXPORT ThreadPool {
+  public:
+    /// Destructor, joins all workers
+    ~ThreadPool();
+
+    /** \brief Get the process-wide instance, (re)creating it if needed
+
+     * A reconfigured pool replaces the process-wide instance, the previous one
+     * is destroyed when the last caller holding it is done with it.
+     */
+    static std::shared_ptr<ThreadPool> instance();
+
+    /// Number of workers requested in GlobalOptions (resolved if zero)
+    static casadi_int default_size();
+
+    /// Number of worker threads
+    casadi_int size() const { return size_;}
+
+    /** \brief Evaluate f(0), ..., f(n-1) concurrently and wait for completion
+     *
+     * The calling thread participates in the evaluation.
+     * Exceptions are caught and reported as a nonzero return value.
+     */
+    int run(casadi_int n, const std::function<int(casadi_int)>& f);
+
+    /** \brief Enqueue f for evaluation by a worker and return immediately
+     *
+     * Without CASADI_WITH_THREAD, f is evaluated by the caller before returning.
+     * Exceptions are caught and reported as warnings.
+     */
+    void submit(std::function<void()> f);
+
+#ifdef CASADI_WITH_THREAD
+    /** \brief Wait until done() holds, cv is notified when it changes
+     *
+     * Called from a worker, queued tasks are executed while waiting so that a
+     * worker waiting for a submitted task cannot starve the pool.
+     */
+    void wait(const std::function<bool()>& done, std::mutex& mtx, std::condition_variable& cv);
+#endif // CASADI_WITH_THREAD
+
+  private:
+    /// Constructor, spawns the workers
+    ThreadPool(casadi_int size, bool pinning);
+
+    /// Number of worker threads
+    casadi_int size_;
+
+    /// Are workers pinned to cores?
+    bool pinning_;
+
+#ifdef CASADI_WITH_THREAD
+    /// A batch of tasks submitted through a single call to run
+    struct Batch;
+
+    /// A unit of work in a queue
+    struct Task {
+      Batch* batch;
+      casadi_int ind;
+    };
+
+    /// Per-worker task queue
+    struct Queue {
+      std::mutex mtx;
+      std::deque<Task> tasks;
+    };
+
+    /// Evaluate a batch of more than one task in parallel
+    int run_parallel(casadi_int n, const std::function<int(casadi_int)>& f);
+
+    /// Main loop of a worker
+    void work(casadi_int k);
+
+    /// Try to take a task, starting with queue k; returns false if all queues are empty
+    bool take(casadi_int k, Task& t);
+
+    /// Execute a task and signal its batch upon completion
+    void execute(const Task& t);
+
+    /// Task queues, one per worker
+    std::vector<std::unique_ptr<Queue> > queues_;
+
+    /// Worker threads
+    std::vector<std::thread> workers_;
+
+    /// Idle workers sleep on this condition variable
+    std::mutex idle_mtx_;
+    std::condition_variable idle_cv_;
+
+    /// Number of queued tasks not yet taken
+    std::atomic<casadi_int> n_queued_;
+
+    /// Number of batches in flight, including submitted tasks
+    std::atomic<casadi_int> n_active_;
+
+    /// Shutting down?
+    bool stop_;
+
+    /// Round-robin counter for distributing tasks
+    std::atomic<casadi_int> next_queue_;
+#endif // CASADI_WITH_THREAD
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_THREAD_POOL_HPP
@@ -186,6 +186,88 @@ namespace casadi {
     return 0;
   }
 
+  int Transpose::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Shorthands
+    const bvec_t *x = arg[0];
+    bvec_t *xT = res[0];
+
+    // Get sparsity
+    casadi_int nz = nnz();
+    const casadi_int* x_row = dep().row();
+    const casadi_int* xT_colind = sparsity().colind();
+    casadi_int xT_ncol = sparsity().size2();
+
+    // Loop over the nonzeros of the argument
+    std::copy(xT_colind, xT_colind+xT_ncol+1, iw);
+    for (casadi_int el=0; el<nz; ++el) {
+      std::copy_n(x, nw, xT + nw*iw[*x_row++]++);
+      x += nw;
+    }
+    return 0;
+  }
+
+  int Transpose::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Shorthands
+    bvec_t *x = arg[0];
+    bvec_t *xT = res[0];
+
+    // Get sparsity
+    casadi_int nz = nnz();
+    const casadi_int* x_row = dep().row();
+    const casadi_int* xT_colind = sparsity().colind();
+    casadi_int xT_ncol = sparsity().size2();
+
+    // Loop over the nonzeros of the argument
+    std::copy(xT_colind, xT_colind+xT_ncol+1, iw);
+    for (casadi_int el=0; el<nz; ++el) {
+      bvec_t* xTel = xT + nw*iw[*x_row++]++;
+      for (casadi_int j=0; j<nw; ++j) x[j] |= xTel[j];
+      std::fill_n(xTel, nw, 0);
+      x += nw;
+    }
+    return 0;
+  }
+
+  int DenseTranspose::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Shorthands
+    const bvec_t *x = arg[0];
+    bvec_t *xT = res[0];
+    casadi_int x_nrow = dep().size1();
+    casadi_int x_ncol = dep().size2();
+
+    // Loop over the elements
+    for (casadi_int rr=0; rr<x_nrow; ++rr) {
+      for (casadi_int cc=0; cc<x_ncol; ++cc) {
+        std::copy_n(x + nw*(rr+cc*x_nrow), nw, xT);
+        xT += nw;
+      }
+    }
+    return 0;
+  }
+
+  int DenseTranspose::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    // Shorthands
+    bvec_t *x = arg[0];
+    bvec_t *xT = res[0];
+    casadi_int x_nrow = dep().size1();
+    casadi_int x_ncol = dep().size2();
+
+    // Loop over the elements
+    for (casadi_int rr=0; rr<x_nrow; ++rr) {
+      for (casadi_int cc=0; cc<x_ncol; ++cc) {
+        bvec_t* xel = x + nw*(rr+cc*x_nrow);
+        for (casadi_int j=0; j<nw; ++j) xel[j] |= xT[j];
+        std::fill_n(xT, nw, 0);
+        xT += nw;
+      }
+    }
+    return 0;
+  }
+
   std::string Transpose::disp(const std::vector<std::string>& arg) const {
     return arg.at(0) + "'";
   }
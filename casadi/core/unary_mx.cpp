@@ -99,6 +99,18 @@ namespace casadi {
     return 0;
   }
 
+  int UnaryMX::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    copy_fwd(arg[0], res[0], nnz()*nw);
+    return 0;
+  }
+
+  int UnaryMX::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, casadi_int nw) const {
+    copy_rev(arg[0], res[0], nnz()*nw);
+    return 0;
+  }
+
   void UnaryMX::generate(CodeGenerator& g,
                           const std::vector<casadi_int>& arg,
                           const std::vector<casadi_int>& res) const {
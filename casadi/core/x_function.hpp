@@ -30,6 +30,7 @@
 #include "function_internal.hpp"
 #include "factory.hpp"
 #include "serializing_stream.hpp"
+#include "thread_pool.hpp"
 
 // To reuse variables we need to be able to sort by sparsity pattern
 #include <unordered_map>
@@ -45,6 +46,17 @@ throw CasadiException("Error in XFunction::" FNAME " for '" + this->name_ + "' "
 
 namespace casadi {
 
+  /** \brief Memory for SXFunction and MXFunction
+
+      With incremental evaluation, holds the work vector and the inputs of the previous call.
+  */
+  struct CASADI_EXPORT XFunctionMemory : public FunctionMemory {
+    // Work vector and inputs of the previous call
+    std::vector<double> w, arg;
+    // Has the function been evaluated since the memory was initialized?
+    bool valid;
+  };
+
   /** \brief  Internal node class for the base class of SXFunction and MXFunction
 
       (lacks a public counterpart)
@@ -77,6 +89,29 @@ namespace casadi {
         \identifier{xq} */
     void init(const Dict& opts) override;
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new XFunctionMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<XFunctionMemory*>(mem);}
+
+    /** \brief Dependency bit of input nonzero j (counting all inputs) in incremental evaluation
+
+        The input nonzeros are divided into bvec_size contiguous groups.
+    */
+    static bvec_t incremental_bit(casadi_int j, casadi_int nnz) {
+      return bvec_t(1) << (j*bvec_size/nnz);
+    }
+
+    /** \brief Groups of input nonzeros that changed since the previous call
+
+        Updates the inputs stored in the memory, all bits set for the first call.
+    */
+    bvec_t incremental_changed(const double** arg, XFunctionMemory* m) const;
+
     ///@{
     /// Is the class able to propagate seeds through the algorithm?
     bool has_spfwd() const override { return true;}
@@ -256,6 +291,9 @@ namespace casadi {
 
         \identifier{yd} */
     std::vector<MatType> out_;
+
+    /// Reevaluate only the parts of the algorithm that depend on changed inputs?
+    bool incremental_;
   };
 
   // Template implementations
@@ -267,7 +305,7 @@ namespace casadi {
             const std::vector<MatType>& ex_out,
             const std::vector<std::string>& name_in,
             const std::vector<std::string>& name_out)
-    : FunctionInternal(name), in_(ex_in),  out_(ex_out) {
+    : FunctionInternal(name), in_(ex_in),  out_(ex_out), incremental_(false) {
     // Names of inputs
     if (!name_in.empty()) {
       casadi_assert(ex_in.size()==name_in.size(),
@@ -285,8 +323,10 @@ namespace casadi {
   template<typename DerivedType, typename MatType, typename NodeType>
   XFunction<DerivedType, MatType, NodeType>::
   XFunction(DeserializingStream& s) : FunctionInternal(s) {
-    s.version("XFunction", 1);
+    int version = s.version("XFunction", 1, 2);
     s.unpack("XFunction::in", in_);
+    incremental_ = false;
+    if (version>=2) s.unpack("XFunction::incremental", incremental_);
     // 'out' member needs to be delayed
   }
 
@@ -306,8 +346,9 @@ namespace casadi {
   void XFunction<DerivedType, MatType, NodeType>::
   serialize_body(SerializingStream& s) const {
     FunctionInternal::serialize_body(s);
-    s.version("XFunction", 1);
+    s.version("XFunction", 2);
     s.pack("XFunction::in", in_);
+    s.pack("XFunction::incremental", incremental_);
     // 'out' member needs to be delayed
   }
 
@@ -321,6 +362,8 @@ namespace casadi {
     for (auto&& op : opts) {
       if (op.first=="allow_duplicate_io_names") {
         allow_duplicate_io_names = op.second;
+      } else if (op.first=="incremental") {
+        incremental_ = op.second;
       }
     }
 
@@ -383,6 +426,40 @@ namespace casadi {
     }
   }
 
+  template<typename DerivedType, typename MatType, typename NodeType>
+  int XFunction<DerivedType, MatType, NodeType>::init_mem(void* mem) const {
+    if (FunctionInternal::init_mem(mem)) return 1;
+    auto m = static_cast<XFunctionMemory*>(mem);
+    if (incremental_) {
+      m->w.resize(sz_w());
+      m->arg.resize(nnz_in());
+    }
+    m->valid = false;
+    return 0;
+  }
+
+  template<typename DerivedType, typename MatType, typename NodeType>
+  bvec_t XFunction<DerivedType, MatType, NodeType>::
+  incremental_changed(const double** arg, XFunctionMemory* m) const {
+    casadi_int nnz = m->arg.size(), j = 0;
+    bvec_t changed = m->valid ? 0 : ~bvec_t(0);
+    double* prev = get_ptr(m->arg);
+    for (casadi_int i=0; i<n_in_; ++i) {
+      const double* a = arg[i];
+      casadi_int n = nnz_in(i);
+      for (casadi_int k=0; k<n; ++k, ++j) {
+        double v = a ? a[k] : 0;
+        // NaN always counts as changed
+        if (!(v==prev[j])) {
+          changed |= incremental_bit(j, nnz);
+          prev[j] = v;
+        }
+      }
+    }
+    m->valid = true;
+    return changed;
+  }
+
   template<typename DerivedType, typename MatType, typename NodeType>
   void XFunction<DerivedType, MatType, NodeType>::sort_depth_first(
       std::stack<NodeType*>& s, std::vector<NodeType*>& nodes) {
@@ -421,6 +498,9 @@ namespace casadi {
       bool symmetric = false;
       bool allow_forward = true;
       bool allow_reverse = true;
+      std::string parallelization = "serial";
+      std::string coloring_ordering;
+      casadi_int coloring_threads = 1;
       for (auto&& op : opts) {
         if (op.first=="compact") {
           compact = op.second;
@@ -430,6 +510,12 @@ namespace casadi {
           allow_forward = op.second;
         } else if (op.first=="allow_reverse") {
           allow_reverse = op.second;
+        } else if (op.first=="parallelization") {
+          parallelization = op.second.to_string();
+        } else if (op.first=="coloring_ordering") {
+          coloring_ordering = op.second.to_string();
+        } else if (op.first=="coloring_threads") {
+          coloring_threads = op.second;
         } else if (op.first=="verbose") {
           continue;
         } else {
@@ -471,7 +557,8 @@ namespace casadi {
 
       // Get a bidirectional partition
       Sparsity D1, D2;
-      get_partition(iind, oind, D1, D2, true, symmetric, allow_forward, allow_reverse);
+      get_partition(iind, oind, D1, D2, true, symmetric, allow_forward, allow_reverse,
+                    coloring_ordering, coloring_threads);
       if (verbose_) casadi_message("Graph coloring completed");
 
       // Get the number of forward and adjoint sweeps
@@ -482,6 +569,18 @@ namespace casadi {
       casadi_int max_nfdir = max_num_dir_;
       casadi_int max_nadir = max_num_dir_;
 
+      // Spread the directions over as many sweeps as there are threads, the calls to the
+      // derivative functions of the sweeps are independent and can be evaluated concurrently
+      casadi_assert(parallelization=="serial" || parallelization=="thread",
+        "Unknown parallelization '" + parallelization + "', expected 'serial' or 'thread'");
+      if (parallelization=="thread" && std::is_same<MatType, MX>::value) {
+        casadi_int n_task = ThreadPool::default_size();
+        if (n_task>1) {
+          if (nfdir>0) max_nfdir = std::min(max_nfdir, (nfdir+n_task-1)/n_task);
+          if (nadir>0) max_nadir = std::min(max_nadir, (nadir+n_task-1)/n_task);
+        }
+      }
+
       // Current forward and adjoint direction
       casadi_int offset_nfdir = 0, offset_nadir = 0;
 
@@ -496,6 +595,17 @@ namespace casadi {
       const casadi_int* jsp_colind = jsp.colind();
       const casadi_int* jsp_row = jsp.row();
 
+      // With an acyclic coloring that is not a star coloring, the off-diagonal entries
+      // are recovered by substitution once all compressed columns are available
+      std::vector<casadi_int> sub_row, sub_color, sub_nz, sub_nz_tr;
+      Sparsity sub_sp;
+      if (symmetric && nfdir>0) {
+        sub_sp = jsp.acyclic_recovery(D1, sub_row, sub_color, sub_nz, sub_nz_tr);
+        if (sub_sp.nnz()==sub_sp.size1()) sub_sp = Sparsity();
+      }
+      bool substitute = !sub_sp.is_null();
+      std::vector<MatType> sub_b(substitute ? nfdir : 0);
+
       // Input sparsity
       std::vector<casadi_int> input_col = sparsity_in_.at(iind).get_col();
       const casadi_int* input_row = sparsity_in_.at(iind).row();
@@ -649,6 +759,25 @@ namespace casadi {
 
         // Carry out the forward sweeps
         for (casadi_int d=0; d<nfdir_batch; ++d) {
+          if (substitute) {
+            // Keep the compressed column, diagonal entries are recovered directly
+            MatType& b = sub_b[offset_nfdir+d];
+            b = project(fsens[d][oind], sparsity_out_.at(oind));
+            tmp.clear();
+            adds.clear();
+            for (casadi_int el = D1.colind(offset_nfdir+d); el<D1.colind(offset_nfdir+d+1); ++el) {
+              casadi_int c = D1.row(el);
+              for (casadi_int el_jsp=jsp_colind[c]; el_jsp<jsp_colind[c+1]; ++el_jsp) {
+                if (jsp_row[el_jsp]==c) {
+                  tmp.push_back(c);
+                  adds.push_back(el_jsp);
+                }
+              }
+            }
+            ret.at(0).nz(adds) = b.nz(tmp);
+            continue;
+          }
+
           // Skip if nothing to add
           if (fsens[d][oind].nnz()==0) {
             continue;
@@ -796,6 +925,31 @@ namespace casadi {
         offset_nadir += nadir_batch;
       }
 
+      if (substitute) {
+        // Gather the compressed entries, one color at a time
+        std::vector<MatType> b_parts;
+        std::vector<casadi_int> b_order;
+        for (casadi_int c=0; c<nfdir; ++c) {
+          tmp.clear();
+          for (casadi_int k=0; k<sub_row.size(); ++k) {
+            if (sub_color[k]==c) {
+              tmp.push_back(sub_row[k]);
+              b_order.push_back(k);
+            }
+          }
+          if (!tmp.empty()) b_parts.push_back(sub_b[c].nz(tmp));
+        }
+        MatType b = vertcat(b_parts);
+        // Permute to the order of the unknowns
+        std::vector<casadi_int> b_pos(b_order.size());
+        for (casadi_int i=0; i<b_order.size(); ++i) b_pos[b_order[i]] = i;
+        b = b.nz(b_pos);
+        // Forward substitution, children before their parents in each tree
+        MatType h = solve(MatType::ones(sub_sp), b);
+        ret.at(0).nz(sub_nz) = h;
+        ret.at(0).nz(sub_nz_tr) = h;
+      }
+
       // Return
       for (MatType& Jb : ret) Jb = Jb.T();
       return ret;
@@ -922,8 +1076,28 @@ namespace casadi {
       // Temporary single-input, single-output function FIXME(@jaeandersson)
       Function tmp("flattened_" + name, {veccat(in_)}, {veccat(out_)}, tmp_options);
 
+      // Evaluate the color groups concurrently if the Jacobian, or else the function
+      // itself, is parallelized
+      Dict options = opts;
+      if (!options.count("parallelization") && tmp_options.count("parallelization")) {
+        options["parallelization"] = tmp_options["parallelization"];
+      }
+      Dict jac_options;
+      if (options.count("parallelization")) {
+        jac_options["parallelization"] = options["parallelization"];
+      }
+
+      // Graph coloring options are only for the Jacobian expression
+      for (const char* op : {"coloring_ordering", "coloring_threads"}) {
+        auto it = options.find(op);
+        if (it!=options.end()) {
+          jac_options[op] = it->second;
+          options.erase(it);
+        }
+      }
+
       // Expression for the extended Jacobian
-      MatType J = tmp.get<DerivedType>()->jac(Dict()).at(0);
+      MatType J = tmp.get<DerivedType>()->jac(jac_options).at(0);
 
       // Split up extended Jacobian
       std::vector<casadi_int> r_offset = {0}, c_offset = {0};
@@ -951,7 +1125,6 @@ namespace casadi {
         ret_in.at(n_in_+i) = MatType::sym(inames[n_in_+i], Sparsity(out_.at(i).size()));
       }
 
-      Dict options = opts;
       options["allow_free"] = true;
       options["allow_duplicate_io_names"] = true;
 
@@ -25,6 +25,7 @@
 
 #include "linsol_ldl.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 namespace casadi {
 
@@ -60,7 +61,18 @@ namespace casadi {
        "Incomplete factorization, without any fill-in"}},
       {"preordering",
        {OT_BOOL,
-       "Approximate minimal degree (AMD) preordering"}}
+       "Fill-reducing preordering [true]"}},
+      {"ordering",
+       {OT_STRING,
+       "Fill-reducing preordering: amd (approximate minimum degree, default) "
+       "or nested_dissection"}},
+      {"supernodal",
+       {OT_BOOL,
+       "Factorize groups of columns with identical sparsity as dense blocks [true]"}},
+      {"max_num_threads",
+       {OT_INT,
+       "Maximum number of threads for factorizing independent subtrees of the "
+       "elimination tree concurrently, supernodal factorization only [1]"}}
      }
   };
 
@@ -70,22 +82,40 @@ namespace casadi {
 
     // Default options
     incomplete_ = false;
-    amd_ = true;
+    bool preordering = true, supernodal = true;
+    casadi_int max_num_threads = 1;
+    std::string ordering = "amd";
 
     // Read user options
     for (auto&& op : opts) {
       if (op.first=="incomplete") {
         incomplete_ = op.second;
-      } else if (op.first=="amd") {
-        amd_ = op.second;
+      } else if (op.first=="preordering") {
+        preordering = op.second;
+      } else if (op.first=="ordering") {
+        ordering = op.second.to_string();
+      } else if (op.first=="supernodal") {
+        supernodal = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
       }
     }
+    casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
+    if (max_num_threads>1 && (!supernodal || incomplete_)) {
+      casadi_warning("Option 'max_num_threads' is ignored, "
+        "only the supernodal factorization uses threads");
+    }
+
+    casadi_assert(ordering=="amd" || ordering=="nested_dissection",
+      "Unknown ordering '" + ordering + "'. "
+      "Options are 'amd' and 'nested_dissection'.");
+    if (!preordering) ordering = "none";
 
     // Symbolic factorization
     if (incomplete_) {
-      if (amd_) {
-        // Incomplete LDL^T, AMD permutation
-        p_ = sp_.amd();
+      if (ordering!="none") {
+        // Incomplete LDL^T, fill-reducing permutation
+        p_ = ordering=="amd" ? sp_.amd() : sp_.nested_dissection();
         std::vector<casadi_int> tmp;
         Sparsity Aperm = sp_.sub(p_, p_, tmp);
         sp_Lt_ = triu(Aperm, false);  // no fill-in
@@ -95,10 +125,55 @@ namespace casadi {
       }
     } else {
       // Regular LDL^T
-      sp_Lt_ = sp_.ldl(p_, amd_);
+      sp_Lt_ = sp_.ldl(p_, ordering);
+      // Supernodal factorization, unless all supernodes are single columns and serial
+      if (supernodal) {
+        sn_ = sp_Lt_.ldl_supernodes();
+        if (sn_[1]==sp_.size1() && max_num_threads==1) sn_.clear();
+      }
+      // Distribute independent subtrees over the threads
+      if (!sn_.empty() && max_num_threads>1) {
+        casadi_int nsuper = sn_[1];
+        const casadi_int *super = get_ptr(sn_)+2, *rowptr = super+nsuper+1,
+                         *row = rowptr+2*(nsuper+1);
+        // Supernode of each column
+        std::vector<casadi_int> snode(sn_[0]);
+        for (casadi_int s=0; s<nsuper; ++s) {
+          for (casadi_int j=super[s]; j<super[s+1]; ++j) snode[j] = s;
+        }
+        // Supernodal elimination tree, work of a dense block and its updates
+        std::vector<casadi_int> parent(nsuper);
+        std::vector<double> work(nsuper);
+        for (casadi_int s=0; s<nsuper; ++s) {
+          casadi_int nc = super[s+1]-super[s], nr = rowptr[s+1]-rowptr[s];
+          parent[s] = nc<nr ? snode[row[rowptr[s]+nc]] : -1;
+          work[s] = static_cast<double>(nr)*static_cast<double>(nr)*static_cast<double>(nc);
+        }
+        sched_ = Sparsity::etree_schedule(parent, work, max_num_threads);
+        if (sched_.empty() && nsuper==sp_.size1()) sn_.clear();
+      }
     }
   }
 
+  // Largest dense block of the supernodes, length of the update buffer
+  static casadi_int ldl_super_upd(const std::vector<casadi_int>& sn) {
+    casadi_int nsuper = sn[1], ret = 0;
+    const casadi_int *super = get_ptr(sn)+2, *rowptr = super+nsuper+1;
+    for (casadi_int s=0; s<nsuper; ++s) {
+      ret = std::max(ret, (rowptr[s+1]-rowptr[s])*(super[s+1]-super[s]));
+    }
+    return ret;
+  }
+
+  // Work vector sizes for casadi_ldl_super, with an update buffer and row positions per group
+  static void ldl_super_work(const std::vector<casadi_int>& sn, casadi_int ngroup,
+                             casadi_int& sz_w, casadi_int& sz_iw) {
+    casadi_int n = sn[0], nsuper = sn[1];
+    const casadi_int *nzptr = get_ptr(sn)+2+2*(nsuper+1);
+    sz_w = std::max(n, nzptr[nsuper] + ngroup*ldl_super_upd(sn));
+    sz_iw = 2*n + 3*nsuper + ngroup*n;
+  }
+
   int LinsolLdl::init_mem(void* mem) const {
     if (LinsolInternal::init_mem(mem)) return 1;
     auto m = static_cast<LinsolLdlMemory*>(mem);
@@ -107,7 +182,14 @@ namespace casadi {
     casadi_int nrow = this->nrow();
     m->d.resize(nrow);
     m->l.resize(sp_Lt_.nnz());
-    m->w.resize(nrow);
+    if (sn_.empty()) {
+      m->w.resize(nrow);
+    } else {
+      casadi_int sz_w, sz_iw;
+      ldl_super_work(sn_, sched_.empty() ? 1 : sched_[0], sz_w, sz_iw);
+      m->w.resize(sz_w);
+      m->iw.resize(sz_iw);
+    }
 
     return 0;
   }
@@ -118,7 +200,43 @@ namespace casadi {
 
   int LinsolLdl::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    if (sn_.empty()) {
+      casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    } else if (sched_.empty()) {
+      casadi_ldl_super(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                       get_ptr(sn_), get_ptr(m->w), get_ptr(m->iw));
+    } else {
+      casadi_int n = nrow(), nsuper = sn_[1], sz_upd = ldl_super_upd(sn_);
+      const casadi_int *sn = get_ptr(sn_), *p = get_ptr(p_);
+      double *d = get_ptr(m->d), *w = get_ptr(m->w), *upd = w + sn[2+3*(nsuper+1)-1];
+      casadi_int *iw = get_ptr(m->iw), *loc = iw + 2*n + 3*nsuper;
+      // Schedule, cf. Sparsity::etree_schedule
+      casadi_int ngroup = sched_[0];
+      const casadi_int *gptr = get_ptr(sched_)+1, *tptr = gptr+ngroup+1;
+      casadi_int ntask = gptr[ngroup];
+      const casadi_int *node = tptr+ntask+1, *top = node+tptr[ntask];
+      casadi_ldl_super_init(p, sn, iw);
+      // Independent subtrees, with an update buffer and row positions per group
+      int flag = ThreadPool::instance()->run(ngroup, [&](casadi_int g) -> int {
+        for (casadi_int t=gptr[g]; t<gptr[g+1]; ++t) {
+          // Updates beyond the root of the subtree are linked afterwards
+          casadi_int s_end = node[tptr[t+1]-1]+1;
+          for (casadi_int k=tptr[t]; k<tptr[t+1]; ++k) {
+            casadi_ldl_super_node(node[k], s_end, sp_, A, d, p, sn, w, upd + g*sz_upd,
+                                  iw, loc + g*n);
+          }
+        }
+        return 0;
+      });
+      if (flag) return 1;
+      // Link the subtrees to the top of the tree, in a fixed order
+      for (casadi_int k=0; k<tptr[ntask]; ++k) casadi_ldl_super_link(node[k], nsuper, sn, iw);
+      // Top of the tree
+      for (const casadi_int* s=top; s!=node+nsuper; ++s) {
+        casadi_ldl_super_node(*s, nsuper, sp_, A, d, p, sn, w, upd, iw, loc);
+      }
+      casadi_ldl_super_lt(sp_Lt_, get_ptr(m->l), sn, w, loc);
+    }
     for (double d : m->d) {
       if (d==0) casadi_warning("LDL factorization has zeros in D");
     }
@@ -159,12 +277,25 @@ namespace casadi {
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
-         "d[" << nrow() << "], "
-         "w[" << nrow() << "];\n";
+    if (sn_.empty()) {
+      g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
+           "d[" << nrow() << "], "
+           "w[" << nrow() << "];\n";
+
+      // Factorize
+      g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    } else {
+      casadi_int sz_w, sz_iw;
+      ldl_super_work(sn_, 1, sz_w, sz_iw);
+      g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
+           "d[" << nrow() << "], "
+           "w[" << sz_w << "];\n";
+      g << "casadi_int iw[" << sz_iw << "];\n";
 
-    // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+      // Factorize
+      std::string sn = g.constant(sn_);
+      g << g.ldl_super(sp, A, sp_Lt, "lt", "d", p, sn, "w", "iw") << "\n";
+    }
 
     // Solve
     g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
@@ -174,16 +305,20 @@ namespace casadi {
   }
 
   LinsolLdl::LinsolLdl(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("LinsolLdl", 1);
+    int version = s.version("LinsolLdl", 1, 3);
     s.unpack("LinsolLdl::p", p_);
     s.unpack("LinsolLdl::sp_Lt", sp_Lt_);
+    if (version>1) s.unpack("LinsolLdl::sn", sn_);
+    if (version>2) s.unpack("LinsolLdl::sched", sched_);
   }
 
   void LinsolLdl::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolLdl", 1);
+    s.version("LinsolLdl", 3);
     s.pack("LinsolLdl::p", p_);
     s.pack("LinsolLdl::sp_Lt", sp_Lt_);
+    s.pack("LinsolLdl::sn", sn_);
+    s.pack("LinsolLdl::sched", sched_);
   }
 
 } // namespace casadi
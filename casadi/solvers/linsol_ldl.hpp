@@ -42,6 +42,7 @@
 namespace casadi {
   struct CASADI_LINSOL_LDL_EXPORT LinsolLdlMemory : public LinsolMemory {
     std::vector<double> l, d, w;
+    std::vector<casadi_int> iw;
   };
 
   /** \brief \pluginbrief{LinsolInternal,ldl}
@@ -112,9 +113,15 @@ namespace casadi {
     std::vector<casadi_int> p_;
     Sparsity sp_Lt_;
 
+    // Supernodes, empty for the column-by-column factorization
+    std::vector<casadi_int> sn_;
+
+    // Independent subtrees of the supernodal elimination tree, empty if serial
+    std::vector<casadi_int> sched_;
+
     ///@{
     // Options
-    bool incomplete_, amd_;
+    bool incomplete_;
     ///@}
 
     /** \brief Serialize an object without type information */
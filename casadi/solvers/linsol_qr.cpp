@@ -25,6 +25,7 @@
 
 #include "linsol_qr.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/thread_pool.hpp"
 
 namespace casadi {
 
@@ -60,7 +61,15 @@ namespace casadi {
         "Minimum R entry before singularity is declared [1e-12]"}},
       {"cache",
        {OT_DOUBLE,
-        "Amount of factorisations to remember (thread-local) [0]"}}
+        "Amount of factorisations to remember (thread-local) [0]"}},
+      {"ordering",
+       {OT_STRING,
+        "Fill-reducing column ordering: amd (approximate minimum degree, default), "
+        "nested_dissection or natural"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of threads for factorizing independent subtrees of the "
+        "column elimination tree concurrently [1]"}}
      }
   };
 
@@ -71,16 +80,47 @@ namespace casadi {
     // Read options
     eps_ = 1e-12;
     n_cache_ = 0;
+    std::string ordering = "amd";
+    casadi_int max_num_threads = 1;
     for (auto&& op : opts) {
       if (op.first=="eps") {
         eps_ = op.second;
       } else if (op.first=="cache") {
         n_cache_ = op.second;
+      } else if (op.first=="ordering") {
+        ordering = op.second.to_string();
+      } else if (op.first=="max_num_threads") {
+        max_num_threads = op.second;
       }
     }
+    casadi_assert(max_num_threads>=1, "Option 'max_num_threads' must be positive");
+
+    casadi_assert(ordering=="natural" || ordering=="amd" || ordering=="nested_dissection",
+      "Unknown ordering '" + ordering + "'. "
+      "Options are 'natural', 'amd' and 'nested_dissection'.");
 
     // Symbolic factorization
-    sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_, ordering=="natural" ? "none" : ordering);
+
+    // Distribute independent subtrees over the threads
+    if (max_num_threads>1) {
+      casadi_int n = ncol();
+      const casadi_int *r_colind = sp_r_.colind(), *r_row = sp_r_.row(),
+                       *v_colind = sp_v_.colind();
+      // Column elimination tree: the parent of r is the first column c>r with R(r, c) nonzero
+      // Work: applying the Householder reflections of the descendants and forming its own
+      std::vector<casadi_int> parent(n, -1);
+      std::vector<double> work(n);
+      for (casadi_int c=0; c<n; ++c) {
+        work[c] = static_cast<double>(v_colind[c+1]-v_colind[c]);
+        for (casadi_int k=r_colind[c]; k<r_colind[c+1] && r_row[k]<c; ++k) {
+          casadi_int r = r_row[k];
+          if (parent[r]<0) parent[r] = c;
+          work[c] += 2.0*static_cast<double>(v_colind[r+1]-v_colind[r]);
+        }
+      }
+      sched_ = Sparsity::etree_schedule(parent, work, max_num_threads);
+    }
   }
 
   void LinsolQr::finalize() {
@@ -96,7 +136,8 @@ namespace casadi {
     m->v.resize(sp_v_.nnz());
     m->r.resize(sp_r_.nnz());
     m->beta.resize(ncol());
-    m->w.resize(nrow() + ncol());
+    m->w.resize(std::max(nrow() + ncol(),
+                         sp_v_.size1() * (sched_.empty() ? 1 : sched_[0])));
 
     m->cache.resize(cache_stride_*n_cache_);
     m->cache_loc.resize(n_cache_, -1);
@@ -126,9 +167,34 @@ namespace casadi {
     }
 
     // Cache miss -> compute result
-    casadi_qr(sp_, A, get_ptr(m->w),
-              sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-              get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+    if (sched_.empty()) {
+      casadi_qr(sp_, A, get_ptr(m->w),
+                sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+    } else {
+      // Schedule, cf. Sparsity::etree_schedule
+      casadi_int ngroup = sched_[0], nrow_ext = sp_v_.size1();
+      const casadi_int *gptr = get_ptr(sched_)+1, *tptr = gptr+ngroup+1;
+      casadi_int ntask = gptr[ngroup];
+      const casadi_int *node = tptr+ntask+1, *top = node+tptr[ntask];
+      // Independent subtrees, with a dense column per group
+      casadi_clear(get_ptr(m->w), ngroup*nrow_ext);
+      int flag = ThreadPool::instance()->run(ngroup, [&](casadi_int g) -> int {
+        for (casadi_int k=tptr[gptr[g]]; k<tptr[gptr[g+1]]; ++k) {
+          casadi_qr_col(node[k], sp_, A, get_ptr(m->w) + g*nrow_ext,
+                        sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                        get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+        }
+        return 0;
+      });
+      if (flag) return 1;
+      // Top of the tree
+      for (const casadi_int* c=top; c!=node+ncol(); ++c) {
+        casadi_qr_col(*c, sp_, A, get_ptr(m->w),
+                      sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                      get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+      }
+    }
     // Check singularity
     double rmin;
     casadi_int irmin, nullity;
@@ -218,7 +284,7 @@ namespace casadi {
   }
 
   LinsolQr::LinsolQr(DeserializingStream& s) : LinsolInternal(s) {
-    int version = s.version("LinsolQr", 1, 2);
+    int version = s.version("LinsolQr", 1, 3);
     s.unpack("LinsolQr::prinv", prinv_);
     s.unpack("LinsolQr::pc", pc_);
     s.unpack("LinsolQr::sp_v", sp_v_);
@@ -229,17 +295,19 @@ namespace casadi {
     } else {
       n_cache_ = 1;
     }
+    if (version>2) s.unpack("LinsolQr::sched", sched_);
   }
 
   void LinsolQr::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolQr", 2);
+    s.version("LinsolQr", 3);
     s.pack("LinsolQr::prinv", prinv_);
     s.pack("LinsolQr::pc", pc_);
     s.pack("LinsolQr::sp_v", sp_v_);
     s.pack("LinsolQr::sp_r", sp_r_);
     s.pack("LinsolQr::eps", eps_);
     s.pack("LinsolQr::n_cache", n_cache_);
+    s.pack("LinsolQr::sched", sched_);
   }
 
 } // namespace casadi
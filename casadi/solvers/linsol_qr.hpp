@@ -114,6 +114,9 @@ namespace casadi {
     Sparsity sp_v_, sp_r_;
     double eps_;
 
+    /// Independent subtrees of the column elimination tree, empty if serial
+    std::vector<casadi_int> sched_;
+
     /// Cache size
     casadi_int n_cache_;
     casadi_int cache_stride_;
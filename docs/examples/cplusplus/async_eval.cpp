@@ -0,0 +1,57 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <casadi/casadi.hpp>
+
+using namespace casadi;
+/**
+ * Overlapping evaluations with Function::eval_async
+ */
+
+int main() {
+  // Simulator for one step and a controller computing the next input
+  SX x = SX::sym("x", 2);
+  SX u = SX::sym("u");
+  SX xf = x;
+  for (int k=0; k<100; ++k) xf = xf + 0.01*vertcat(xf(1), u - sin(xf(0)));
+  Function sim("sim", {x, u}, {xf});
+  Function ctrl("ctrl", {x}, {-2*x(0) - x(1)});
+
+  // Start a simulation, and chain the controller to its outputs
+  FunctionFuture fx = sim.eval_async({DM({1, 0}), 0});
+  FunctionFuture fu = fx.then(ctrl);
+
+  // Meanwhile, another simulation without dependencies
+  FunctionFuture fy = sim.eval_async({DM({-1, 0}), 0.5});
+
+  // Continue from the first simulation, get() blocks until the result is available
+  FunctionFuture fz = sim.eval_async({fx.get().at(0), fu.get().at(0)});
+  std::cout << "x1 = " << fx.get().at(0) << ", u1 = " << fu.get().at(0) << std::endl;
+  std::cout << "x2 = " << fz.get().at(0) << ", y1 = " << fy.get().at(0) << std::endl;
+
+  // Buffers of the caller, evaluated in order of the dependencies
+  double x0[2] = {1, 0}, u0 = 0, x1[2], x2[2];
+  FunctionFuture s1 = sim.eval_async({x0, &u0}, {x1});
+  FunctionFuture s2 = sim.eval_async({x1, &u0}, {x2}, {s1});
+  if (s2.wait()) return 1;
+  std::cout << "x2 = [" << x2[0] << ", " << x2[1] << "]" << std::endl;
+  return 0;
+}
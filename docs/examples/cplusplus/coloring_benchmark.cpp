@@ -0,0 +1,95 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <casadi/casadi.hpp>
+#include <chrono>
+#include <cstdlib>
+
+using namespace casadi;
+/**
+ * Number of colors and runtime of the graph colorings for a few sparsity patterns,
+ * with different vertex orderings and numbers of threads
+ * Usage: coloring_benchmark [grid size]
+ */
+
+// Time a coloring, print number of colors and seconds
+template<typename F>
+void bench(const std::string& name, F f) {
+  auto t0 = std::chrono::steady_clock::now();
+  Sparsity D = f();
+  double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  std::cout << "  " << name << ": " << D.size2() << " colors, " << t << " s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  casadi_int n = argc>1 ? std::atoi(argv[1]) : 300;
+  std::vector<std::string> orderings = {"natural", "largest_first",
+                                        "smallest_last", "incidence_degree"};
+
+  // 9-point stencil on an n-by-n grid
+  std::vector<casadi_int> r, c;
+  for (casadi_int i=0; i<n; ++i) {
+    for (casadi_int j=0; j<n; ++j) {
+      for (casadi_int di=-1; di<=1; ++di) {
+        for (casadi_int dj=-1; dj<=1; ++dj) {
+          if (i+di<0 || i+di>=n || j+dj<0 || j+dj>=n) continue;
+          r.push_back(i*n+j);
+          c.push_back((i+di)*n+j+dj);
+        }
+      }
+    }
+  }
+  Sparsity H = Sparsity::triplet(n*n, n*n, r, c);
+
+  // Jacobian of the stencil with an additional dense row
+  Sparsity J = vertcat(H, Sparsity::dense(1, n*n));
+  Sparsity JT = J.T();
+  std::cout << "Jacobian " << J.dim(true) << std::endl;
+  for (casadi_int ord=0; ord<4; ++ord) {
+    for (casadi_int n_thread : {1, 2, 4}) {
+      bench("uni_coloring " + orderings[ord] + ", " + str(n_thread) + " thread(s)",
+        [&]() { return JT.uni_coloring(J, std::numeric_limits<casadi_int>::max(),
+                                       ord, n_thread);});
+    }
+  }
+
+  // Symmetric stencil, e.g. a Hessian
+  std::cout << "Hessian " << H.dim(true) << std::endl;
+  for (casadi_int ord=1; ord<4; ++ord) {
+    bench("star_coloring " + orderings[ord], [&]() { return H.star_coloring(ord);});
+    bench("acyclic_coloring " + orderings[ord], [&]() { return H.acyclic_coloring(ord);});
+    for (casadi_int n_thread : {1, 2, 4}) {
+      bench("distance2_coloring " + orderings[ord] + ", " + str(n_thread) + " thread(s)",
+        [&]() { return H.distance2_coloring(ord, std::numeric_limits<casadi_int>::max(),
+                                            n_thread);});
+    }
+  }
+
+  // The same options for the Jacobian of an expression
+  SX x = SX::sym("x", n);
+  SX f = sin(x(Slice(1, n))) * x(Slice(0, n-1));
+  f = vertcat(f, sum1(x));
+  for (const std::string& ord : orderings) {
+    SX Jf = jacobian(f, x, {{"coloring_ordering", ord}, {"coloring_threads", 2}});
+    std::cout << "jacobian with " << ord << ": " << Jf.nnz() << " nonzeros" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <casadi/casadi.hpp>
+#include <chrono>
+
+using namespace casadi;
+/**
+ * Repeated evaluation with minimal overhead using Evaluator
+ */
+
+int main() {
+  SX x = SX::sym("x", 2);
+  SX p = SX::sym("p");
+  Function f("f", {x, p}, {sin(x)*p, dot(x, x)}, {{"default_in", std::vector<double>{0, 2}}});
+
+  // Pins a memory object of f and owns input, output and work buffers
+  Evaluator e(f);
+  const int N = 100000;
+  double sum = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int k=0; k<N; ++k) {
+    double* xk = e.input(0);
+    xk[0] = 0.001*k;
+    xk[1] = 1;
+    // p keeps its default value 2
+    if (e()) return 1;
+    sum += *e.output(1);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Evaluator: " << std::chrono::duration<double>(t1-t0).count()/N*1e9
+            << " ns/call" << std::endl;
+
+  // Same result as a call with DM
+  std::vector<DM> res = f(std::vector<DM>{DM({0.001*(N-1), 1}), 2});
+  casadi_assert(std::fabs(res.at(1).scalar() - *e.output(1)) < 1e-12, "Mismatch");
+
+  // Inputs and outputs can also be read from and written to external buffers
+  double x_ext[2] = {1, 2}, r_ext[2];
+  e.set_input(0, x_ext);
+  e.set_output(0, r_ext);
+  e.set_output(1, nullptr);
+  if (e()) return 1;
+  std::cout << "sin(x)*p = [" << r_ext[0] << ", " << r_ext[1] << "]" << std::endl;
+  std::cout << "sum = " << sum << std::endl;
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+
+#include <casadi/casadi.hpp>
+#include <casadi/casadi_c.h>
+
+using namespace casadi;
+/**
+ * Checks Function::eval_async and the asynchronous C API: results, chaining through
+ * dependencies and propagation of errors to dependent evaluations
+ */
+
+casadi_int n_fail = 0;
+
+void check(bool c, const std::string& msg) {
+  if (!c) {
+    std::cout << "Failed: " << msg << std::endl;
+    n_fail++;
+  }
+}
+
+int main() {
+  // Evaluation fails for negative inputs
+  SX x = SX::sym("x", 2), y = SX::sym("y");
+  Function f("f", {x}, {sqrt(x), sum1(x)}, {{"regularity_check", true}});
+  Function g("g", {x, y}, {x*x + y - 4});
+
+  // Results as for synchronous calls
+  DM x0 = DM({1, 4});
+  std::vector<DM> ref = f(std::vector<DM>{x0});
+  FunctionFuture f0 = f.eval_async({x0});
+  check(f0.wait()==0 && f0.error().empty(), "return code");
+  check(f0.ready(), "ready");
+  check(static_cast<double>(norm_inf(f0.get().at(0) - ref.at(0)))==0, "outputs");
+
+  // Chains: outputs as inputs, explicit dependencies on caller buffers
+  FunctionFuture f1 = f0.then(g);
+  check(static_cast<double>(norm_inf(f1.get().at(0) - DM({2, 5})))==0, "then");
+  double a[2] = {9, 16}, b[2], c[2];
+  FunctionFuture s1 = f.eval_async({a}, {b, nullptr});
+  FunctionFuture s2 = g.eval_async({b, b}, {c}, {s1});
+  check(s2.wait()==0 && c[0]==8 && c[1]==15, "buffer chain");
+
+  // A failure reaches everything queued after it, and only that
+  FunctionFuture e0 = f.eval_async({DM({1, -1})});
+  FunctionFuture e1 = e0.then(g);
+  FunctionFuture e2 = g.eval_async({b, b}, {c}, {s2, e0});
+  FunctionFuture e3 = g.eval_async({DM({1, 2}), DM()}, {s2});
+  check(e0.wait()!=0 && e0.error().find("nan")!=std::string::npos, "failure");
+  check(e1.wait()!=0 && e1.error().find("Dependency failed")!=std::string::npos, "then failure");
+  check(e2.wait()!=0 && e2.error().find("nan")!=std::string::npos, "after failure");
+  check(e3.wait()==0, "independent of failure");
+  bool thrown = false;
+  try {
+    e1.get();
+  } catch (std::exception&) {
+    thrown = true;
+  }
+  check(thrown, "get of failed evaluation");
+
+  // C API on serialized copies
+  f.save("test_async_eval_f.casadi");
+  g.save("test_async_eval_g.casadi");
+  check(casadi_c_push_file("test_async_eval_f.casadi")==0, "load f");
+  check(casadi_c_push_file("test_async_eval_g.casadi")==0, "load g");
+  int id_f = casadi_c_id("f"), id_g = casadi_c_id("g");
+  double d[2], e[2];
+  const double* arg_f[] = {a};
+  double* res_f[] = {d, nullptr};
+  const double* arg_g[] = {d, d};
+  double* res_g[] = {e};
+  int h1 = casadi_c_eval_async_id(id_f, arg_f, res_f, 0, nullptr);
+  int h2 = casadi_c_eval_async_id(id_g, arg_g, res_g, 1, &h1);
+  check(h1>=0 && h2>=0, "handles");
+  check(casadi_c_async_wait(h2)==0 && e[0]==8 && e[1]==15, "C chain");
+  check(casadi_c_async_ready(h1)==1, "C ready");
+  check(casadi_c_async_release(h1)==0, "C release");
+  check(casadi_c_async_ready(h1)<0 && casadi_c_async_release(h1)<0, "C released handle");
+
+  // Failure through a dependency
+  double m[2] = {1, -1};
+  arg_f[0] = m;
+  int h3 = casadi_c_eval_async_id(id_f, arg_f, res_f, 0, nullptr);
+  int h4 = casadi_c_eval_async_id(id_g, arg_g, res_g, 1, &h3);
+  check(casadi_c_async_wait(h4)!=0, "C dependency failure");
+  check(casadi_c_async_wait(h3)!=0, "C failure");
+  check(casadi_c_async_wait(h3)<0, "C handle after wait");
+  check(casadi_c_eval_async_id(id_g, arg_g, res_g, 1, &h3)<0, "C invalid dependency");
+  casadi_c_clear();
+
+  std::cout << n_fail << " failures" << std::endl;
+  return n_fail==0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+
+#include <casadi/casadi.hpp>
+
+using namespace casadi;
+/**
+ * Checks that Evaluator gives the same results and statistics as Function::operator()
+ */
+
+casadi_int n_fail = 0;
+
+void check(bool c, const std::string& msg) {
+  if (!c) {
+    std::cout << "Failed: " << msg << std::endl;
+    n_fail++;
+  }
+}
+
+// Evaluate f with an evaluator and with DM, compare the outputs, omitted inputs take defaults
+void check_outputs(const Function& f, const DMDict& arg, const std::string& name) {
+  Evaluator e(f);
+  for (auto&& a : arg) {
+    std::vector<double> v = densify(a.second).nonzeros();
+    std::copy(v.begin(), v.end(), e.input(f.index_in(a.first)));
+  }
+  // Twice, the second call must not depend on the first
+  check(e()==0, name + " return code");
+  check(e()==0, name + " return code");
+  DMDict ref = f(arg);
+  for (casadi_int i=0; i<f.n_out(); ++i) {
+    std::vector<double> r = ref.at(f.name_out(i)).nonzeros();
+    check(std::equal(r.begin(), r.end(), e.output(i)), name + " output " + str(i));
+  }
+}
+
+// Number of calls of each timed part
+std::map<std::string, casadi_int> counts(const Dict& stats) {
+  std::map<std::string, casadi_int> ret;
+  for (auto&& s : stats) {
+    if (s.first.rfind("n_call_", 0)==0) ret[s.first] = s.second.as_int();
+  }
+  return ret;
+}
+
+int main() {
+  // Scalar expressions, with a default input
+  SX x = SX::sym("x", 3);
+  SX p = SX::sym("p");
+  Function fsx("fsx", {x, p}, {sin(x)*p, dot(x, x)+p},
+               {{"default_in", std::vector<double>{0, 2}}});
+  check_outputs(fsx, {{"i0", DM({1, 2, 3})}, {"i1", 0.5}}, "fsx");
+  check_outputs(fsx, {{"i0", DM({1, 2, 3})}}, "fsx default");
+
+  // Matrix expressions with a linear solve
+  MX y = MX::sym("y", 3);
+  MX A = MX::eye(3)*4 + mtimes(y, y.T());
+  Function fmx("fmx", {y}, {solve(A, y), trace(A)});
+  check_outputs(fmx, {{"i0", DM({1, 2, 3})}}, "fmx");
+
+  // A solver keeping statistics of the functions it calls
+  SX z = SX::sym("z", 2);
+  Function solver = nlpsol("solver", "sqpmethod",
+    SXDict{{"x", z}, {"p", p}, {"f", sq(z(0)-p) + sq(z(1)-z(0)*z(0))}},
+    Dict{{"qpsol", "qrqp"}, {"qpsol_options", Dict{{"print_iter", false}, {"print_header", false}}},
+         {"print_header", false}, {"print_iteration", false}, {"print_time", false},
+         {"print_status", false}});
+  DMDict arg = {{"x0", DM({0, 0})}, {"p", 2}};
+  check_outputs(solver, arg, "solver");
+
+  // Counters of a single call, not accumulated over the calls
+  solver(arg);
+  std::map<std::string, casadi_int> ref = counts(solver.stats());
+  check(ref["n_call_nlp_fg"]>0, "solver statistics");
+  Evaluator e(solver);
+  e.input(solver.index_in("p"))[0] = 2;
+  for (casadi_int k=0; k<3; ++k) {
+    check(e()==0, "solver return code");
+    check(counts(solver.stats(e.mem()))==ref, "solver statistics of call " + str(k));
+  }
+
+  // Null and moved-from evaluators
+  Evaluator e_null, e_moved(fsx);
+  Evaluator e_to(std::move(e_moved));
+  check(e_to()==0, "moved to");
+  for (Evaluator* ei : {&e_null, &e_moved}) {
+    bool thrown = false;
+    try {
+      (*ei)();
+    } catch (std::exception&) {
+      thrown = true;
+    }
+    check(thrown, "null evaluator");
+  }
+
+  std::cout << n_fail << " failures" << std::endl;
+  return n_fail==0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <casadi/casadi.hpp>
+#include <thread>
+
+using namespace casadi;
+/**
+ * Builds independent models in concurrent threads and checks that the results are
+ * identical to those of a serial build, requires a build with WITH_THREADSAFE_SYMBOLICS
+ */
+
+// What is checked for each model
+struct Model {
+  // Simplifications that rely on the identity of constant nodes
+  bool simplified;
+  // Size of the expression graphs
+  casadi_int n_sx, n_mx;
+  // Numerical results
+  std::vector<double> val;
+
+  bool operator==(const Model& m) const {
+    return simplified==m.simplified && n_sx==m.n_sx && n_mx==m.n_mx && val==m.val;
+  }
+};
+
+// Build and evaluate model k, only touching expressions created by the calling thread
+Model build_model(casadi_int k, const Sparsity& shared) {
+  Model m;
+
+  // Constant nodes, cached integer and real constants
+  SX x = SX::sym("x", 4);
+  SX c = SX(static_cast<double>(k % 5)) + SX(0.5*static_cast<double>(k % 3));
+  m.simplified = is_equal(x*1, x) && (x*0).is_zero() && is_equal(x+0, x)
+    && (x(0)-x(0)).is_zero() && is_equal(-(-x), x) && SX(1).is_one()
+    && SX(-1).is_minus_one() && SXElem(std::numeric_limits<double>::quiet_NaN()).is_nan();
+
+  // Scalar expressions with many constants, and their derivatives
+  SX f = x + c;
+  for (casadi_int i=0; i<30; ++i) {
+    f = sin(f) * (1 + 0.01*static_cast<double>(k+i)) + 2*f(casadi_int((i+k) % 4)) - 1;
+  }
+  SX J = jacobian(f, x);
+  SX H = hessian(dot(f, f), x);
+  Function fsx("f", {x}, {f, J, H});
+  m.n_sx = fsx.n_instructions();
+
+  // Matrix expressions embedding it, with empty matrices and a linear solve
+  MX y = MX::sym("y", 4);
+  std::vector<MX> r = fsx(std::vector<MX>{y});
+  MX A = r.at(1) + 10*MX::eye(4);
+  MX g = solve(A, vertcat(MX(), r.at(0)), "qr") + mtimes(r.at(2), y);
+  Function fmx("g", {y}, {dot(g, g), gradient(dot(g, g), y)});
+  m.n_mx = fmx.n_nodes();
+
+  // Sparsity patterns: cached, and one shared between all threads
+  Sparsity sp = Sparsity::banded(20, 2) + Sparsity::diag(20);
+  std::vector<casadi_int> rowperm, colperm, rowblock, colblock, coarse_rowblock, coarse_colblock;
+  casadi_int nb = shared.btf(rowperm, colperm, rowblock, colblock,
+                             coarse_rowblock, coarse_colblock);
+  m.val.push_back(static_cast<double>(sp.nnz() + nb));
+
+  // Numerical results
+  std::vector<DM> res = fmx(std::vector<DM>{DM(std::vector<double>{0.1, 0.2, 0.3, 0.4})});
+  for (const DM& e : res) {
+    std::vector<double> v = e.nonzeros();
+    m.val.insert(m.val.end(), v.begin(), v.end());
+  }
+  return m;
+}
+
+int main() {
+  casadi_int n_models = 64;
+  casadi_int n_threads = 8;
+
+  // Pattern shared between the threads
+  Sparsity shared = Sparsity::banded(50, 1) + Sparsity::triplet(50, 50, {0, 40}, {30, 10});
+
+  // Serial reference
+  std::vector<Model> ref;
+  for (casadi_int k=0; k<n_models; ++k) ref.push_back(build_model(k, shared));
+
+  // The same models, distributed over the threads, and each model in every thread
+  casadi_int n_fail = 0;
+  for (bool same : {false, true}) {
+    std::vector<std::vector<Model> > par(n_threads, std::vector<Model>(n_models));
+    std::vector<std::thread> threads;
+    for (casadi_int t=0; t<n_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (casadi_int k=same ? 0 : t; k<n_models; k+=same ? 1 : n_threads) {
+          par[t][k] = build_model(k, shared);
+        }
+      });
+    }
+    for (auto& th : threads) th.join();
+    for (casadi_int t=0; t<n_threads; ++t) {
+      for (casadi_int k=same ? 0 : t; k<n_models; k+=same ? 1 : n_threads) {
+        if (!(par[t][k]==ref[k])) {
+          std::cout << "Model " << k << " differs in thread " << t << std::endl;
+          n_fail++;
+        }
+      }
+    }
+  }
+  if (!ref[0].simplified) {
+    std::cout << "Constant simplifications failed" << std::endl;
+    n_fail++;
+  }
+
+  std::cout << n_models << " models, " << n_threads << " threads, "
+            << n_fail << " failures" << std::endl;
+  return n_fail==0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <casadi/casadi.hpp>
+#include <chrono>
+#include <thread>
+
+using namespace casadi;
+/**
+ * Building independent models in several threads,
+ * requires a build with WITH_THREADSAFE_SYMBOLICS
+ */
+
+// Build and evaluate model k, only touching expressions created by the calling thread
+double build_model(casadi_int k) {
+  // Scalar expressions with many constants, and their derivatives
+  SX x = SX::sym("x", 4);
+  SX f = x;
+  for (casadi_int i=0; i<50; ++i) {
+    f = sin(f) * (1 + 0.01*static_cast<double>(k+i)) + 2*f(casadi_int((i+k) % 4)) - 1;
+  }
+  Function fsx("f" + str(k), {x}, {f, jacobian(f, x)});
+
+  // Matrix expressions embedding it
+  MX y = MX::sym("y", 4);
+  std::vector<MX> r = fsx(std::vector<MX>{y});
+  MX g = mtimes(r.at(1), y) + r.at(0);
+  Function fmx("g" + str(k), {y}, {dot(g, g), gradient(dot(g, g), y)});
+  std::vector<DM> res = fmx(std::vector<DM>{DM(std::vector<double>{0.1, 0.2, 0.3, 0.4})});
+  return res.at(0).scalar() + static_cast<double>(sum1(res.at(1)));
+}
+
+double now() {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char* argv[]) {
+  casadi_int n_models = 200;
+  casadi_int n_threads = argc>1 ? atoi(argv[1]) : 4;
+
+  // Serial reference
+  std::vector<double> ref(n_models);
+  double t0 = now();
+  for (casadi_int k=0; k<n_models; ++k) ref[k] = build_model(k);
+  double t_serial = now() - t0;
+
+  // The same models, distributed over the threads
+  std::vector<double> par(n_models);
+  t0 = now();
+  std::vector<std::thread> threads;
+  for (casadi_int t=0; t<n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (casadi_int k=t; k<n_models; k+=n_threads) par[k] = build_model(k);
+    });
+  }
+  for (auto& th : threads) th.join();
+  double t_parallel = now() - t0;
+
+  // Compare
+  casadi_int n_diff = 0;
+  for (casadi_int k=0; k<n_models; ++k) {
+    if (par[k]!=ref[k]) n_diff++;
+  }
+  std::cout << n_models << " models, " << n_threads << " threads: "
+            << t_serial << " s serial, " << t_parallel << " s parallel, "
+            << n_diff << " mismatches" << std::endl;
+  return n_diff==0 ? 0 : 1;
+}
@@ -3530,6 +3530,12 @@ DECL void casadi_qr_sparse(const M& A, M& OUTPUT1, M& OUTPUT2, M& OUTPUT3,
   return qr_sparse(A, OUTPUT1, OUTPUT2, OUTPUT3, OUTPUT4, OUTPUT5, amd);
 }
 
+DECL void casadi_qr_sparse(const M& A, M& OUTPUT1, M& OUTPUT2, M& OUTPUT3,
+          std::vector<casadi_int>& OUTPUT4, std::vector<casadi_int>& OUTPUT5,
+          const std::string& ordering) {
+  return qr_sparse(A, OUTPUT1, OUTPUT2, OUTPUT3, OUTPUT4, OUTPUT5, ordering);
+}
+
 DECL M casadi_qr_solve(const M& b, const M& v, const M& r, const M& beta,
                        const std::vector<casadi_int>& prinv,
                        const std::vector<casadi_int>& pc, bool tr=false) {
@@ -3540,6 +3546,11 @@ DECL void casadi_ldl(const M& A, M& OUTPUT1, M& OUTPUT2, std::vector<casadi_int>
   return ldl(A, OUTPUT1, OUTPUT2, OUTPUT3, amd);
 }
 
+DECL void casadi_ldl(const M& A, M& OUTPUT1, M& OUTPUT2, std::vector<casadi_int>& OUTPUT3,
+          const std::string& ordering) {
+  return ldl(A, OUTPUT1, OUTPUT2, OUTPUT3, ordering);
+}
+
 DECL M casadi_ldl_solve(const M& b, const M& D, const M& LT, const std::vector<casadi_int>& p) {
   return ldl_solve(b, D, LT, p);
 }
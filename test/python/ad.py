@@ -400,6 +400,26 @@ class ADtests(casadiTestCase):
     #print array(JT_out[0])
     #print array(H_out[0])
 
+  def test_hessian_acyclic(self):
+    self.message("Hessian recovered by substitution")
+    n = 12
+    for X in [SX, MX]:
+      x = X.sym("x",n)
+      # Tridiagonal Hessian plus a dense row/column: acyclic coloring needs fewer directions
+      f = sum1(x[:-1]*x[1:]**2) + x[-1]*sum1(sin(x[:-1]))
+      H = hessian(f,x)[0]
+      Href = jacobian(gradient(f,x),x)
+      self.assertTrue(H.sparsity()==Href.sparsity())
+      F = Function("F",[x],[H,Href])
+      x0 = DM([0.1*i+0.3 for i in range(n)])
+      [Hn, Hrefn] = F(x0)
+      self.checkarray(Hn,Hrefn,digits=10)
+      self.checkarray(Hn,Hn.T,digits=12)
+      # Same through the Function factory
+      g = Function("g",[x],[f],["x"],["f"])
+      h = g.factory("h",["x"],["hess:f:x:x"])
+      self.checkarray(h(x0),Hrefn,digits=10)
+
   def test_bugshape(self):
     self.message("shape bug")
     x=SX.sym("x")
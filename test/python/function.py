@@ -30,6 +30,7 @@ from helpers import *
 import pickle
 import os
 import sys
+import platform
 
 scipy_interpolate = False
 try:
@@ -629,6 +630,51 @@ class Functiontests(casadiTestCase):
     self.checkfunction_light(fun.map(4,"thread",2),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
     self.checkfunction_light(fun.map(4,"thread",5),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
 
+  def test_map_batch(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+
+    fun = Function("f",[x,y],[sin(y*x)+y[0],vertcat(x**2,y[1])])
+
+    for n in [1,7,16,40]:
+      X_ = DM(np.random.random((1,n)))
+      Y_ = DM(np.random.random((2,n)))
+      F = fun.map(n)
+      res = F(X_,Y_)
+      for k in range(n):
+        r = fun(X_[k],Y_[:,k])
+        self.checkarray(res[0][:,k],r[0])
+        self.checkarray(res[1][:,k],r[1])
+
+  def test_map_thread_pool(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+
+    fun = Function("f",[x,y],[sin(y*x),x**2])
+
+    X_ = DM(np.random.random((1,10)))
+    Y_ = DM(np.random.random((2,10)))
+
+    size = GlobalOptions.getThreadPoolSize()
+    try:
+      GlobalOptions.setThreadPoolSize(3)
+      F = fun.map(10,"thread")
+      # Work memory is shared between evaluations
+      self.assertEqual(F.info()["n_slice"],3)
+      self.checkfunction_light(F,fun.map(10),inputs=[X_,Y_])
+      # Serialization keeps the work slices, also when the pool size has changed since
+      GlobalOptions.setThreadPoolSize(2)
+      F2 = Function.deserialize(F.serialize())
+      self.assertEqual(F2.info()["n_slice"],3)
+      self.checkfunction_light(F2,fun.map(10),inputs=[X_,Y_])
+      GlobalOptions.setThreadPoolSize(3)
+      # Nested parallel maps
+      G = Function("g",[x,y],F.map(2,"thread")(repmat(x,1,20),repmat(y,1,20)))
+      G_ref = Function("g",[x,y],fun.map(20)(repmat(x,1,20),repmat(y,1,20)))
+      self.checkfunction_light(G,G_ref,inputs=[X_[0],Y_[:,0]])
+    finally:
+      GlobalOptions.setThreadPoolSize(size)
+
   @memory_heavy()
   def test_mapsum(self):
     x = SX.sym("x")
@@ -2660,6 +2706,262 @@ class Functiontests(casadiTestCase):
     self.assertTrue(f.stats()["n_call_total"]==0)
     self.checkarray(a,3)
 
+  def test_jit_native(self):
+    x = SX.sym("x",3)
+    y = SX.sym("y",2)
+    e = vertcat(x[0]+y[0],x[1]-y[1],x[2]*x[0],x[0]/y[0],-x[1],fabs(x[2]-1),sqrt(x[0]),y[1]**2,
+                2*x[1],1/x[2],sin(x[0]),atan2(x[1],y[0]),fmin(x[0],y[1]),x[0]<y[0],
+                if_else(x[1]>0.5,y[1],0),3.5,exp(x[2])*log(y[0]))
+    # More live values than registers
+    for i in range(20):
+      e = e*x[1]+sin(e)/(1+e**2)-y[i%2]
+    f = Function("f",[x,y],[e,2*x[0]])
+    f_native = Function("f",[x,y],[e,2*x[0]],{"jit_native":True})
+    for inputs in [[DM([0.3,0.7,1.2]),DM([0.9,1.4])],[DM([2,-0.7,0]),DM([-1,0.2])]]:
+      self.checkfunction_light(f_native,f,inputs=inputs)
+    if platform.machine().lower() in ["x86_64","amd64"] and platform.system()!="Windows":
+      self.assertTrue(f_native.info()["native_code_bytes"]>0)
+      # Machine code is regenerated on deserialization
+      self.assertTrue(Function.deserialize(f_native.serialize()).info()["native_code_bytes"]>0)
+    self.assertEqual(f.info()["native_code_bytes"],0)
+
+  def test_schedule_locality(self):
+    A = SX.sym("A",10,10)
+    B = SX.sym("B",10,10)
+    e = mtimes(mtimes(A,B),A)
+    f = Function("f",[A,B],[e],{"estimate_cache":True})
+    f_compact = Function("f",[A,B],[e],{"compact_tape":True})
+    f_sched = Function("f",[A,B],[e],{"schedule_locality":True,"estimate_cache":True})
+    self.checkfunction_light(f_sched,f,inputs=[DM.rand(10,10),DM.rand(10,10)])
+    self.checkfunction_light(f_compact,f,inputs=[DM.rand(10,10),DM.rand(10,10)])
+    info, info_compact, info_sched = f.info(), f_compact.info(), f_sched.info()
+    # Compact tape: opt-in, half the tape, same instructions and work vector
+    self.assertFalse(info["compact_tape"])
+    self.assertTrue(info_compact["compact_tape"])
+    # Cache estimates only on request
+    self.assertFalse("cache_miss_rate_l1" in info_compact)
+    self.assertEqual(info_compact["n_instructions"],info["n_instructions"])
+    self.assertEqual(info_compact["sz_w"],info["sz_w"])
+    self.assertEqual(2*info_compact["tape_bytes"],info["tape_bytes"])
+    # Scheduling: same instructions, reordered to a smaller working set
+    self.assertEqual(info_sched["n_instructions"],info["n_instructions"])
+    self.assertTrue(info_sched["sz_w"]<info_compact["sz_w"])
+    self.assertTrue(info_sched["cache_miss_rate_l1"]<info["cache_miss_rate_l1"])
+
+  def test_sx_parallelization(self):
+    x = SX.sym("x",13)
+    size = GlobalOptions.getThreadPoolSize()
+    try:
+      GlobalOptions.setThreadPoolSize(4)
+      # Levels of n nodes split over up to 5 slices: uneven splits and slices of one node
+      for n in [2,5,6,7,13]:
+        for grain in [1,2,3]:
+          f = Function("f",[x],[sin(x[:n])],{"parallelization":"thread","parallel_grain":grain,
+                                            "live_variables":False})
+          x0 = DM.rand(13)
+          self.checkarray(f(x0),sin(x0[:n]))
+          # A level is split only if it holds at least two grains
+          if n>=2*grain:
+            self.assertTrue(f.info()["parallel_stages_threaded"]>0)
+          else:
+            self.assertFalse("parallel_stages" in f.info())
+    finally:
+      GlobalOptions.setThreadPoolSize(size)
+    with self.assertInException("Unknown parallelization"):
+      Function("f",[x],[x],{"parallelization":"openmp"})
+
+  def test_incremental(self):
+    for X in [SX,MX]:
+      x = X.sym("x",6)
+      p = X.sym("p",2)
+      y = vertcat(sin(x[:3])*p[0], x[3:]**2+p[1], dot(x,x))
+      f = Function("f",[x,p],[y])
+      f_inc = Function("f",[x,p],[y],{"incremental":True})
+      for f_test in [f_inc, Function.deserialize(f_inc.serialize())]:
+        x0 = DM.rand(6)
+        p0 = DM.rand(2)
+        for k in range(8):
+          if k%2==0: x0[k%6] = k
+          if k%3==0: p0[k%2] = -k
+          self.checkarray(f_test(x0,p0),f(x0,p0))
+      with self.assertInException("cannot be combined"):
+        Function("f",[x,p],[y],{"incremental":True,"live_variables":True})
+
+  def test_mx_eval_plan(self):
+    x = MX.sym("x",4)
+    y = x
+    g = Function("g",[x],[x[0]*cos(x)])
+    for i in range(20):
+      y = sin(y)+y[i%4]*x
+      y = reshape(y,2,2).T
+      y = vec(y)+g(vec(y))
+    f_ref = Function("f",[x],[y],{"eval_plan":False})
+    f = Function("f",[x],[y])
+    x0 = DM.rand(4)
+    self.checkarray(f(x0),f_ref(x0),digits=15)
+    # The plan is cached in the memory of f, shared by callers with different work vectors
+    X = MX.sym("X",4)
+    Z = sin(X)*X[0]+X[::-1]
+    F1 = Function("F1",[X],[f(X)])
+    F2 = Function("F2",[X],[f(Z)*cos(X)])
+    R2 = Function("R2",[X],[f_ref(Z)*cos(X)])
+    self.assertNotEqual(F1.sz_w(),F2.sz_w())
+    for k in range(3):
+      self.checkarray(F1(x0),f_ref(x0),digits=15)
+      self.checkarray(F2(x0),R2(x0),digits=15)
+
+  def test_mx_parallelization(self):
+    x = MX.sym("x",3)
+    p = MX.sym("p")
+    g = Function("g",[x,p],[sin(x)*p,dot(x,x)])
+    X = MX.sym("X",3,8)
+    r = [g(X[:,i],p) for i in range(8)]
+    s = sum([e[1] for e in r])
+    y = horzcat(*[g(e[0],s)[0] for e in r])
+    f = Function("f",[X,p],[y,s])
+    inputs = [DM.rand(3,8),DM.rand(1)]
+    ref = f(*inputs)
+    size = GlobalOptions.getThreadPoolSize()
+    try:
+      # Two stages of 8 calls, split over the workers and the calling thread
+      for n, regions in [(2,3),(3,4),(5,6),(9,8)]:
+        GlobalOptions.setThreadPoolSize(n)
+        f_par = Function("f",[X,p],[y,s],{"parallelization":"thread"})
+        info = f_par.info()
+        self.assertEqual(info["parallel_stages_threaded"],2)
+        self.assertEqual(info["parallel_regions"],regions)
+        # Same operations in the same order: identical result
+        for a,b in zip(f_par(*inputs),ref):
+          self.assertEqual(float(norm_inf(a-b)),0)
+      # The split is part of the serialized function
+      GlobalOptions.setThreadPoolSize(3)
+      f_par = Function("f",[X,p],[y,s],{"parallelization":"thread"})
+      GlobalOptions.setThreadPoolSize(8)
+      f_par = Function.deserialize(f_par.serialize())
+      self.assertEqual(f_par.info()["parallel_regions"],4)
+      self.assertEqual(float(norm_inf(f_par(*inputs)[0]-ref[0])),0)
+    finally:
+      GlobalOptions.setThreadPoolSize(size)
+    with self.assertInException("Unknown parallelization"):
+      Function("f",[X,p],[y,s],{"parallelization":"openmp"})
+
+  def test_jacobian_parallelization(self):
+    x = SX.sym("x",12)
+    g = Function("g",[x],[sin(x)*vertcat(x[1:],x[0])],{"never_inline":True})
+    X = MX.sym("X",12)
+    f = Function("f",[X],[g(X)])
+    x0 = DM.rand(12)
+    J_ref = f.jacobian()(x0,0)
+    size = GlobalOptions.getThreadPoolSize()
+    try:
+      GlobalOptions.setThreadPoolSize(3)
+      # Color groups as concurrent calls to the forward derivative of g
+      f_par = Function("f",[X],[g(X)],{"jacobian_options":{"parallelization":"thread"}})
+      J = f_par.jacobian()
+      self.checkarray(J(x0,0),J_ref)
+      self.assertTrue(J.info()["parallel_stages_threaded"]>0)
+      # Inherited by derivatives created by the factory, as for Nlpsol
+      f_par = Function("f",[X],[g(X)],{"parallelization":"thread"})
+      J = f_par.factory("J",["i0"],["jac:o0:i0"])
+      self.checkarray(J(x0),J_ref)
+      self.assertTrue(J.info()["parallel_stages_threaded"]>0)
+      # Without a Jacobian of its own, only options understood by the MX wrapper are passed on
+      G = g.map("G","serial",2,[],[],{"jacobian_options":{"parallelization":"thread","compact_tape":True}})
+      X0 = DM.rand(12,2)
+      self.checkarray(G.jacobian()(X0,0),g.map(2).jacobian()(X0,0))
+    finally:
+      GlobalOptions.setThreadPoolSize(size)
+    with self.assertInException("Unknown parallelization"):
+      Function("f",[X],[g(X)],{"jacobian_options":{"parallelization":"openmp"}}).jacobian()
+
+  def test_checkout_concurrent(self):
+    x = MX.sym("x",2)
+    g = Function("g",[x],[sin(x)*x[0]])
+    inputs = [DM.rand(2,32)]
+    G_ref = g.map(32)
+    for i in range(3):
+      G = g.map(32,"thread",8)
+      self.checkfunction_light(G,G_ref,inputs=inputs)
+    # Memory objects checked out at the same time are distinct and reused after release
+    m = [g.checkout() for i in range(4)]
+    self.assertEqual(len(set(m)),4)
+    for e in reversed(m): g.release(e)
+    self.assertEqual(g.checkout(),m[0])
+
+  def test_mx_work_alias(self):
+    x = MX.sym("x",6)
+    y = reshape(sin(reshape(x,2,3)),6,1)+x
+    f = Function("f",[x],[y])
+    x0 = DM.rand(6)
+    self.checkarray(f(x0),sin(x0)+x0)
+    # Both reshapes alias their argument, sin and the addition are done in place
+    info = f.info()
+    self.assertEqual(info["n_alias"],2)
+    self.assertEqual(info["n_inplace"],1)
+    self.assertEqual(info["work_nnz"],12)
+    self.assertEqual(info["work_nnz_unshared"],30)
+    # Aliasing does not rely on live variables
+    info = Function("f",[x],[y],{"live_variables":False}).info()
+    self.assertEqual(info["n_alias"],2)
+    self.assertEqual(info["work_nnz"],18)
+    # A freed element is reused by a smaller one
+    b = sin(x)[:4]
+    f = Function("f",[x],[sin(b)[:3],b])
+    self.checkarray(f(x0)[0],sin(sin(x0[:3])))
+    info = f.info()
+    self.assertEqual(info["work_nnz"],13)
+    self.assertEqual(info["work_nnz_unshared"],23)
+
+  def test_mx_concat_placement(self):
+    x = MX.sym("x",10)
+    xs = vertsplit(x,[0,4,10])
+    y = vertcat(sin(xs[0]),cos(xs[1]))*2
+    f = Function("f",[x],[y])
+    x0 = DM.rand(10)
+    self.checkarray(f(x0),vertcat(sin(x0[:4]),cos(x0[4:]))*2)
+    # The split parts alias x, sin and cos write in place into the concatenation
+    info = f.info()
+    self.assertEqual(info["n_alias"],4)
+    self.assertEqual(info["n_inplace"],2)
+    self.assertEqual(info["work_nnz"],20)
+    self.assertEqual(info["work_nnz_unshared"],50)
+    info = Function("f",[x],[y],{"live_variables":False}).info()
+    self.assertEqual(info["n_alias"],4)
+    self.assertEqual(info["work_nnz"],30)
+
+  def test_mx_graph_passes(self):
+    x = MX.sym("x",3)
+    y = MX.sym("y",2,2)
+    s = SX.sym("s",2)
+    g = Function("g",[s],[sin(s),s[0]*s[1]])
+    [gs,c] = g(DM([0.5,2]))
+    e = vertcat(x,sin(x[0]))
+    out = [e[1:3], reshape(reshape(y,4,1),1,4)[0:2], y*c+gs[0]*0, -(-x)*(c-1)]
+    f_ref = Function("f",[x,y],out)
+    self.assertEqual(f_ref.n_nodes(),15)
+    inputs = [DM.rand(3),DM.rand(2,2)]
+    # The call to g is evaluated, after which y*c and the products with zero fold away
+    f = Function("f",[x,y],out,{"graph_passes":["constant"]})
+    self.checkfunction_light(f,f_ref,inputs=inputs)
+    info = f.info()["graph_passes"]
+    self.assertEqual(info["constant"],{"rewrites":1,"removed":5})
+    self.assertEqual(info["n_nodes_after"],10)
+    self.assertEqual(f.n_nodes(),10)
+    # e[1:3] indexes into x directly, the concatenation is dropped
+    f = Function("f",[x,y],out,{"graph_passes":["gather"]})
+    self.checkfunction_light(f,f_ref,inputs=inputs)
+    info = f.info()["graph_passes"]
+    self.assertEqual(info["gather"],{"rewrites":1,"removed":1})
+    self.assertEqual(f.n_nodes(),14)
+    # Passes compose
+    f = Function("f",[x,y],out,{"graph_passes":["constant","gather","transpose","identity"]})
+    self.checkfunction_light(f,f_ref,inputs=inputs)
+    self.checkfunction_light(Function.deserialize(f.serialize()),f_ref,inputs=inputs)
+    self.assertEqual(f.n_nodes(),9)
+
+    with self.assertInException("Unknown graph pass"):
+      Function("f",[x,y],out,{"graph_passes":["dce"]})
+
   def test_codegen_inf_nan(self):
     x = MX.sym("x")
     f = Function("F",[x],[x+inf])
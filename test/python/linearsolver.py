@@ -84,12 +84,17 @@ except:
 try:
   load_linsol("qr")
   lsolvers.append(("qr",{},set()))
+  lsolvers.append(("qr",{"ordering":"nested_dissection"},set()))
+  lsolvers.append(("qr",{"max_num_threads":3},set()))
 except:
   pass
 
 try:
   load_linsol("ldl")
   lsolvers.append(("ldl",{},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"ordering":"nested_dissection"},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"supernodal":False},{"posdef","symmetry"}))
+  lsolvers.append(("ldl",{"max_num_threads":3},{"posdef","symmetry"}))
 except:
   pass
 
@@ -509,6 +514,49 @@ class LinearSolverTests(casadiTestCase):
     self.check_codegen(f, inputs=[As[0]])
     self.check_serialize(f, inputs=[As[0]])
 
+  def test_ldl_supernodal(self):
+    # KKT system: banded Hessian, dense constraint rows
+    n = 40
+    m = 5
+    numpy.random.seed(1)
+    H = DM(Sparsity.banded(n,2),numpy.random.random(Sparsity.banded(n,2).nnz()))
+    H = H+H.T+10*DM.eye(n)
+    J = DM(numpy.random.random((m,n)))
+    K = blockcat([[H,J.T],[J,-DM.eye(m)]])
+    b = DM(range(n+m))
+
+    As = MX.sym("A",K.sparsity())
+    x = {}
+    for supernodal in [True,False]:
+      f = Function('f',[As],[solve(As, b, "ldl", {"supernodal": supernodal})])
+      x[supernodal] = f(K)
+      self.checkarray(mtimes(K,x[supernodal]),b,digits=10)
+      self.check_codegen(f, inputs=[K])
+      self.check_serialize(f, inputs=[K])
+    self.checkarray(x[True],x[False],digits=10)
+
+  def test_factorize_threads(self):
+    # Grid Laplacian: nested dissection gives many independent subtrees
+    n = 12
+    K = DM(Sparsity.banded(n*n,1)+Sparsity.banded(n*n,n),-1.0)+(4*n+4)*DM.eye(n*n)
+    b = DM(range(n*n))
+
+    As = MX.sym("A",K.sparsity())
+    for ls in ["ldl","qr"]:
+      x = {}
+      for threads in [1,4]:
+        f = Function('f',[As],[solve(As, b, ls, {"ordering": "nested_dissection",
+                                                 "max_num_threads": threads})])
+        x[threads] = f(K)
+        self.checkarray(mtimes(K,x[threads]),b,digits=10)
+        self.check_codegen(f, inputs=[K])
+        self.check_serialize(f, inputs=[K])
+      self.checkarray(x[4],x[1],digits=10)
+
+    # Threads are only used by the supernodal factorization
+    with self.assertOutputs([],["max_num_threads"]):
+      solve(As, b, "ldl", {"supernodal": False, "max_num_threads": 4})
+
   @memory_heavy()
   def test_thread_safety(self):
     x = MX.sym('x')
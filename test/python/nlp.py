@@ -2251,6 +2251,92 @@ class NLPtests(casadiTestCase):
 
     #results.to_csv('hock_schittkowski/results.csv',index=False)
 
+  @requires_nlpsol("sqpmethod")
+  @requires_conic("qrqp")
+  def test_codegen_thread_safe(self):
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    nlp={'x':x, 'p':p, 'f':(x[0]-p)**2+(x[1]-x[0]**2)**2}
+    qpsol_options = {"print_iter":False,"print_header":False}
+    solver = nlpsol("mysolver", "sqpmethod", nlp, {"qpsol": "qrqp","qpsol_options": qpsol_options,"print_header":False,"print_iteration":False,"print_time":False})
+    solver_in = {"x0":[0,0],"p":2}
+    for opts in [{"thread_safe":True},{"thread_safe":True,"thread_local_mem":True}]:
+      self.check_codegen(solver,solver_in,std="c11",opts=opts)
+    with self.assertInException("requires 'thread_safe'"):
+      CodeGenerator("f",{"thread_local_mem":True})
+
+  @slow()
+  def test_codegen_thread_safe_concurrent(self):
+    import ctypes
+    import threading
+    x=SX.sym("x",2)
+    p=SX.sym("p")
+    nlp={'x':x, 'p':p, 'f':(x[0]-p)**2+(x[1]-x[0]**2)**2}
+    qpsol_options = {"print_iter":False,"print_header":False}
+    n_threads = 4
+    n_iter = 25
+    c_int = ctypes.c_longlong
+    c_real_p = ctypes.POINTER(ctypes.c_double)
+    for j, opts in enumerate([{"thread_safe":True},{"thread_safe":True,"thread_local_mem":True}]):
+      name = "mysolver_concurrent%d" % j
+      solver = nlpsol(name, "sqpmethod", nlp, {"qpsol": "qrqp","qpsol_options": qpsol_options,"print_header":False,"print_iteration":False,"print_time":False,"print_status":False})
+      ref = [solver(x0=[0,0],p=k+1)["x"] for k in range(n_threads)]
+      cg = CodeGenerator(name+".c",opts)
+      cg.add(solver)
+      cg.generate()
+      [F,libname] = self.compile_external(name,name+".c",std="c11",definitions=["CASADI_MAX_NUM_THREADS=%d" % n_threads])
+      lib = ctypes.CDLL(libname)
+      eval_c = getattr(lib,name)
+      eval_c.argtypes = [ctypes.POINTER(c_real_p),ctypes.POINTER(c_real_p),ctypes.POINTER(c_int),c_real_p,ctypes.c_int]
+      checkout_c = getattr(lib,name+"_checkout")
+      release_c = getattr(lib,name+"_release")
+      release_c.argtypes = [ctypes.c_int]
+      sz = [c_int() for i in range(4)]
+      getattr(lib,name+"_work")(*[ctypes.byref(e) for e in sz])
+      sz_arg, sz_res, sz_iw, sz_w = [e.value for e in sz]
+      getattr(lib,name+"_incref")()
+
+      # Memory objects checked out at the same time differ, released ones are reused
+      mems = [checkout_c() for k in range(n_threads)]
+      self.assertEqual(len(set(mems)),n_threads)
+      self.assertTrue(min(mems)>=0)
+      for mem in mems: release_c(mem)
+      mem = checkout_c()
+      self.assertTrue(mem in mems)
+      release_c(mem)
+
+      # The same from concurrent threads, each checking out, evaluating and releasing
+      lock = threading.Lock()
+      busy = set()
+      used = set()
+      errors = []
+      def work(k):
+        buf_in = [(ctypes.c_double*solver.nnz_in(i))(*([solver.default_in(i)]*solver.nnz_in(i))) for i in range(solver.n_in())]
+        buf_in[solver.index_in("p")][0] = k+1
+        x_out = (ctypes.c_double*2)()
+        arg = (c_real_p*sz_arg)(*[ctypes.cast(b,c_real_p) for b in buf_in])
+        res = (c_real_p*sz_res)(ctypes.cast(x_out,c_real_p))
+        iw = (c_int*max(sz_iw,1))()
+        w = (ctypes.c_double*max(sz_w,1))()
+        for it in range(n_iter):
+          mem = checkout_c()
+          with lock:
+            if mem<0 or mem in busy: errors.append("checkout %d" % mem)
+            busy.add(mem)
+            used.add(mem)
+          flag = eval_c(arg,res,iw,w,mem)
+          with lock:
+            busy.discard(mem)
+          release_c(mem)
+          if flag or max(abs(x_out[i]-float(ref[k][i])) for i in range(2))>1e-8:
+            errors.append("result of thread %d" % k)
+      threads = [threading.Thread(target=work,args=(k,)) for k in range(n_threads)]
+      for t in threads: t.start()
+      for t in threads: t.join()
+      getattr(lib,name+"_decref")()
+      self.assertEqual(errors,[])
+      self.assertTrue(used.issubset(mems))
+
   def test_exception_in_oraclefunction(self):
     x=MX.sym("x")
     x_fail = x.attachAssert(x!=x,"Cuckoo")
@@ -490,6 +490,32 @@ class Sparsitytests(casadiTestCase):
     sp2 = hessian(H,x)[0].sparsity()
     self.assertTrue(sp==sp2)
 
+  def test_jacsparsity_block_width(self):
+    n = 700
+    x = SX.sym("x",n)
+    y = sin(x)*vertcat(x[1:],x[0])+vertcat(x[-1],x[:-1])
+    y = y*vertcat(y[3:],y[:3])
+    X = MX.sym("X",n)
+    Y = sin(X)*vertcat(X[1:],X[0])+vertcat(X[-1],X[:-1])
+    Y = Function("f",[x],[y])(Y)
+    Y = vertcat(Y,mtimes(DM.ones(2,n),X),X[[5,3,1]])
+    for hierarchical in [False,True]:
+      GlobalOptions.setHierarchicalSparsity(hierarchical)
+      for e,v in [(y,x),(Y,X),(y[:5]*sum1(y),x),(Y[:5]*sum1(Y),X)]:
+        ref = None
+        for width in [64,256,512]:
+          GlobalOptions.setSparsityBlockWidth(width)
+          f = Function("f",[v],[e])
+          sp = f.jac_sparsity(0,0)
+          if ref is None:
+            ref = sp
+          else:
+            self.assertTrue(sp==ref)
+    GlobalOptions.setSparsityBlockWidth(512)
+    GlobalOptions.setHierarchicalSparsity(True)
+    with self.assertRaises(Exception):
+      GlobalOptions.setSparsityBlockWidth(100)
+
 
   def test_rowcol(self):
     n = 3
@@ -567,7 +593,244 @@ class Sparsitytests(casadiTestCase):
         self.assertTrue(L.is_subset(R))
         self.assertFalse(R.is_subset(L))
 
-
+  def test_cache_interning(self):
+      # Patterns in use are shared
+      a = Sparsity.lower(4)
+      b = Sparsity.triplet(4,4,[0,1,2,3,1,2,3,2,3,3],[0,0,0,0,1,1,1,2,2,3])
+      self.assertEqual(a.__hash__(),b.__hash__())
+      c = Sparsity.upper(4)
+      self.assertNotEqual(a.__hash__(),c.__hash__())
+      # Patterns can be recreated after all references were dropped
+      for i in range(3):
+        del a, b
+        a = Sparsity.lower(4)
+        b = Sparsity.lower(4)
+        self.assertEqual(a.__hash__(),b.__hash__())
+        self.assertTrue(a==Sparsity.lower(4))
+
+  def test_acyclic_coloring(self):
+      # Tridiagonal: a star coloring needs three colors, an acyclic coloring two
+      H = Sparsity.banded(10,1)
+      self.assertEqual(H.star_coloring().size2(),3)
+      self.assertEqual(H.acyclic_coloring().size2(),2)
+      # Banded plus coupling to the last variables, as from direct collocation
+      n = 30
+      H = Sparsity.banded(n,2)
+      for i in range(n): H = H + Sparsity.triplet(n,n,[i,n-1],[n-1,i])
+      for sp in [H, Sparsity.banded(10,1), Sparsity.dense(4,4), Sparsity.diag(5)]:
+        D = sp.acyclic_coloring()
+        self.assertTrue(D.size2()<=sp.star_coloring().size2())
+        color = [0]*sp.size2()
+        for c in range(D.size2()):
+          for i in D.row()[D.colind()[c]:D.colind()[c+1]]: color[i] = c
+        # Distance-1 coloring in which every pair of colors induces a forest
+        parent = {}
+        def find(k):
+          while parent.setdefault(k,k)!=k: k = parent[k]
+          return k
+        for (i,j) in zip(*sp.get_triplet()):
+          if i<=j: continue
+          self.assertNotEqual(color[i],color[j])
+          pair = (min(color[i],color[j]),max(color[i],color[j]))
+          a, b = find(pair+(i,)), find(pair+(j,))
+          self.assertNotEqual(a,b)
+          parent[a] = b
+
+  def test_coloring_orderings(self):
+      n = 8
+      r = []; c = []
+      for i in range(n):
+        for j in range(n):
+          for (di,dj) in [(0,0),(1,0),(0,1),(-1,0),(0,-1),(1,1)]:
+            if 0<=i+di<n and 0<=j+dj<n:
+              r.append(i*n+j); c.append((i+di)*n+j+dj)
+          r.append(n*n); c.append(i*n+j)
+      J = Sparsity.triplet(n*n+1,n*n,r,c)
+      H = mtimes(DM.ones(J.T),DM.ones(J)).sparsity()
+      for order in [H.largest_first(), H.smallest_last(), H.incidence_degree()]:
+        self.assertEqual(sorted(order),list(range(n*n)))
+      def colors(D):
+        color = [-1]*D.size1()
+        for k in range(D.size2()):
+          for i in D.row()[D.colind()[k]:D.colind()[k+1]]: color[i] = k
+        self.assertTrue(min(color)>=0)
+        return color
+      for ordering in range(4):
+        for n_thread in [1,3]:
+          # Columns that share a row get different colors
+          color = colors(J.uni_coloring(J.T,J.size2(),ordering,n_thread))
+          for row in range(J.size1()):
+            cols = [j for (i,j) in zip(*J.get_triplet()) if i==row]
+            self.assertEqual(len(set(color[j] for j in cols)),len(cols))
+          # Vertices at most a distance 2 apart get different colors
+          color = colors(H.distance2_coloring(ordering,H.size2(),n_thread))
+          for v in range(H.size2()):
+            nb = set(H.row()[H.colind()[v]:H.colind()[v+1]])
+            for w in list(nb):
+              nb.update(H.row()[H.colind()[w]:H.colind()[w+1]])
+            nb.discard(v)
+            self.assertFalse(color[v] in [color[w] for w in nb])
+          if ordering>0:
+            D = H.star_coloring(ordering)
+            self.assertEqual(D.nnz(),H.size2())
+      # Same coloring on every run with a given thread count, also where blocks meet in a band
+      for sp in [J, Sparsity.banded(300,1)+Sparsity.banded(300,20)]:
+        for ordering in range(4):
+          for n_thread in [2,3,8]:
+            D = sp.uni_coloring(sp.T,sp.size2(),ordering,n_thread)
+            for k in range(5):
+              self.assertEqual(sp.uni_coloring(sp.T,sp.size2(),ordering,n_thread),D)
+      # Cutoff
+      self.assertTrue(J.uni_coloring(J.T,2,0,3).is_null())
+      # Jacobian options
+      x = SX.sym("x",10)
+      f = vertcat(sin(x[1:])*x[:-1],sum1(x))
+      Jref = evalf(substitute(jacobian(f,x),x,DM(range(10))))
+      for ordering in ["natural","largest_first","smallest_last","incidence_degree"]:
+        for X in [SX,MX]:
+          y = X.sym("x",10)
+          fy = vertcat(sin(y[1:])*y[:-1],sum1(y))
+          Jf = Function("J",[y],[jacobian(fy,y,{"coloring_ordering":ordering,"coloring_threads":2})])
+          self.checkarray(Jf(DM(range(10))),Jref)
+      with self.assertRaises(Exception):
+        jacobian(f,x,{"coloring_ordering":"foo"})
+
+  def test_nested_dissection(self):
+      # 5-point Laplacian on an n-by-n grid
+      def grid(n):
+        r = []; c = []
+        for i in range(n):
+          for j in range(n):
+            for (di,dj) in [(0,0),(1,0),(0,1),(-1,0),(0,-1)]:
+              if 0<=i+di<n and 0<=j+dj<n:
+                r.append(i*n+j); c.append((i+di)*n+j+dj)
+        return Sparsity.triplet(n*n,n*n,r,c)
+      n = 20
+      H = grid(n)
+      p = H.nested_dissection()
+      self.assertEqual(sorted(p),list(range(n*n)))
+      # Less fill-in than no ordering, close to AMD
+      nnz = [H.ldl(ordering)[0].nnz() for ordering in ["none","amd","nested_dissection"]]
+      self.assertTrue(nnz[2]<nnz[0])
+      self.assertTrue(nnz[2]<=1.1*nnz[1])
+      self.assertEqual(H.ldl(True)[0].nnz(),nnz[1])
+      self.assertEqual(H.ldl(False)[0].nnz(),nnz[0])
+      with self.assertRaises(Exception):
+        H.ldl("foo")
+      # Numerical factorizations with the ordering
+      A = DM(H,1)
+      A[Sparsity.diag(n*n)] = 5
+      b = DM(range(n*n))
+      [D,Lt,p] = ldl(A,"nested_dissection")
+      self.checkarray(mtimes(A,ldl_solve(b,D,Lt,p)),b)
+      [V,R,beta,prinv,pc] = qr_sparse(A,"nested_dissection")
+      self.checkarray(mtimes(A,qr_solve(b,V,R,beta,prinv,pc)),b)
+      # Top level separator, ordered last: about n vertices, splitting the grid evenly
+      n = 30
+      p = grid(n).nested_dissection()
+      def components(removed):
+        part = [-1]*(n*n)
+        sizes = []
+        for v in range(n*n):
+          if removed[v] or part[v]>=0: continue
+          part[v] = len(sizes)
+          stack = [v]
+          size = 0
+          while stack:
+            u = stack.pop()
+            size += 1
+            i, j = divmod(u,n)
+            for (a,b) in [(i+1,j),(i-1,j),(i,j+1),(i,j-1)]:
+              if 0<=a<n and 0<=b<n and not removed[a*n+b] and part[a*n+b]<0:
+                part[a*n+b] = len(sizes)
+                stack.append(a*n+b)
+          sizes.append(size)
+        return sizes
+      removed = [False]*(n*n)
+      for k in range(n*n-1,-1,-1):
+        removed[p[k]] = True
+        sizes = components(removed)
+        if len(sizes)>1: break
+      self.assertTrue(n*n-k<=n+2)
+      self.assertTrue(max(sizes)<=0.55*n*n)
+      # 7-point Laplacian on a larger 3D grid, vertices numbered in scrambled order
+      m = 20
+      q = [(k*2377) % m**3 for k in range(m**3)]
+      r = []; c = []
+      for i in range(m):
+        for j in range(m):
+          for k in range(m):
+            for (di,dj,dk) in [(0,0,0),(1,0,0),(0,1,0),(0,0,1),(-1,0,0),(0,-1,0),(0,0,-1)]:
+              if 0<=i+di<m and 0<=j+dj<m and 0<=k+dk<m:
+                r.append(q[(i*m+j)*m+k]); c.append(q[((i+di)*m+j+dj)*m+k+dk])
+      H = Sparsity.triplet(m**3,m**3,r,c)
+      nnz_amd = H.ldl("amd")[0].nnz()
+      nnz_nd = H.ldl("nested_dissection")[0].nnz()
+      self.assertTrue(nnz_nd<0.9*nnz_amd)
+
+  def test_ldl_supernodes(self):
+      # Banded block followed by a dense block
+      H = blockcat([[Sparsity.banded(30,1),Sparsity.dense(30,10)],
+                    [Sparsity.dense(10,30),Sparsity.dense(10,10)]])
+      Lt,p = H.ldl()
+      self.assertEqual(sorted(p),list(range(40)))
+      nsuper = {}
+      for relaxed in [False,True]:
+        sn = Lt.ldl_supernodes(relaxed)
+        n, nsuper[relaxed] = sn[0], sn[1]
+        ns = sn[1]
+        sup = sn[2:ns+3]
+        rowptr = sn[ns+3:2*ns+4]
+        nzptr = sn[2*ns+4:3*ns+5]
+        row = sn[3*ns+5:]
+        self.assertEqual(n,40)
+        self.assertEqual(sup[0],0)
+        self.assertEqual(sup[-1],n)
+        self.assertEqual(len(row),rowptr[-1])
+        # Supernode blocks hold all entries of L, and explicit zeros if relaxed
+        nnz = 0
+        for s in range(ns):
+          nc = sup[s+1]-sup[s]
+          nr = rowptr[s+1]-rowptr[s]
+          self.assertEqual(row[rowptr[s]:rowptr[s]+nc],list(range(sup[s],sup[s+1])))
+          self.assertEqual(nzptr[s+1]-nzptr[s],nr*nc)
+          for j in range(sup[s],sup[s+1]):
+            for i in Lt.T.row()[Lt.T.colind()[j]:Lt.T.colind()[j+1]]:
+              self.assertTrue(i in row[rowptr[s]:rowptr[s+1]])
+          nnz += nr*nc-nc*(nc+1)//2
+        if relaxed:
+          self.assertTrue(nnz>=Lt.nnz())
+        else:
+          self.assertEqual(nnz,Lt.nnz())
+      self.assertTrue(nsuper[True]<=nsuper[False])
+      self.assertTrue(nsuper[False]<40)
+
+  def test_etree_schedule(self):
+      # Elimination tree of a grid, ordered by nested dissection
+      n = 10
+      H = Sparsity.banded(n*n,1)+Sparsity.banded(n*n,n)
+      Lt,p = H.ldl("nested_dissection")
+      parent = Lt.etree()
+      N = len(parent)
+      self.assertEqual(Sparsity.etree_schedule(parent,[1.0]*N,1),[])
+      s = Sparsity.etree_schedule(parent,[1.0]*N,4)
+      ng = s[0]
+      self.assertTrue(ng>=2 and ng<=4)
+      gptr = s[1:ng+2]
+      nt = gptr[-1]
+      tptr = s[ng+2:ng+nt+3]
+      node = s[ng+nt+3:]
+      self.assertEqual(sorted(node),list(range(N)))
+      # Tasks are subtrees, their roots are children of the top of the tree
+      top = set(node[tptr[-1]:])
+      for t in range(nt):
+        nodes = node[tptr[t]:tptr[t+1]]
+        self.assertEqual(nodes,sorted(nodes))
+        for i in nodes[:-1]:
+          self.assertTrue(parent[i] in nodes)
+        self.assertTrue(parent[nodes[-1]]==-1 or parent[nodes[-1]] in top)
+      for i in top:
+        self.assertTrue(parent[i]==-1 or parent[i] in top)
 
 if __name__ == '__main__':
     unittest.main()
@@ -1539,6 +1539,31 @@ class SXtests(casadiTestCase):
 
     self.checkarray(logsumexp(vertcat(100,1000,10000)),f(vertcat(100,1000,10000)))
 
+  def test_node_pool(self):
+    x = SX.sym("x",10)
+    f_ref = Function('f',[x],[sin(x)*cos(x)+sqrt(x)])
+    x0 = DM(list(range(1,11)))
+
+    m0 = SX.memory_usage()
+    GlobalOptions.setSXNodePool(True)
+    try:
+      y = sin(x)*cos(x)+sqrt(x)
+      m = SX.memory_usage()
+      self.assertTrue(m["sx_node_pool"])
+      self.assertEqual(m["n_nodes"],m0["n_nodes"]+50)
+      self.assertTrue(m["pool_bytes_in_use"]>m0["pool_bytes_in_use"])
+      self.assertTrue(m["pool_bytes_reserved"]>=m["pool_bytes_in_use"])
+      f = Function('f',[x],[y])
+    finally:
+      GlobalOptions.setSXNodePool(False)
+    self.checkarray(f(x0),f_ref(x0))
+
+    # Pooled nodes are freed after the pool is disabled
+    del f, y
+    m = SX.memory_usage()
+    self.assertEqual(m["n_nodes"],m0["n_nodes"])
+    self.assertEqual(m["pool_bytes_in_use"],m0["pool_bytes_in_use"])
+
 
 if __name__ == '__main__':
     unittest.main()